@@ -0,0 +1,178 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <bitsery/details/serialization_common.h>
+#include <bitsery/traits/core/traits.h>
+
+#include "../../memfd.h"
+
+namespace bitsery {
+namespace ext {
+
+/**
+ * An extension for serializing large binary blobs like plugin state. Buffers
+ * smaller than `memfd_transfer_threshold` are serialized inline like
+ * `s.container1b()` would. Larger buffers are written to a sealed memfd that
+ * gets sent to the other side as a file descriptor, which avoids pushing
+ * potentially tens of megabytes through the socket and having to keep around
+ * equally large serialization buffers on both sides. This only happens when
+ * the object is being serialized as part of `write_object()`, since that's the
+ * only place where we can send file descriptors.
+ *
+ * This works for both `std::vector<uint8_t>`, where the receiving side copies
+ * the data out of the mapping, and for `BinaryBuffer`, where the receiving side
+ * can use the mapped memory directly. A `BinaryBuffer` that was written to
+ * through `BinaryBuffer::resize()` may already live in a memfd, in which case
+ * that memfd gets sealed and sent without any copying.
+ */
+class LargeBinary {
+   public:
+    /**
+     * @param max_size The maximum size of the buffer when serialized inline,
+     *   the same as the size passed to `s.container1b()`.
+     */
+    explicit LargeBinary(size_t max_size) : max_size_(max_size) {}
+
+    template <typename Ser, typename Fnc>
+    void serialize(Ser& ser, const std::vector<uint8_t>& buffer, Fnc&&) const {
+        serialize_data(ser, buffer.data(), buffer.size());
+    }
+
+    template <typename Ser, typename Fnc>
+    void serialize(Ser& ser, const ::BinaryBuffer& buffer, Fnc&&) const {
+        // Buffers that have been written to directly in a memfd can be sent
+        // as is, without copying them to a new memfd first
+        OutgoingFds* outgoing_fds = OutgoingFds::current();
+        if (outgoing_fds && buffer.size() >= memfd_transfer_threshold) {
+            if (const std::optional<int> fd = buffer.seal_memfd()) {
+                ser.value1b(true);
+                ser.value8b(static_cast<uint64_t>(buffer.size()));
+                ser.value4b(outgoing_fds->attach(*fd));
+
+                return;
+            }
+        }
+
+        serialize_data(ser, buffer.data(), buffer.size());
+    }
+
+    template <typename Des, typename Fnc>
+    void deserialize(Des& des, std::vector<uint8_t>& buffer, Fnc&&) const {
+        bool through_memfd = false;
+        des.value1b(through_memfd);
+        if (through_memfd) {
+            const std::unique_ptr<MemfdMapping> mapping =
+                deserialize_mapping<std::unique_ptr<MemfdMapping>>(des);
+            buffer.assign(mapping->data(), mapping->data() + mapping->size());
+        } else {
+            deserialize_inline(des, buffer);
+        }
+    }
+
+    template <typename Des, typename Fnc>
+    void deserialize(Des& des, ::BinaryBuffer& buffer, Fnc&&) const {
+        bool through_memfd = false;
+        des.value1b(through_memfd);
+        if (through_memfd) {
+            buffer.set_mapping(
+                deserialize_mapping<std::shared_ptr<const MemfdMapping>>(des));
+        } else {
+            deserialize_inline(des, buffer.reset_to_owned());
+        }
+    }
+
+   private:
+    template <typename Ser>
+    void serialize_data(Ser& ser, const uint8_t* data, size_t size) const {
+        OutgoingFds* outgoing_fds = OutgoingFds::current();
+        const bool through_memfd =
+            outgoing_fds && size >= memfd_transfer_threshold;
+
+        ser.value1b(through_memfd);
+        ser.value8b(static_cast<uint64_t>(size));
+        if (through_memfd) {
+            ser.value4b(outgoing_fds->attach(create_sealed_memfd(data, size)));
+        } else {
+            ser.adapter().template writeBuffer<1>(data, size);
+        }
+    }
+
+    template <typename Des>
+    void deserialize_inline(Des& des, std::vector<uint8_t>& buffer) const {
+        uint64_t size = 0;
+        des.value8b(size);
+        if (size > max_size_) {
+            throw std::runtime_error("Binary buffer exceeds maximum size");
+        }
+
+        buffer.resize(size);
+        des.adapter().template readBuffer<1>(buffer.data(), buffer.size());
+    }
+
+    /**
+     * Read the size and file descriptor index written by `serialize_data()` and
+     * map the memfd. `P` is the smart pointer type the mapping should be
+     * wrapped in.
+     */
+    template <typename P, typename Des>
+    P deserialize_mapping(Des& des) const {
+        uint64_t size = 0;
+        uint32_t fd_index = 0;
+        des.value8b(size);
+        des.value4b(fd_index);
+
+        IncomingFds* incoming_fds = IncomingFds::current();
+        std::optional<int> fd =
+            incoming_fds ? incoming_fds->take(fd_index) : std::nullopt;
+        if (!fd) {
+            throw std::runtime_error(
+                "Binary buffer refers to a missing file descriptor");
+        }
+
+        return P(new MemfdMapping(*fd, static_cast<size_t>(size)));
+    }
+
+    size_t max_size_;
+};
+
+}  // namespace ext
+
+namespace traits {
+
+template <>
+struct ExtensionTraits<ext::LargeBinary, std::vector<uint8_t>> {
+    using TValue = void;
+    static constexpr bool SupportValueOverload = false;
+    static constexpr bool SupportObjectOverload = true;
+    static constexpr bool SupportLambdaOverload = false;
+};
+
+template <>
+struct ExtensionTraits<ext::LargeBinary, ::BinaryBuffer> {
+    using TValue = void;
+    static constexpr bool SupportValueOverload = false;
+    static constexpr bool SupportObjectOverload = true;
+    static constexpr bool SupportLambdaOverload = false;
+};
+
+}  // namespace traits
+}  // namespace bitsery
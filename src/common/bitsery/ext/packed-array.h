@@ -0,0 +1,91 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+#include <bitsery/details/serialization_common.h>
+#include <bitsery/traits/core/traits.h>
+
+namespace bitsery {
+namespace ext {
+
+/**
+ * An extension for serializing a contiguous container of trivially copyable
+ * objects as a single block of memory, instead of serializing every field of
+ * every object separately. This is used for objects that are sent in large
+ * numbers during audio processing, like note events.
+ *
+ * The element type needs to have the exact same layout on both sides, so it
+ * should only use fixed-width types and explicit padding. This matters because
+ * the Wine plugin host may be a 32-bit process while the native plugin is
+ * 64-bit, and doubles are only aligned to four bytes on 32-bit x86.
+ */
+class PackedArray {
+   public:
+    /**
+     * @param max_size The maximum number of elements in the container, the
+     *   same as the size passed to `s.container()`.
+     */
+    explicit PackedArray(size_t max_size) : max_size_(max_size) {}
+
+    template <typename Ser, typename C, typename Fnc>
+    void serialize(Ser& ser, const C& container, Fnc&&) const {
+        static_assert(
+            std::is_trivially_copyable_v<typename C::value_type>,
+            "PackedArray only works with trivially copyable elements");
+
+        ser.value4b(static_cast<uint32_t>(container.size()));
+        ser.adapter().template writeBuffer<1>(
+            reinterpret_cast<const uint8_t*>(container.data()),
+            container.size() * sizeof(typename C::value_type));
+    }
+
+    template <typename Des, typename C, typename Fnc>
+    void deserialize(Des& des, C& container, Fnc&&) const {
+        uint32_t size = 0;
+        des.value4b(size);
+        if (size > max_size_) {
+            throw std::runtime_error("Packed array exceeds maximum size");
+        }
+
+        container.resize(size);
+        des.adapter().template readBuffer<1>(
+            reinterpret_cast<uint8_t*>(container.data()),
+            container.size() * sizeof(typename C::value_type));
+    }
+
+   private:
+    size_t max_size_;
+};
+
+}  // namespace ext
+
+namespace traits {
+
+template <typename C>
+struct ExtensionTraits<ext::PackedArray, C> {
+    using TValue = void;
+    static constexpr bool SupportValueOverload = false;
+    static constexpr bool SupportObjectOverload = true;
+    static constexpr bool SupportLambdaOverload = false;
+};
+
+}  // namespace traits
+}  // namespace bitsery
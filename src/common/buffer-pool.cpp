@@ -0,0 +1,127 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "buffer-pool.h"
+
+#include <algorithm>
+
+/**
+ * The maximum number of idle buffers we'll keep around. This only comes into
+ * play when a lot of instances transfer state at the same time. When this limit
+ * is exceeded the buffer that has been idle the longest is freed.
+ */
+constexpr size_t max_idle_buffers = 8;
+
+SerializationBufferPool::Lease::Lease(SerializationBufferPool& pool,
+                                      std::unique_ptr<Buffer> buffer)
+    : pool_(pool), buffer_(std::move(buffer)) {}
+
+SerializationBufferPool::Lease::~Lease() noexcept {
+    pool_.release(std::move(buffer_));
+}
+
+SerializationBufferPool::SerializationBufferPool() {}
+
+SerializationBufferPool& SerializationBufferPool::global() {
+    static SerializationBufferPool pool{};
+
+    return pool;
+}
+
+SerializationBufferPool::Lease SerializationBufferPool::lease() {
+    std::unique_ptr<Buffer> buffer;
+    {
+        std::lock_guard lock(mutex_);
+        trim_locked(std::chrono::steady_clock::now());
+
+        if (!idle_buffers_.empty()) {
+            buffer = std::move(idle_buffers_.back().buffer);
+            idle_buffers_.pop_back();
+        }
+    }
+
+    if (!buffer) {
+        buffer = std::make_unique<Buffer>();
+    }
+
+    return Lease(*this, std::move(buffer));
+}
+
+void SerializationBufferPool::limit_idle_timeout(
+    std::chrono::steady_clock::duration timeout) {
+    std::lock_guard lock(mutex_);
+    idle_timeout_ = std::min(idle_timeout_, timeout);
+}
+
+void SerializationBufferPool::trim() {
+    std::lock_guard lock(mutex_);
+    trim_locked(std::chrono::steady_clock::now());
+}
+
+size_t SerializationBufferPool::pooled_bytes() {
+    std::lock_guard lock(mutex_);
+
+    size_t total = 0;
+    for (const auto& idle_buffer : idle_buffers_) {
+        total += idle_buffer.buffer->capacity_in_bytes();
+    }
+
+    return total;
+}
+
+size_t SerializationBufferPool::peak_buffer_size() {
+    std::lock_guard lock(mutex_);
+    return peak_buffer_size_;
+}
+
+void SerializationBufferPool::release(std::unique_ptr<Buffer> buffer) noexcept {
+    if (!buffer) {
+        return;
+    }
+
+    // The contents don't matter anymore, but we'll keep the capacity around
+    // until the buffer has been idle for too long
+    buffer->clear();
+
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard lock(mutex_);
+    peak_buffer_size_ =
+        std::max(peak_buffer_size_, buffer->capacity_in_bytes());
+    try {
+        idle_buffers_.push_back(
+            IdleBuffer{.buffer = std::move(buffer), .released_at = now});
+    } catch (const std::bad_alloc&) {
+        // If we can't store the buffer, then we'll just let it be freed
+    }
+
+    if (idle_buffers_.size() > max_idle_buffers) {
+        idle_buffers_.erase(idle_buffers_.begin());
+    }
+
+    trim_locked(now);
+}
+
+void SerializationBufferPool::trim_locked(
+    std::chrono::steady_clock::time_point now) noexcept {
+    // The buffers are sorted by the time they were returned, so everything up
+    // to the first buffer that hasn't expired yet can be freed
+    const auto first_active = std::find_if(
+        idle_buffers_.begin(), idle_buffers_.end(),
+        [&](const IdleBuffer& idle_buffer) {
+            return now - idle_buffer.released_at < idle_timeout_;
+        });
+    idle_buffers_.erase(idle_buffers_.begin(), first_active);
+}
@@ -0,0 +1,162 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <llvm/small-vector.h>
+
+/**
+ * The largest size a thread local buffer used on the audio thread may retain
+ * after handling a message. These buffers need to stay allocated so we don't
+ * have to allocate during audio processing, but if one of them ever grows past
+ * this size then it's reset afterwards so a single unusually large message
+ * doesn't keep that memory alive for the rest of the session.
+ */
+constexpr size_t realtime_buffer_retained_size = 256 << 10;
+
+/**
+ * The default amount of time a buffer can sit unused in the
+ * `SerializationBufferPool` before it gets freed.
+ *
+ * @see Configuration::buffer_idle_timeout
+ */
+constexpr std::chrono::steady_clock::duration default_buffer_idle_timeout =
+    std::chrono::seconds(10);
+
+/**
+ * A process-wide pool of serialization buffers for messages that are not sent
+ * or received on the audio thread. There are two size classes of buffers in
+ * yabridge:
+ *
+ * - Small thread local buffers with some inline capacity for audio thread
+ *   messages. Those need to stay allocated to stay realtime safe, and they're
+ *   reset when they exceed `realtime_buffer_retained_size`.
+ * - Everything else leases a buffer from this pool for the duration of a
+ *   single request and response. These buffers can temporarily grow to tens of
+ *   megabytes when transferring plugin state. Once they're returned they're
+ *   kept around so back-to-back state loads during project loading don't have
+ *   to reallocate and fault in the same memory again, but buffers that have
+ *   been idle for longer than the idle timeout are freed again.
+ *
+ * Previously every socket handling thread kept its own never-shrinking buffer,
+ * which with many plugin instances could add up to gigabytes of memory that
+ * would never be used again.
+ *
+ * Idle buffers are freed lazily when leasing or returning a buffer, and when
+ * `trim()` gets called. The Wine plugin host calls this periodically from its
+ * watchdog timer.
+ */
+class SerializationBufferPool {
+   public:
+    /**
+     * The buffer type stored in the pool. This can be passed to anything that
+     * accepts a `SerializationBufferBase`.
+     */
+    using Buffer = llvm::SmallVector<uint8_t, 0>;
+
+    /**
+     * A buffer leased from the pool. The buffer is returned to the pool when
+     * this object gets destroyed.
+     */
+    class Lease {
+       public:
+        Lease(SerializationBufferPool& pool, std::unique_ptr<Buffer> buffer);
+        ~Lease() noexcept;
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease(Lease&&) noexcept = default;
+        Lease& operator=(Lease&&) = delete;
+
+        inline Buffer& operator*() noexcept { return *buffer_; }
+        inline Buffer* operator->() noexcept { return buffer_.get(); }
+
+       private:
+        SerializationBufferPool& pool_;
+        /**
+         * Will be a null pointer if this lease has been moved from.
+         */
+        std::unique_ptr<Buffer> buffer_;
+    };
+
+    /**
+     * The pool shared by all plugin instances in this process.
+     */
+    static SerializationBufferPool& global();
+
+    /**
+     * Lease a buffer from the pool. This will reuse the most recently returned
+     * buffer if there is one, and allocate a new buffer otherwise.
+     */
+    Lease lease();
+
+    /**
+     * Set the amount of time after which unused buffers are freed. Since the
+     * pool is shared between all plugin instances in this process, the
+     * shortest timeout set by any instance is used.
+     */
+    void limit_idle_timeout(std::chrono::steady_clock::duration timeout);
+
+    /**
+     * Free all buffers that have been idle for longer than the idle timeout.
+     */
+    void trim();
+
+    /**
+     * The total capacity of all buffers currently stored in the pool, in bytes.
+     * This does not include buffers that are leased out.
+     */
+    size_t pooled_bytes();
+
+    /**
+     * The largest capacity any leased buffer has ever reached, in bytes.
+     */
+    size_t peak_buffer_size();
+
+   private:
+    SerializationBufferPool();
+
+    /**
+     * Return a buffer to the pool. Called by `Lease`'s destructor.
+     */
+    void release(std::unique_ptr<Buffer> buffer) noexcept;
+
+    /**
+     * `trim()`, but assumes `mutex_` is already locked.
+     */
+    void trim_locked(std::chrono::steady_clock::time_point now) noexcept;
+
+    struct IdleBuffer {
+        std::unique_ptr<Buffer> buffer;
+        std::chrono::steady_clock::time_point released_at;
+    };
+
+    std::mutex mutex_;
+    /**
+     * Buffers that are not currently leased out, sorted by the time they were
+     * returned. The most recently returned buffer is at the back.
+     */
+    std::vector<IdleBuffer> idle_buffers_;
+    std::chrono::steady_clock::duration idle_timeout_ =
+        default_buffer_idle_timeout;
+    size_t peak_buffer_size_ = 0;
+};
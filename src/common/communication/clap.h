@@ -166,6 +166,15 @@ class ClapSockets final : public Sockets {
         }
     }
 
+    void enable_compression() override {
+        // State and the parameter information are sent over the main thread
+        // sockets, the audio thread sockets only carry small realtime messages
+        host_plugin_main_thread_control_.enable_compression(
+            compression_statistics_);
+        plugin_host_main_thread_callback_.enable_compression(
+            compression_statistics_);
+    }
+
     /**
      * Create and listen on a dedicated audio thread socket for host->plugin
      * audio thread messages, and connect to the corresponding socket for
@@ -381,6 +390,9 @@ class ClapSockets final : public Sockets {
     SerializationBufferBase& audio_thread_buffer() {
         thread_local SerializationBuffer<2048> audio_thread_buffer{};
 
+        // Free the buffer again if a previous message made it grow too large
+        shrink_realtime_buffer(audio_thread_buffer);
+
         return audio_thread_buffer;
     }
 
@@ -16,8 +16,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <type_traits>
 #include <variant>
 
 #include <bitsery/adapter/buffer.h>
@@ -35,7 +38,10 @@
 #include <ghc/filesystem.hpp>
 
 #include "../bitsery/traits/small-vector.h"
+#include "../buffer-pool.h"
+#include "../compression.h"
 #include "../logging/common.h"
+#include "../memfd.h"
 #include "../utils.h"
 
 // Our input and output adapters for binary serialization always expect the data
@@ -80,6 +86,28 @@ using SerializationBuffer = llvm::SmallVector<uint8_t, N>;
  */
 using SerializationBufferBase = llvm::SmallVectorImpl<uint8_t>;
 
+/**
+ * Free a thread local serialization buffer's heap allocation if it has grown
+ * past `realtime_buffer_retained_size` (or twice its inline capacity, whichever
+ * is larger). These buffers are used on the audio thread and they're normally
+ * small, but some messages like MIDI events or VST2 chunks sent over the same
+ * socket can make them grow a lot. This should be called after the message has
+ * been handled.
+ *
+ * @note Move assigning an empty `SerializationBuffer<N>` does not work here
+ *   since `llvm::SmallVector` will keep its existing heap allocation when the
+ *   other vector still uses its inline storage. That's why we destroy and
+ *   recreate the buffer instead.
+ */
+template <unsigned N>
+void shrink_realtime_buffer(llvm::SmallVector<uint8_t, N>& buffer) noexcept {
+    if (buffer.capacity_in_bytes() >
+        std::max<size_t>(realtime_buffer_retained_size, N * 2)) [[unlikely]] {
+        std::destroy_at(&buffer);
+        std::construct_at(&buffer);
+    }
+}
+
 namespace asio {
 
 // These are copied verbatim `asio::buffer(std::vector<PodType, Allocator>&,
@@ -135,10 +163,31 @@ template <typename T, typename Socket>
 inline void write_object(Socket& socket,
                          const T& object,
                          SerializationBufferBase& buffer) {
+    // Large binary buffers serialized with `bitsery::ext::LargeBinary` will be
+    // written to a memfd and attached to this message as a file descriptor
+    // instead of being copied into `buffer`
+    OutgoingFds outgoing_fds{};
     const size_t size =
         bitsery::quickSerialization<OutputAdapter<SerializationBufferBase>>(
             buffer, object);
 
+    // If compression has been negotiated for this socket, then large messages
+    // will be compressed with LZ4 before sending them. This is indicated by a
+    // flag in the header. Messages that don't compress well are sent as is.
+    std::vector<uint8_t> compressed_buffer;
+    bool compressed = false;
+    if (size >= compression_threshold) [[unlikely]] {
+        if (CompressionStatistics* statistics =
+                MessageCompressionScope::current()) {
+            compressed = compress_message(buffer.data(), size,
+                                          compressed_buffer, *statistics);
+        }
+    }
+
+    const uint64_t payload_size = compressed ? compressed_buffer.size() : size;
+    const uint64_t header =
+        payload_size | (compressed ? message_header_compressed_flag : 0);
+
     // Tell the other side how large the object is so it can prepare a buffer
     // large enough before sending the data
     // NOTE: We're writing these sizes as a 64 bit integers, **not** as pointer
@@ -146,10 +195,18 @@ inline void write_object(Socket& socket,
     //       bit bridge. This won't make any function difference aside from the
     //       32-bit host application having to convert between 64 and 32 bit
     //       integers.
-    asio::write(socket, asio::buffer(std::array<uint64_t, 1>{size}));
+    if (outgoing_fds.empty()) [[likely]] {
+        asio::write(socket, asio::buffer(std::array<uint64_t, 1>{header}));
+    } else {
+        // The number of file descriptors is encoded in the header, and the file
+        // descriptors themselves are sent as ancillary data
+        send_message_header(socket.native_handle(), header, outgoing_fds);
+    }
     const size_t bytes_written =
-        asio::write(socket, asio::buffer(buffer, size));
-    assert(bytes_written == size);
+        compressed
+            ? asio::write(socket, asio::buffer(compressed_buffer))
+            : asio::write(socket, asio::buffer(buffer, size));
+    assert(bytes_written == payload_size);
 }
 
 /**
@@ -185,19 +242,34 @@ template <typename T, typename Socket>
 inline T& read_object(Socket& socket,
                       T& object,
                       SerializationBufferBase& buffer) {
-    // See the note above on the use of `uint64_t` instead of `size_t`
-    std::array<uint64_t, 1> message_length;
-    asio::read(socket, asio::buffer(message_length),
-               asio::transfer_exactly(sizeof(message_length)));
-
-    // Make sure the buffer is large enough
-    const size_t size = message_length[0];
-    buffer.resize(size);
-
-    // `asio::read/write` will handle all the packet splitting and
-    // merging for us, since local domain sockets have packet limits somewhere
-    // in the hundreds of kilobytes
-    asio::read(socket, asio::buffer(buffer), asio::transfer_exactly(size));
+    // See the note above on the use of `uint64_t` instead of `size_t`. The
+    // header is read using `recvmsg()` so we can also receive any file
+    // descriptors attached to the message. Those will be closed again at the
+    // end of this function if deserialization doesn't take ownership of them.
+    IncomingFds incoming_fds{};
+    const uint64_t header =
+        receive_message_header(socket.native_handle(), incoming_fds);
+
+    size_t size = header & ~message_header_compressed_flag;
+    if (header & message_header_compressed_flag) [[unlikely]] {
+        // Compressed messages are read into a temporary buffer first, and then
+        // decompressed into the serialization buffer
+        std::vector<uint8_t> compressed_buffer(size);
+        asio::read(socket, asio::buffer(compressed_buffer),
+                   asio::transfer_exactly(size));
+
+        size = compressed_message_size(compressed_buffer);
+        buffer.resize(size);
+        decompress_message(compressed_buffer, buffer.data(), size);
+    } else {
+        // Make sure the buffer is large enough
+        buffer.resize(size);
+
+        // `asio::read/write` will handle all the packet splitting and
+        // merging for us, since local domain sockets have packet limits
+        // somewhere in the hundreds of kilobytes
+        asio::read(socket, asio::buffer(buffer), asio::transfer_exactly(size));
+    }
 
     auto [_, success] =
         bitsery::quickDeserialization<InputAdapter<SerializationBufferBase>>(
@@ -342,11 +414,27 @@ class Sockets {
      */
     virtual void close() = 0;
 
+    /**
+     * Start compressing large messages on the sockets that may carry them, e.g.
+     * the sockets used for transferring plugin state. This should only be
+     * called on both sides after compression has been negotiated during the
+     * handshake. Compression statistics will be recorded in
+     * `compression_statistics_`.
+     */
+    virtual void enable_compression() = 0;
+
     /**
      * The base directory for our socket endpoints. All `*_endpoint` variables
      * below are files within this directory.
      */
     const ghc::filesystem::path base_dir_;
+
+    /**
+     * Compression ratios and timings for all messages sent and received on the
+     * sockets that have compression enabled. These are printed on the plugin
+     * side when the plugin shuts down.
+     */
+    CompressionStatistics compression_statistics_;
 };
 
 /**
@@ -617,6 +705,19 @@ class AdHocSocketHandler {
         }
     }
 
+    /**
+     * Compress large messages sent from this side from now on. This should only
+     * be called after compression has been negotiated with the other side
+     * during the handshake. Compressed messages can always be received
+     * regardless of whether this has been called.
+     *
+     * @param statistics The statistics object compression and decompression
+     *   times and ratios are recorded in. This should outlive this object.
+     */
+    void enable_compression(CompressionStatistics& statistics) noexcept {
+        compression_statistics_ = &statistics;
+    }
+
    protected:
     /**
      * Serialize and send an event over a socket. This is used for both the host
@@ -642,6 +743,10 @@ class AdHocSocketHandler {
         constexpr bool returns_void = std::is_void_v<
             std::invoke_result_t<F, asio::local::stream_protocol::socket&>>;
 
+        // If compression has been enabled, then `write_object()` will compress
+        // large messages sent from within this callback
+        MessageCompressionScope compression_scope(compression_statistics_);
+
         // XXX: Maybe at some point we should benchmark how often this
         //      ad hoc socket spawning mechanism gets used. If some hosts
         //      for instance consistently and repeatedly trigger this then
@@ -755,6 +860,8 @@ class AdHocSocketHandler {
                 active_secondary_requests[request_id] = Thread(
                     [&, request_id](
                         asio::local::stream_protocol::socket secondary_socket) {
+                        MessageCompressionScope compression_scope(
+                            compression_statistics_);
                         secondary_callback(secondary_socket);
 
                         // When we have processed this request, we'll join the
@@ -785,6 +892,8 @@ class AdHocSocketHandler {
         // socket shuts down
         while (true) {
             try {
+                MessageCompressionScope compression_scope(
+                    compression_statistics_);
                 primary_callback(socket_);
             } catch (const std::system_error&) {
                 // This happens when the sockets got closed because the plugin
@@ -900,6 +1009,32 @@ class AdHocSocketHandler {
      * this fallback behaviour should only happen during initialization.
      */
     std::atomic_bool sent_first_event_ = false;
+
+    /**
+     * Set through `enable_compression()` once compression has been negotiated
+     * during the handshake. When this is a null pointer, messages will never be
+     * compressed.
+     */
+    std::atomic<CompressionStatistics*> compression_statistics_ = nullptr;
+};
+
+/**
+ * Request objects larger than this many bytes may not be passed by value to a
+ * `TypedMessageHandler::receive_messages()` callback. Most requests are tiny,
+ * but things like plugin state, attribute lists, and parameter changes can
+ * contain large buffers that we don't want to copy for every function call.
+ */
+constexpr size_t max_copied_request_size = 64;
+
+/**
+ * A type that can be converted to `T&`, but not to a copy of `T`. Only used in
+ * unevaluated contexts to check whether a callback takes a request by
+ * reference.
+ */
+template <typename T>
+struct UncopyableRequestReference {
+    operator T&() const;
+    operator T() const = delete;
 };
 
 /**
@@ -1076,18 +1211,23 @@ class TypedMessageHandler : public AdHocSocketHandler<Thread> {
      * @param callback The function used to generate a response out of the
      *   request.  See the definition of `F` for more information.
      *
-     * @tparam F A function type in the form of `T::Response(T)` for every `T`
-     *   in `Request`. This way we can directly deserialize into a `T::Response`
-     *   on the side that called `receive_into(T, T::Response&)`.
+     * @tparam F A function type in the form of `T::Response(T&)` or
+     *   `T::Response(const T&)` for every `T` in `Request`. This way we can
+     *   directly deserialize into a `T::Response` on the side that called
+     *   `receive_into(T, T::Response&)`. The request is passed by reference so
+     *   the callback can use or move its data without copying it first. Taking
+     *   requests larger than `max_copied_request_size` by value is a compile
+     *   time error.
      * @tparam persistent_buffers If enabled, we'll reuse the buffers used for
      *   sending and receiving serialized data as well as the objects we're
      *   receiving into. This avoids allocations in the audio processing loop
      *   (after the first allocation of course). This is mostly relevant for the
      *   `YaProcessData` object stored inside of `YaAudioProcessor::Process`.
-     *   These buffers are thread local and will also never shrink, but that
-     *   should not be an issue with the `IAudioProcessor` and `IComponent`
-     *   functions.  Saving and loading state is handled on the main sockets,
-     *   which don't use these persistent buffers.
+     *   These buffers are thread local and they are only freed when they grow
+     *   past `realtime_buffer_retained_size`, which should not happen with the
+     *   `IAudioProcessor` and `IComponent` functions. Saving and loading state
+     *   is handled on the main sockets, which lease their buffers from
+     *   `SerializationBufferPool` instead.
      *
      * @relates ClapMessageHandler::send_event
      */
@@ -1111,15 +1251,27 @@ class TypedMessageHandler : public AdHocSocketHandler<Thread> {
                 // actual variant within an object and we then use some hackery
                 // to always keep the large process data object in memory.
                 // NOTE: Unlike the VST2 version, this persistent buffer is only
-                //       used for audio thread messages
+                //       used for audio thread messages. All other messages
+                //       lease a buffer from `SerializationBufferPool` instead,
+                //       so that large state transfers don't leave behind
+                //       megabytes of unused memory on every handler thread.
                 thread_local SerializationBuffer<256> persistent_buffer{};
                 thread_local Request persistent_object;
 
-                auto& request =
+                std::optional<SerializationBufferPool::Lease> leased_buffer;
+                if constexpr (!persistent_buffers) {
+                    leased_buffer.emplace(
+                        SerializationBufferPool::global().lease());
+                }
+                SerializationBufferBase& buffer =
                     persistent_buffers
-                        ? read_object<Request>(socket, persistent_object,
-                                               persistent_buffer)
-                        : read_object<Request>(socket, persistent_object);
+                        ? static_cast<SerializationBufferBase&>(
+                              persistent_buffer)
+                        : **leased_buffer;
+
+                auto& request =
+                    read_object<Request>(socket, persistent_object, buffer);
+                const size_t request_size = buffer.size();
 
                 // See the comment in `receive_into()` for more information
                 bool should_log_response = false;
@@ -1139,9 +1291,17 @@ class TypedMessageHandler : public AdHocSocketHandler<Thread> {
 
                 // We do the visiting here using a templated lambda. This way we
                 // always know for sure that the function returns the correct
-                // type, and we can scrap a lot of boilerplate elsewhere.
+                // type, and we can scrap a lot of boilerplate elsewhere. The
+                // request is passed to the callback as a reference to the
+                // deserialized object.
                 std::visit(
-                    [&]<typename T>(T object) {
+                    [&]<typename T>(T& object) {
+                        static_assert(
+                            sizeof(T) <= max_copied_request_size ||
+                                std::is_invocable_v<
+                                    F&, UncopyableRequestReference<T>>,
+                            "Large requests should be taken by reference");
+
                         typename T::Response response = callback(object);
 
                         if (should_log_response) {
@@ -1149,14 +1309,20 @@ class TypedMessageHandler : public AdHocSocketHandler<Thread> {
                             logger.log_response(!is_host_plugin, response);
                         }
 
-                        if constexpr (persistent_buffers) {
-                            write_object(socket, response, persistent_buffer);
-                        } else {
-                            write_object(socket, response);
-                        }
+                        write_object(socket, response, buffer);
                     },
                     // See above
                     get_request_variant(request));
+
+                // The thread local object still holds on to the request's
+                // data, which in the case of plugin state may be huge. The
+                // audio thread buffers are only freed in the rare case where
+                // they've grown too large.
+                if constexpr (persistent_buffers) {
+                    shrink_realtime_buffer(persistent_buffer);
+                } else if (request_size > realtime_buffer_retained_size) {
+                    persistent_object = Request{};
+                }
             };
 
         this->receive_multi(
@@ -205,11 +205,26 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
         // from the socket, so we can override this for specific function calls
         // that potentially need to have their responses handled on the same
         // calling thread (i.e. mutual recursion).
-        const Vst2EventResult response =
-            this->send([&](asio::local::stream_protocol::socket& socket) {
-                return data_converter.send_event(socket, event,
-                                                 serialization_buffer());
-            });
+        // With mutually recursive calls, `DefaultDataConverter::send_event()`
+        // may still be using this thread's buffer from another thread while
+        // this thread sends a nested event. The buffer can thus only be freed
+        // again once the outermost call has finished.
+        thread_local size_t send_depth = 0;
+        Vst2EventResult response;
+        send_depth++;
+        try {
+            response =
+                this->send([&](asio::local::stream_protocol::socket& socket) {
+                    return data_converter.send_event(socket, event,
+                                                     serialization_buffer());
+                });
+        } catch (...) {
+            send_depth--;
+            throw;
+        }
+        if (--send_depth == 0) {
+            shrink_realtime_buffer(serialization_buffer());
+        }
 
         if (logging) {
             auto [logger, is_dispatch] = *logging;
@@ -252,7 +267,7 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
         const auto process_event =
             [&](asio::local::stream_protocol::socket& socket,
                 bool on_main_thread) {
-                SerializationBufferBase& buffer = serialization_buffer();
+                auto& buffer = serialization_buffer();
 
                 auto event = read_object<Vst2Event>(socket, buffer);
                 if (logging) {
@@ -271,6 +286,12 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
                 }
 
                 write_object(socket, response, buffer);
+
+                // This buffer is already pretty large, but it can still grow
+                // immensely when sending and receiving preset data. In such
+                // cases we'll free the buffer again right away. This won't
+                // happen during audio processing.
+                shrink_realtime_buffer(buffer);
             };
 
         this->receive_multi(
@@ -293,25 +314,11 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
      * rather large, and because we want to avoid allocations on the audio
      * thread at all cost we'll just predefine a large buffer for every thread.
      */
-    SerializationBufferBase& serialization_buffer() {
+    SerializationBuffer<sizeof(DynamicVstEvents)>& serialization_buffer() {
         // This object also contains a `llvm::SmallVector` that has
         // capacity for a large-ish number of events so we don't have to
         // allocate under normal circumstances.
-        constexpr size_t initial_events_size = sizeof(DynamicVstEvents);
-        thread_local SerializationBuffer<initial_events_size> buffer{};
-
-        // This buffer is already pretty large, but it can still grow immensely
-        // when sending and receiving preset data. In such cases we do want to
-        // reallocate the buffer on the next event to free up memory again. This
-        // won't happen during audio processing.
-        if (buffer.size() > initial_events_size * 2) {
-            // NOTE: There's no `.shrink_to_fit()` implementation here, so we'll
-            //       just YOLO it and reinitialize the vector since we don't
-            //       need the old data
-            buffer = SerializationBuffer<initial_events_size>{};
-            // buffer.resize(initial_events_size);
-            // buffer.shrink_to_fit();
-        }
+        thread_local SerializationBuffer<sizeof(DynamicVstEvents)> buffer{};
 
         return buffer;
     }
@@ -391,6 +398,21 @@ class Vst2Sockets final : public Sockets {
         host_plugin_control_.close();
     }
 
+    void enable_compression() override {
+        // Chunks are sent over the `dispatch()` and `audioMaster()` sockets
+        host_plugin_dispatch_.enable_compression(compression_statistics_);
+        plugin_host_callback_.enable_compression(compression_statistics_);
+    }
+
+    /**
+     * The name of the shared memory object used for this instance's
+     * `ParameterMirror`. Both sides derive this from the socket base
+     * directory, so it doesn't need to be sent over.
+     */
+    std::string parameter_mirror_name() const {
+        return base_dir_.filename().string() + "-parameters";
+    }
+
     // The naming convention for these sockets is `<from>_<to>_<event>`. For
     // instance the socket named `host_plugin_dispatch` forwards
     // `AEffect.dispatch()` calls from the native VST host to the Windows VST
@@ -548,10 +570,12 @@ Vst2EventResult passthrough_event(AEffect* plugin,
             // In this case the plugin will have written its data stored in an
             // array to which a pointer is stored in `data`, with the return
             // value from the event determines how much data the plugin has
-            // written
+            // written. The plugin owns this buffer and it will stay valid until
+            // the next `effGetChunk()` call, so we can send it without making
+            // a copy first.
             const uint8_t* chunk_data = *static_cast<uint8_t**>(data);
-            return ChunkData{
-                std::vector<uint8_t>(chunk_data, chunk_data + return_value)};
+            return ChunkData{BinaryBuffer::borrow(
+                chunk_data, static_cast<size_t>(return_value))};
         },
         [&](const WantsVstRect&) -> Vst2EventResult::Payload {
             // The plugin should have written a pointer to a VstRect struct into
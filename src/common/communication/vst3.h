@@ -97,6 +97,13 @@ class Vst3Sockets final : public Sockets {
         }
     }
 
+    void enable_compression() override {
+        // State and the parameter information are sent over the main sockets,
+        // the audio processor sockets only carry small realtime messages
+        host_plugin_control_.enable_compression(compression_statistics_);
+        plugin_host_callback_.enable_compression(compression_statistics_);
+    }
+
     /**
      * Connect to the dedicated `IAudioProcessor` and `IComponent` handling
      * socket for a plugin object instance. This should be called on the plugin
@@ -263,6 +270,9 @@ class Vst3Sockets final : public Sockets {
     SerializationBufferBase& audio_processor_buffer() {
         thread_local SerializationBuffer<2048> audio_processor_buffer{};
 
+        // Free the buffer again if a previous message made it grow too large
+        shrink_realtime_buffer(audio_processor_buffer);
+
         return audio_processor_buffer;
     }
 
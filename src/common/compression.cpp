@@ -0,0 +1,250 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "compression.h"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#include <dlfcn.h>
+#include <lz4.h>
+
+constexpr char liblz4_library_name[] = "liblz4.so.1";
+constexpr char liblz4_library_fallback_name[] = "liblz4.so";
+
+/**
+ * If compressing a message doesn't shave off at least an eighth of its size,
+ * then we'll send it uncompressed instead. Decompressing on the other side is
+ * not free, and data like this is likely already compressed or encoded audio.
+ */
+constexpr size_t minimum_compression_savings_divisor = 8;
+
+std::atomic<void*> liblz4_handle = nullptr;
+std::atomic_bool liblz4_load_failed = false;
+std::mutex liblz4_mutex;
+
+#define LIBLZ4_FUNCTIONS     \
+    X(LZ4_compressBound)     \
+    X(LZ4_compress_default)  \
+    X(LZ4_decompress_safe)
+
+#define X(name) decltype(name)* lib##name = nullptr;
+LIBLZ4_FUNCTIONS
+#undef X
+
+namespace {
+thread_local CompressionStatistics* current_compression_statistics = nullptr;
+
+/**
+ * Try to load `liblz4`. Returns `false` if the library or any of its functions
+ * could not be found. We'll only try this once. Unlike with D-Bus we don't log
+ * anything here since the Wine plugin host always checks whether LZ4 is
+ * available during the handshake, even when compression is disabled. The
+ * plugin will print a warning if the option is enabled but either side could
+ * not load the library.
+ */
+bool setup_liblz4() {
+    std::lock_guard lock(liblz4_mutex);
+    if (liblz4_handle) {
+        return true;
+    } else if (liblz4_load_failed) {
+        return false;
+    }
+
+    void* handle = dlopen(liblz4_library_name, RTLD_LAZY | RTLD_LOCAL);
+    if (!handle) {
+        handle = dlopen(liblz4_library_fallback_name, RTLD_LAZY | RTLD_LOCAL);
+        if (!handle) {
+            liblz4_load_failed = true;
+            return false;
+        }
+    }
+
+#define X(name)                                                          \
+    do {                                                                 \
+        lib##name =                                                      \
+            reinterpret_cast<decltype(lib##name)>(dlsym(handle, #name)); \
+        if (!lib##name) {                                                \
+            liblz4_load_failed = true;                                   \
+            return false;                                                \
+        }                                                                \
+    } while (false);
+
+    LIBLZ4_FUNCTIONS
+
+#undef X
+
+    liblz4_handle.store(handle);
+
+    return true;
+}
+
+/**
+ * The number of microseconds since `start`.
+ */
+uint64_t microseconds_since(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+}
+}  // namespace
+
+bool is_compression_available() noexcept {
+    if (liblz4_handle) {
+        return true;
+    }
+
+    try {
+        return setup_liblz4();
+    } catch (...) {
+        return false;
+    }
+}
+
+std::string CompressionStatistics::format() const {
+    const uint64_t num_compressed = compressed_messages.load();
+    const uint64_t num_decompressed = decompressed_messages.load();
+    if (num_compressed == 0 && num_decompressed == 0) {
+        return "";
+    }
+
+    // The ratio is expressed as the compressed size as a percentage of the
+    // original size
+    const auto percentage = [](uint64_t part, uint64_t whole) {
+        return whole == 0 ? 0.0
+                          : static_cast<double>(part) * 100.0 /
+                                static_cast<double>(whole);
+    };
+
+    std::ostringstream message;
+    message << std::fixed << std::setprecision(1) << "compressed "
+            << num_compressed << " messages (" << compressed_bytes_in.load()
+            << " -> " << compressed_bytes_out.load() << " bytes, "
+            << percentage(compressed_bytes_out, compressed_bytes_in) << "%, "
+            << compression_time_us.load() << " us), skipped "
+            << incompressible_messages.load()
+            << " incompressible messages, decompressed " << num_decompressed
+            << " messages (" << decompressed_bytes_in.load() << " -> "
+            << decompressed_bytes_out.load() << " bytes, "
+            << decompression_time_us.load() << " us)";
+
+    return message.str();
+}
+
+MessageCompressionScope::MessageCompressionScope(
+    CompressionStatistics* statistics) noexcept
+    : previous_(current_compression_statistics) {
+    current_compression_statistics = statistics;
+}
+
+MessageCompressionScope::~MessageCompressionScope() noexcept {
+    current_compression_statistics = previous_;
+}
+
+CompressionStatistics* MessageCompressionScope::current() noexcept {
+    return current_compression_statistics;
+}
+
+bool compress_message(const uint8_t* data,
+                      size_t size,
+                      std::vector<uint8_t>& compressed,
+                      CompressionStatistics& statistics) {
+    if (!is_compression_available() ||
+        size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const uint64_t uncompressed_size = size;
+    const int bound = libLZ4_compressBound(static_cast<int>(size));
+    compressed.resize(sizeof(uncompressed_size) + static_cast<size_t>(bound));
+    std::memcpy(compressed.data(), &uncompressed_size,
+                sizeof(uncompressed_size));
+
+    const int compressed_size = libLZ4_compress_default(
+        reinterpret_cast<const char*>(data),
+        reinterpret_cast<char*>(compressed.data() + sizeof(uncompressed_size)),
+        static_cast<int>(size), bound);
+    if (compressed_size <= 0 ||
+        static_cast<size_t>(compressed_size) + sizeof(uncompressed_size) >
+            size - (size / minimum_compression_savings_divisor)) {
+        statistics.incompressible_messages.fetch_add(1);
+        return false;
+    }
+
+    compressed.resize(sizeof(uncompressed_size) +
+                      static_cast<size_t>(compressed_size));
+
+    statistics.compressed_messages.fetch_add(1);
+    statistics.compressed_bytes_in.fetch_add(size);
+    statistics.compressed_bytes_out.fetch_add(compressed.size());
+    statistics.compression_time_us.fetch_add(microseconds_since(start));
+
+    return true;
+}
+
+uint64_t compressed_message_size(const std::vector<uint8_t>& compressed) {
+    uint64_t uncompressed_size = 0;
+    if (compressed.size() < sizeof(uncompressed_size)) {
+        throw std::runtime_error("Received a truncated compressed message");
+    }
+
+    std::memcpy(&uncompressed_size, compressed.data(),
+                sizeof(uncompressed_size));
+
+    return uncompressed_size;
+}
+
+void decompress_message(const std::vector<uint8_t>& compressed,
+                        uint8_t* output,
+                        size_t output_size) {
+    // The other side will only compress messages if we told it we could load
+    // LZ4, so this should never fail
+    if (!is_compression_available()) {
+        throw std::runtime_error(
+            "Received a compressed message, but LZ4 is not available");
+    }
+
+    if (output_size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw std::runtime_error("Compressed message is too large");
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const size_t payload_size = compressed.size() - sizeof(uint64_t);
+    const int decompressed_size = libLZ4_decompress_safe(
+        reinterpret_cast<const char*>(compressed.data() + sizeof(uint64_t)),
+        reinterpret_cast<char*>(output), static_cast<int>(payload_size),
+        static_cast<int>(output_size));
+    if (decompressed_size < 0 ||
+        static_cast<size_t>(decompressed_size) != output_size) {
+        throw std::runtime_error("Could not decompress message");
+    }
+
+    if (CompressionStatistics* statistics = MessageCompressionScope::current()) {
+        statistics->decompressed_messages.fetch_add(1);
+        statistics->decompressed_bytes_in.fetch_add(compressed.size());
+        statistics->decompressed_bytes_out.fetch_add(output_size);
+        statistics->decompression_time_us.fetch_add(microseconds_since(start));
+    }
+}
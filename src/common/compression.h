@@ -0,0 +1,145 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Serialized messages at least this large are compressed with LZ4 before being
+ * sent when compression has been negotiated for a socket. Smaller messages are
+ * never worth the overhead. Binary blobs larger than `memfd_transfer_threshold`
+ * are sent separately through a memfd and thus don't count towards this size.
+ */
+constexpr size_t compression_threshold = 64 << 10;
+
+/**
+ * This bit in the 64-bit size header `write_object()` sends before every
+ * message indicates that the payload has been compressed. The compressed
+ * payload starts with the 64-bit uncompressed size, followed by the LZ4 block.
+ * This sits right below the bits used for the file descriptor count.
+ */
+constexpr uint64_t message_header_compressed_flag = uint64_t(1) << 55;
+
+/**
+ * Try to load `liblz4.so.1`. We load this at runtime the same way we load
+ * `libdbus-1.so` so yabridge doesn't gain a hard dependency on the library.
+ * Compression will only be negotiated when both the native plugin and the Wine
+ * plugin host can load the library. This is thread safe, and the library will
+ * only be loaded once.
+ *
+ * @return Whether LZ4 is available.
+ */
+bool is_compression_available() noexcept;
+
+/**
+ * Compression statistics for a set of sockets. These are updated atomically
+ * from any thread that sends or receives a compressed message, and they're
+ * printed when the plugin shuts down.
+ */
+struct CompressionStatistics {
+    std::atomic_uint64_t compressed_messages = 0;
+    std::atomic_uint64_t compressed_bytes_in = 0;
+    std::atomic_uint64_t compressed_bytes_out = 0;
+    std::atomic_uint64_t compression_time_us = 0;
+    /**
+     * Messages larger than `compression_threshold` that were sent as is
+     * because they did not compress well enough.
+     */
+    std::atomic_uint64_t incompressible_messages = 0;
+
+    std::atomic_uint64_t decompressed_messages = 0;
+    std::atomic_uint64_t decompressed_bytes_in = 0;
+    std::atomic_uint64_t decompressed_bytes_out = 0;
+    std::atomic_uint64_t decompression_time_us = 0;
+
+    /**
+     * Format the statistics as a human readable summary. Returns an empty
+     * string if no compressed messages have been sent or received.
+     */
+    std::string format() const;
+};
+
+/**
+ * While an object of this type is alive, `write_object()` calls on the current
+ * thread may compress large messages, and compressed messages sent or received
+ * on this thread will be accounted for in `statistics`. This is set up by
+ * `AdHocSocketHandler` around every read and write once compression has been
+ * negotiated for that socket. Decompression always works regardless of whether
+ * this scope is active, since the header tells us whether a message has been
+ * compressed.
+ */
+class MessageCompressionScope {
+   public:
+    /**
+     * @param statistics The statistics object to update, or a null pointer if
+     *   messages sent on this thread should not be compressed.
+     */
+    MessageCompressionScope(CompressionStatistics* statistics) noexcept;
+    ~MessageCompressionScope() noexcept;
+
+    MessageCompressionScope(const MessageCompressionScope&) = delete;
+    MessageCompressionScope& operator=(const MessageCompressionScope&) = delete;
+
+    /**
+     * The statistics for the scope active on this thread, or a null pointer if
+     * messages should not be compressed.
+     */
+    static CompressionStatistics* current() noexcept;
+
+   private:
+    CompressionStatistics* previous_;
+};
+
+/**
+ * Compress a serialized message. The result starts with the 64-bit uncompressed
+ * size, followed by an LZ4 block. If the data does not compress well, then this
+ * returns `false` and the message should be sent uncompressed instead.
+ *
+ * @param data The serialized message.
+ * @param size The size of `data`.
+ * @param compressed The vector to write the compressed data to.
+ * @param statistics The statistics to update.
+ *
+ * @return Whether the message has been compressed.
+ */
+bool compress_message(const uint8_t* data,
+                      size_t size,
+                      std::vector<uint8_t>& compressed,
+                      CompressionStatistics& statistics);
+
+/**
+ * Read the uncompressed size from a compressed message created by
+ * `compress_message()`.
+ *
+ * @throw std::runtime_error If the message is too short.
+ */
+uint64_t compressed_message_size(const std::vector<uint8_t>& compressed);
+
+/**
+ * Decompress a message created by `compress_message()` into `output`, which
+ * should be `compressed_message_size(compressed)` bytes large.
+ *
+ * @throw std::runtime_error If LZ4 is not available or if the data could not be
+ *   decompressed.
+ */
+void decompress_message(const std::vector<uint8_t>& compressed,
+                        uint8_t* output,
+                        size_t output_size);
@@ -16,6 +16,7 @@
 
 #include "configuration.h"
 
+#include <algorithm>
 #include <fnmatch.h>
 #include <fstream>
 
@@ -52,6 +53,7 @@
 #pragma pop_macro("__NT__")
 #pragma pop_macro("__CYGWIN__")
 
+#include "buffer-pool.h"
 #include "utils.h"
 
 namespace fs = ghc::filesystem;
@@ -114,6 +116,26 @@ Configuration::Configuration(const fs::path& config_path,
                 } else {
                     invalid_options.emplace_back(key);
                 }
+            } else if (key == "group_dedicated_gui_thread") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    group_dedicated_gui_thread = parsed_value->get();
+                } else {
+                    invalid_options.emplace_back(key);
+                }
+            } else if (key == "buffer_idle_timeout") {
+                if (const auto parsed_value = value.as_floating_point()) {
+                    buffer_idle_timeout = parsed_value->get();
+                } else if (const auto parsed_value = value.as_integer()) {
+                    buffer_idle_timeout = parsed_value->get();
+                } else {
+                    invalid_options.emplace_back(key);
+                }
+            } else if (key == "compress_large_messages") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    compress_large_messages = parsed_value->get();
+                } else {
+                    invalid_options.emplace_back(key);
+                }
             } else if (key == "disable_pipes") {
                 // This option can be either enabled or disable with a boolean,
                 // or it can be set to an absolute path
@@ -147,6 +169,22 @@ Configuration::Configuration(const fs::path& config_path,
                 } else {
                     invalid_options.emplace_back(key);
                 }
+            } else if (key == "editor_hidden_frame_rate") {
+                if (const auto parsed_value = value.as_floating_point()) {
+                    editor_hidden_frame_rate = parsed_value->get();
+                } else if (const auto parsed_value = value.as_integer()) {
+                    editor_hidden_frame_rate = parsed_value->get();
+                } else {
+                    invalid_options.emplace_back(key);
+                }
+            } else if (key == "editor_max_frame_rate") {
+                if (const auto parsed_value = value.as_floating_point()) {
+                    editor_max_frame_rate = parsed_value->get();
+                } else if (const auto parsed_value = value.as_integer()) {
+                    editor_max_frame_rate = parsed_value->get();
+                } else {
+                    invalid_options.emplace_back(key);
+                }
             } else if (key == "editor_xembed") {
                 if (const auto parsed_value = value.as_boolean()) {
                     editor_xembed = parsed_value->get();
@@ -164,12 +202,32 @@ Configuration::Configuration(const fs::path& config_path,
                 } else {
                     invalid_options.emplace_back(key);
                 }
+            } else if (key == "gui_stall_threshold") {
+                if (const auto parsed_value = value.as_floating_point()) {
+                    gui_stall_threshold = parsed_value->get();
+                } else if (const auto parsed_value = value.as_integer()) {
+                    gui_stall_threshold = parsed_value->get();
+                } else {
+                    invalid_options.emplace_back(key);
+                }
             } else if (key == "hide_daw") {
                 if (const auto parsed_value = value.as_boolean()) {
                     hide_daw = parsed_value->get();
                 } else {
                     invalid_options.emplace_back(key);
                 }
+            } else if (key == "parallel_state_restore") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    parallel_state_restore = parsed_value->get();
+                } else {
+                    invalid_options.emplace_back(key);
+                }
+            } else if (key == "vst2_disable_param_mirror") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    vst2_disable_param_mirror = parsed_value->get();
+                } else {
+                    invalid_options.emplace_back(key);
+                }
             } else if (key == "vst3_prefer_32bit") {
                 if (const auto parsed_value = value.as_boolean()) {
                     vst3_prefer_32bit = parsed_value->get();
@@ -190,3 +248,29 @@ std::chrono::steady_clock::duration Configuration::event_loop_interval()
     return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
         std::chrono::milliseconds(1000) / frame_rate.value_or(60.0));
 }
+
+std::chrono::steady_clock::duration Configuration::hidden_editor_interval()
+    const noexcept {
+    return std::max(
+        event_loop_interval(),
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::milliseconds(1000) /
+            editor_hidden_frame_rate.value_or(10.0)));
+}
+
+std::chrono::steady_clock::duration Configuration::buffer_idle_timeout_duration()
+    const noexcept {
+    if (buffer_idle_timeout) {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<float>(std::max(*buffer_idle_timeout, 0.0f)));
+    } else {
+        return default_buffer_idle_timeout;
+    }
+}
+
+std::chrono::steady_clock::duration
+Configuration::gui_stall_threshold_duration() const noexcept {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<float, std::milli>(
+            std::max(gui_stall_threshold.value_or(0.0f), 0.0f)));
+}
@@ -78,6 +78,39 @@ class Configuration {
      */
     std::optional<std::string> group;
 
+    /**
+     * When hosting this plugin in a plugin group, give it its own GUI thread
+     * with its own Win32 message loop and `MainContext` instead of sharing the
+     * group's GUI thread with every other plugin in the group. This way a
+     * single heavy editor can no longer stall the editors and main thread
+     * calls of the other plugins in the group. Plugins are still loaded into
+     * the same process, and they are still initialized one at a time. Not all
+     * plugins can handle their instances living on different threads, so this
+     * is disabled by default.
+     */
+    bool group_dedicated_gui_thread = false;
+
+    /**
+     * The number of seconds a large serialization buffer may sit unused before
+     * it gets freed. These buffers are used for transferring things like plugin
+     * state and can grow to tens of megabytes. Since the buffer pool is shared
+     * by every plugin instance in a process, the shortest timeout set by any
+     * instance is used.
+     *
+     * @relates buffer_idle_timeout_duration
+     */
+    std::optional<float> buffer_idle_timeout;
+
+    /**
+     * Compress messages larger than `compression_threshold` using LZ4 before
+     * sending them between the native plugin and the Wine plugin host. This is
+     * mostly useful for plugins with large, highly compressible state like XML
+     * presets. LZ4 is loaded at runtime, and compression will only be used if
+     * both sides can load it. On the Wine plugin host side this is the
+     * negotiated value, so it can be used as is.
+     */
+    bool compress_large_messages = false;
+
     /**
      * If enabled, we'll redirect the plugin's STDOUT and STDERR streams to this
      * file instead of using pipes to intersperse it with yabridge's other
@@ -112,6 +145,32 @@ class Configuration {
      */
     bool editor_force_dnd = false;
 
+    /**
+     * The number of times per second we'll run the editor's idle timer while
+     * the editor is hidden. This is used instead of `frame_rate` when the
+     * host's window is minimized, on another workspace, unmapped, or fully
+     * obscured by other windows. This also controls how often `effEditIdle()`
+     * gets called for VST2 plugins during that time.
+     *
+     * This defaults to 10 fps, but like with `frame_rate` we'll store it in an
+     * optional so we only show it in the startup message if it has been set
+     * explicitly.
+     *
+     * @relates hidden_editor_interval
+     */
+    std::optional<float> editor_hidden_frame_rate;
+
+    /**
+     * The maximum number of times per second a plugin's editor should be
+     * redrawn. When set, we'll use the X11 DAMAGE extension to measure how
+     * often the editor actually gets redrawn, and the plugin's Win32 timers
+     * will be throttled while that exceeds this rate. This is useful for
+     * plugins that redraw their meters at 100+ fps.
+     *
+     * @see DamageMonitor
+     */
+    std::optional<float> editor_max_frame_rate;
+
     /**
      * Use XEmbed instead of yabridge's normal editor embedding method. Wine's
      * XEmbed support is not very polished yet and tends to lead to rendering
@@ -132,6 +191,19 @@ class Configuration {
      */
     std::optional<float> frame_rate;
 
+    /**
+     * If set, print a warning whenever the Wine plugin host's GUI thread has
+     * been busy with a single task, message, or event loop cycle for longer
+     * than this many milliseconds, along with which plugin's editor (if any)
+     * was holding up the thread. This also causes every editor's timing
+     * statistics to be printed when it closes. Since plugin groups share a
+     * single GUI thread, the lowest threshold set by any plugin in the group
+     * is used.
+     *
+     * @relates gui_stall_threshold_duration
+     */
+    std::optional<float> gui_stall_threshold;
+
     /**
      * When this option is enabled, we'll report some random other string
      * instead of the actual name of the host when the plugin queries it. This
@@ -141,6 +213,17 @@ class Configuration {
      */
     bool hide_daw = false;
 
+    /**
+     * Restore plugin state (`effSetChunk()`, `IComponent::setState()`,
+     * `IEditController::setState()`, and `clap_plugin_state::load()`) on the
+     * thread that received the request instead of on the GUI thread. This lets
+     * multiple instances restore their state in parallel when loading a
+     * project, especially in plugin groups where all instances share a single
+     * GUI thread. Not all plugins tolerate this, so this is disabled by
+     * default.
+     */
+    bool parallel_state_restore = false;
+
     /**
      * Disable `IPlugViewContentScaleSupport::setContentScaleFactor()`. Wine
      * does not properly implement fractional DPI scaling, so without this
@@ -152,6 +235,18 @@ class Configuration {
      */
     bool editor_disable_host_scaling = false;
 
+    /**
+     * Always ask the plugin for its parameter values when the host calls
+     * `getParameter()` on a VST2 plugin, instead of answering those calls from
+     * the shared memory parameter table maintained by the Wine plugin host.
+     * Only needed for plugins that change their parameters without calling
+     * `audioMasterAutomate()` or `audioMasterUpdateDisplay()`, or plugins that
+     * do something other than returning a value in `getParameter()`.
+     *
+     * @see ParameterMirror
+     */
+    bool vst2_disable_param_mirror = false;
+
     /**
      * If a merged bundle contains both the 64-bit and the 32-bit versions of a
      * Windows VST3 plugin (in the `x86_64-win` and the `x86-win` directories),
@@ -190,20 +285,54 @@ class Configuration {
      */
     std::chrono::steady_clock::duration event_loop_interval() const noexcept;
 
+    /**
+     * The delay in milliseconds between calls to the editor's idle timer while
+     * the editor is hidden. This is based on `editor_hidden_frame_rate`, and it
+     * will never be shorter than `event_loop_interval()`.
+     */
+    std::chrono::steady_clock::duration hidden_editor_interval()
+        const noexcept;
+
+    /**
+     * The amount of time after which idle serialization buffers should be
+     * freed. This is based on `buffer_idle_timeout`.
+     */
+    std::chrono::steady_clock::duration buffer_idle_timeout_duration()
+        const noexcept;
+
+    /**
+     * The GUI stall detector's threshold. Only meaningful when
+     * `gui_stall_threshold` is set.
+     */
+    std::chrono::steady_clock::duration gui_stall_threshold_duration()
+        const noexcept;
+
     template <typename S>
     void serialize(S& s) {
         s.ext(group, bitsery::ext::InPlaceOptional(),
               [](S& s, auto& v) { s.text1b(v, 4096); });
+        s.value1b(group_dedicated_gui_thread);
 
+        s.ext(buffer_idle_timeout, bitsery::ext::InPlaceOptional(),
+              [](S& s, auto& v) { s.value4b(v); });
+        s.value1b(compress_large_messages);
         s.ext(disable_pipes, bitsery::ext::InPlaceOptional(),
               [](S& s, auto& v) { s.ext(v, bitsery::ext::GhcPath{}); });
         s.value1b(editor_coordinate_hack);
         s.value1b(editor_force_dnd);
+        s.ext(editor_hidden_frame_rate, bitsery::ext::InPlaceOptional(),
+              [](S& s, auto& v) { s.value4b(v); });
+        s.ext(editor_max_frame_rate, bitsery::ext::InPlaceOptional(),
+              [](S& s, auto& v) { s.value4b(v); });
         s.value1b(editor_xembed);
         s.ext(frame_rate, bitsery::ext::InPlaceOptional(),
               [](S& s, auto& v) { s.value4b(v); });
+        s.ext(gui_stall_threshold, bitsery::ext::InPlaceOptional(),
+              [](S& s, auto& v) { s.value4b(v); });
         s.value1b(hide_daw);
+        s.value1b(parallel_state_restore);
         s.value1b(editor_disable_host_scaling);
+        s.value1b(vst2_disable_param_mirror);
         s.value1b(vst3_prefer_32bit);
 
         s.ext(matched_file, bitsery::ext::InPlaceOptional(),
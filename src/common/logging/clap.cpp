@@ -348,6 +348,17 @@ bool ClapLogger::log_request(
     });
 }
 
+bool ClapLogger::log_request(
+    bool is_host_plugin,
+    const clap::ext::params::plugin::GetValues& request) {
+    return log_request_base(is_host_plugin, [&](auto& message) {
+        message << request.instance_id
+                << ": clap_plugin_params::get_value() and "
+                   "clap_plugin_params::value_to_text() for "
+                << request.param_ids.size() << " parameters (prefetched)";
+    });
+}
+
 bool ClapLogger::log_request(
     bool is_host_plugin,
     const clap::ext::params::plugin::ValueToText& request) {
@@ -958,6 +969,15 @@ void ClapLogger::log_response(
     });
 }
 
+void ClapLogger::log_response(
+    bool is_host_plugin,
+    const clap::ext::params::plugin::GetValuesResponse& response) {
+    log_response_base(is_host_plugin, [&](auto& message) {
+        message << "<double, char*> for " << response.values.size()
+                << " parameters";
+    });
+}
+
 void ClapLogger::log_response(
     bool is_host_plugin,
     const clap::ext::params::plugin::ValueToTextResponse& response) {
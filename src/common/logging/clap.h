@@ -132,6 +132,8 @@ class ClapLogger {
                      const clap::ext::params::plugin::GetInfos&);
     bool log_request(bool is_host_plugin,
                      const clap::ext::params::plugin::GetValue&);
+    bool log_request(bool is_host_plugin,
+                     const clap::ext::params::plugin::GetValues&);
     bool log_request(bool is_host_plugin,
                      const clap::ext::params::plugin::ValueToText&);
     bool log_request(bool is_host_plugin,
@@ -233,6 +235,8 @@ class ClapLogger {
                       bool from_cache = false);
     void log_response(bool is_host_plugin,
                       const clap::ext::params::plugin::GetValueResponse&);
+    void log_response(bool is_host_plugin,
+                      const clap::ext::params::plugin::GetValuesResponse&);
     void log_response(bool is_host_plugin,
                       const clap::ext::params::plugin::ValueToTextResponse&);
     void log_response(bool is_host_plugin,
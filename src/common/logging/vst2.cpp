@@ -341,10 +341,13 @@ void Vst2Logger::log_get_parameter(int index) {
     }
 }
 
-void Vst2Logger::log_get_parameter_response(float value) {
+void Vst2Logger::log_get_parameter_response(float value, bool from_cache) {
     if (logger_.verbosity_ >= Logger::Verbosity::most_events) [[unlikely]] {
         std::ostringstream message;
         message << "   getParameter() :: " << value;
+        if (from_cache) {
+            message << " (from cache)";
+        }
 
         log(message.str());
     }
@@ -240,6 +240,16 @@ bool Vst3Logger::log_request(
     });
 }
 
+bool Vst3Logger::log_request(bool is_host_plugin,
+                             const YaEditController::GetParamValues& request) {
+    return log_request_base(is_host_plugin, [&](auto& message) {
+        message << request.instance_id
+                << ": IEditController::getParamNormalized() and "
+                   "IEditController::getParamStringByValue() for "
+                << request.ids.size() << " parameters (prefetched)";
+    });
+}
+
 bool Vst3Logger::log_request(
     bool is_host_plugin,
     const YaEditController::GetParamStringByValue& request) {
@@ -420,6 +430,17 @@ bool Vst3Logger::log_request(
     });
 }
 
+bool Vst3Logger::log_request(
+    bool is_host_plugin,
+    const YaKeyswitchController::GetKeyswitchInfos& request) {
+    return log_request_base(is_host_plugin, [&](auto& message) {
+        message << request.instance_id
+                << ": IKeyswitchController::getKeyswitchInfo(busIndex = "
+                << request.bus_index << ", channel = " << request.channel
+                << ", ..., &info) (batched)";
+    });
+}
+
 bool Vst3Logger::log_request(
     bool is_host_plugin,
     const YaMidiLearn::OnLiveMIDIControllerInput& request) {
@@ -443,6 +464,16 @@ bool Vst3Logger::log_request(
     });
 }
 
+bool Vst3Logger::log_request(
+    bool is_host_plugin,
+    const YaMidiMapping::GetMidiControllerAssignments& request) {
+    return log_request_base(is_host_plugin, [&](auto& message) {
+        message << request.instance_id
+                << ": IMidiMapping::getMidiControllerAssignment(busIndex = "
+                << request.bus_index << ", ..., &id) (batched)";
+    });
+}
+
 bool Vst3Logger::log_request(
     bool is_host_plugin,
     const YaNoteExpressionController::GetNoteExpressionCount& request) {
@@ -467,6 +498,18 @@ bool Vst3Logger::log_request(
     });
 }
 
+bool Vst3Logger::log_request(
+    bool is_host_plugin,
+    const YaNoteExpressionController::GetNoteExpressionInfos& request) {
+    return log_request_base(is_host_plugin, [&](auto& message) {
+        message
+            << request.instance_id
+            << ": INoteExpressionController::getNoteExpressionInfo(busIndex = "
+            << request.bus_index << ", channel = " << request.channel
+            << ", ..., &info) (batched)";
+    });
+}
+
 bool Vst3Logger::log_request(
     bool is_host_plugin,
     const YaNoteExpressionController::GetNoteExpressionStringByValue& request) {
@@ -801,6 +844,15 @@ bool Vst3Logger::log_request(bool is_host_plugin,
     });
 }
 
+bool Vst3Logger::log_request(bool is_host_plugin,
+                             const YaUnitInfo::GetUnitInfos& request) {
+    return log_request_base(is_host_plugin, [&](auto& message) {
+        message << request.instance_id
+                << ": IUnitInfo::getUnitInfo(...) and "
+                   "IUnitInfo::getProgramListInfo(...) (batched)";
+    });
+}
+
 bool Vst3Logger::log_request(bool is_host_plugin,
                              const YaUnitInfo::GetProgramName& request) {
     return log_request_base(is_host_plugin, [&](auto& message) {
@@ -810,6 +862,16 @@ bool Vst3Logger::log_request(bool is_host_plugin,
     });
 }
 
+bool Vst3Logger::log_request(bool is_host_plugin,
+                             const YaUnitInfo::GetProgramNames& request) {
+    return log_request_base(is_host_plugin, [&](auto& message) {
+        message << request.instance_id
+                << ": IUnitInfo::getProgramName(listId = " << request.list_id
+                << ", ..., &name) (batched, " << request.num_programs
+                << " programs)";
+    });
+}
+
 bool Vst3Logger::log_request(bool is_host_plugin,
                              const YaUnitInfo::GetProgramInfo& request) {
     return log_request_base(is_host_plugin, [&](auto& message) {
@@ -1110,6 +1172,15 @@ bool Vst3Logger::log_request(bool is_host_plugin,
     });
 }
 
+bool Vst3Logger::log_request(bool is_host_plugin,
+                             const YaComponent::GetBusTopology& request) {
+    return log_request_base(is_host_plugin, [&](auto& message) {
+        message << request.instance_id
+                << ": IComponent::getBusInfo(...) and "
+                   "IAudioProcessor::getBusArrangement(...) (batched)";
+    });
+}
+
 bool Vst3Logger::log_request(bool is_host_plugin,
                              const YaComponent::GetRoutingInfo& request) {
     return log_request_base(is_host_plugin, [&](auto& message) {
@@ -1131,6 +1202,14 @@ bool Vst3Logger::log_request(bool is_host_plugin,
     });
 }
 
+bool Vst3Logger::log_request(bool is_host_plugin,
+                             const YaComponent::ActivateBusses& request) {
+    return log_request_base(is_host_plugin, [&](auto& message) {
+        message << request.instance_id << ": IComponent::activateBus(...) for "
+                << request.activations.size() << " busses (batched)";
+    });
+}
+
 bool Vst3Logger::log_request(bool is_host_plugin,
                              const YaComponent::SetActive& request) {
     return log_request_base(is_host_plugin, [&](auto& message) {
@@ -1479,6 +1558,15 @@ void Vst3Logger::log_response(
     });
 }
 
+void Vst3Logger::log_response(
+    bool is_host_plugin,
+    const YaEditController::GetParamValuesResponse& response) {
+    log_response_base(is_host_plugin, [&](auto& message) {
+        message << "<ParamValue, String128> for " << response.values.size()
+                << " parameters";
+    });
+}
+
 void Vst3Logger::log_response(
     bool is_host_plugin,
     const YaEditController::GetParamStringByValueResponse& response) {
@@ -1527,6 +1615,15 @@ void Vst3Logger::log_response(
     });
 }
 
+void Vst3Logger::log_response(
+    bool is_host_plugin,
+    const YaKeyswitchController::GetKeyswitchInfosResponse& response) {
+    log_response_base(is_host_plugin, [&](auto& message) {
+        message << "<KeyswitchInfo> for " << response.infos.size()
+                << " keyswitches";
+    });
+}
+
 void Vst3Logger::log_response(
     bool is_host_plugin,
     const YaMidiMapping::GetMidiControllerAssignmentResponse& response) {
@@ -1538,6 +1635,15 @@ void Vst3Logger::log_response(
     });
 }
 
+void Vst3Logger::log_response(
+    bool is_host_plugin,
+    const YaMidiMapping::GetMidiControllerAssignmentsResponse& response) {
+    log_response_base(is_host_plugin, [&](auto& message) {
+        message << response.assignments.size()
+                << " MIDI controller assignments";
+    });
+}
+
 void Vst3Logger::log_response(
     bool is_host_plugin,
     const YaNoteExpressionController::GetNoteExpressionInfoResponse& response) {
@@ -1551,6 +1657,16 @@ void Vst3Logger::log_response(
     });
 }
 
+void Vst3Logger::log_response(
+    bool is_host_plugin,
+    const YaNoteExpressionController::GetNoteExpressionInfosResponse&
+        response) {
+    log_response_base(is_host_plugin, [&](auto& message) {
+        message << "<NoteExpressionTypeInfo> for " << response.infos.size()
+                << " note expression types";
+    });
+}
+
 void Vst3Logger::log_response(
     bool is_host_plugin,
     const YaNoteExpressionController::GetNoteExpressionStringByValueResponse&
@@ -1697,6 +1813,16 @@ void Vst3Logger::log_response(
     });
 }
 
+void Vst3Logger::log_response(
+    bool is_host_plugin,
+    const YaUnitInfo::GetUnitInfosResponse& response) {
+    log_response_base(is_host_plugin, [&](auto& message) {
+        message << "<UnitInfo> for " << response.unit_infos.size()
+                << " units, <ProgramListInfo> for "
+                << response.program_list_infos.size() << " program lists";
+    });
+}
+
 void Vst3Logger::log_response(
     bool is_host_plugin,
     const YaUnitInfo::GetProgramNameResponse& response) {
@@ -1709,6 +1835,14 @@ void Vst3Logger::log_response(
     });
 }
 
+void Vst3Logger::log_response(
+    bool is_host_plugin,
+    const YaUnitInfo::GetProgramNamesResponse& response) {
+    log_response_base(is_host_plugin, [&](auto& message) {
+        message << "<String128> for " << response.names.size() << " programs";
+    });
+}
+
 void Vst3Logger::log_response(
     bool is_host_plugin,
     const YaUnitInfo::GetProgramInfoResponse& response) {
@@ -1759,7 +1893,8 @@ void Vst3Logger::log_response(
 
 void Vst3Logger::log_response(
     bool is_host_plugin,
-    const YaAudioProcessor::GetBusArrangementResponse& response) {
+    const YaAudioProcessor::GetBusArrangementResponse& response,
+    bool from_cache) {
     log_response_base(is_host_plugin, [&](auto& message) {
         message << response.result.string();
         if (response.result == Steinberg::kResultOk) {
@@ -1768,6 +1903,9 @@ void Vst3Logger::log_response(
                 << std::bitset<sizeof(Steinberg::Vst::SpeakerArrangement) * 8>(
                        response.arr)
                 << ">";
+            if (from_cache) {
+                message << " (from cache)";
+            }
         }
     });
 }
@@ -1856,6 +1994,31 @@ void Vst3Logger::log_response(bool is_host_plugin,
     });
 }
 
+void Vst3Logger::log_response(
+    bool is_host_plugin,
+    const YaComponent::GetBusTopologyResponse& response) {
+    log_response_base(is_host_plugin, [&](auto& message) {
+        message << "<BusInfo> for " << response.audio_inputs.size() << " + "
+                << response.audio_outputs.size() << " audio busses and "
+                << response.event_inputs.size() << " + "
+                << response.event_outputs.size() << " event busses";
+    });
+}
+
+void Vst3Logger::log_response(
+    bool is_host_plugin,
+    const YaComponent::ActivateBussesResponse& response) {
+    log_response_base(is_host_plugin, [&](auto& message) {
+        message << "[";
+        bool is_first = true;
+        for (const UniversalTResult& result : response.results) {
+            message << (is_first ? "" : ", ") << result.string();
+            is_first = false;
+        }
+        message << "]";
+    });
+}
+
 void Vst3Logger::log_response(
     bool is_host_plugin,
     const YaComponent::GetRoutingInfoResponse& response) {
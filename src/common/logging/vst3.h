@@ -83,6 +83,8 @@ class Vst3Logger {
                      const YaEditController::SetComponentState&);
     bool log_request(bool is_host_plugin,
                      const YaEditController::GetParameterInfos&);
+    bool log_request(bool is_host_plugin,
+                     const YaEditController::GetParamValues&);
     bool log_request(bool is_host_plugin,
                      const YaEditController::GetParamStringByValue&);
     bool log_request(bool is_host_plugin,
@@ -113,14 +115,20 @@ class Vst3Logger {
                      const YaKeyswitchController::GetKeyswitchCount&);
     bool log_request(bool is_host_plugin,
                      const YaKeyswitchController::GetKeyswitchInfo&);
+    bool log_request(bool is_host_plugin,
+                     const YaKeyswitchController::GetKeyswitchInfos&);
     bool log_request(bool is_host_plugin,
                      const YaMidiLearn::OnLiveMIDIControllerInput&);
     bool log_request(bool is_host_plugin,
                      const YaMidiMapping::GetMidiControllerAssignment&);
+    bool log_request(bool is_host_plugin,
+                     const YaMidiMapping::GetMidiControllerAssignments&);
     bool log_request(bool is_host_plugin,
                      const YaNoteExpressionController::GetNoteExpressionCount&);
     bool log_request(bool is_host_plugin,
                      const YaNoteExpressionController::GetNoteExpressionInfo&);
+    bool log_request(bool is_host_plugin,
+                     const YaNoteExpressionController::GetNoteExpressionInfos&);
     bool log_request(
         bool is_host_plugin,
         const YaNoteExpressionController::GetNoteExpressionStringByValue&);
@@ -173,7 +181,9 @@ class Vst3Logger {
                      const YaUnitInfo::GetProgramListCount&);
     bool log_request(bool is_host_plugin,
                      const YaUnitInfo::GetProgramListInfo&);
+    bool log_request(bool is_host_plugin, const YaUnitInfo::GetUnitInfos&);
     bool log_request(bool is_host_plugin, const YaUnitInfo::GetProgramName&);
+    bool log_request(bool is_host_plugin, const YaUnitInfo::GetProgramNames&);
     bool log_request(bool is_host_plugin, const YaUnitInfo::GetProgramInfo&);
     bool log_request(bool is_host_plugin,
                      const YaUnitInfo::HasProgramPitchNames&);
@@ -210,8 +220,10 @@ class Vst3Logger {
     bool log_request(bool is_host_plugin, const YaComponent::SetIoMode&);
     bool log_request(bool is_host_plugin, const YaComponent::GetBusCount&);
     bool log_request(bool is_host_plugin, const YaComponent::GetBusInfo&);
+    bool log_request(bool is_host_plugin, const YaComponent::GetBusTopology&);
     bool log_request(bool is_host_plugin, const YaComponent::GetRoutingInfo&);
     bool log_request(bool is_host_plugin, const YaComponent::ActivateBus&);
+    bool log_request(bool is_host_plugin, const YaComponent::ActivateBusses&);
     bool log_request(bool is_host_plugin, const YaComponent::SetActive&);
     bool log_request(bool is_host_plugin,
                      const YaPrefetchableSupport::GetPrefetchableSupport&);
@@ -272,6 +284,8 @@ class Vst3Logger {
     void log_response(bool is_host_plugin,
                       const YaEditController::GetParameterInfosResponse&,
                       bool from_cache = false);
+    void log_response(bool is_host_plugin,
+                      const YaEditController::GetParamValuesResponse&);
     void log_response(bool is_host_plugin,
                       const YaEditController::GetParamStringByValueResponse&);
     void log_response(bool is_host_plugin,
@@ -280,12 +294,20 @@ class Vst3Logger {
                       const YaEditController::CreateViewResponse&);
     void log_response(bool is_host_plugin,
                       const YaKeyswitchController::GetKeyswitchInfoResponse&);
+    void log_response(bool is_host_plugin,
+                      const YaKeyswitchController::GetKeyswitchInfosResponse&);
     void log_response(
         bool is_host_plugin,
         const YaMidiMapping::GetMidiControllerAssignmentResponse&);
+    void log_response(
+        bool is_host_plugin,
+        const YaMidiMapping::GetMidiControllerAssignmentsResponse&);
     void log_response(
         bool is_host_plugin,
         const YaNoteExpressionController::GetNoteExpressionInfoResponse&);
+    void log_response(
+        bool is_host_plugin,
+        const YaNoteExpressionController::GetNoteExpressionInfosResponse&);
     void log_response(bool is_host_plugin,
                       const YaNoteExpressionController::
                           GetNoteExpressionStringByValueResponse&);
@@ -312,8 +334,12 @@ class Vst3Logger {
                       const YaUnitInfo::GetUnitInfoResponse&);
     void log_response(bool is_host_plugin,
                       const YaUnitInfo::GetProgramListInfoResponse&);
+    void log_response(bool is_host_plugin,
+                      const YaUnitInfo::GetUnitInfosResponse&);
     void log_response(bool is_host_plugin,
                       const YaUnitInfo::GetProgramNameResponse&);
+    void log_response(bool is_host_plugin,
+                      const YaUnitInfo::GetProgramNamesResponse&);
     void log_response(bool is_host_plugin,
                       const YaUnitInfo::GetProgramInfoResponse&);
     void log_response(bool is_host_plugin,
@@ -326,7 +352,8 @@ class Vst3Logger {
 
     // Audio processor control message responses
     void log_response(bool is_host_plugin,
-                      const YaAudioProcessor::GetBusArrangementResponse&);
+                      const YaAudioProcessor::GetBusArrangementResponse&,
+                      bool from_cache = false);
     void log_response(bool is_host_plugin,
                       const YaAudioProcessor::ProcessResponse&);
     void log_response(bool is_host_plugin,
@@ -334,6 +361,10 @@ class Vst3Logger {
     void log_response(bool is_host_plugin,
                       const YaComponent::GetBusInfoResponse&,
                       bool from_cache = false);
+    void log_response(bool is_host_plugin,
+                      const YaComponent::GetBusTopologyResponse&);
+    void log_response(bool is_host_plugin,
+                      const YaComponent::ActivateBussesResponse&);
     void log_response(bool is_host_plugin,
                       const YaComponent::GetRoutingInfoResponse&);
     void log_response(bool is_host_plugin,
@@ -0,0 +1,481 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "memfd.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * The maximum number of file descriptors that can be attached to a single
+ * message. We only ever attach one file descriptor per large buffer, and no
+ * message contains more than a handful of those.
+ */
+constexpr size_t max_attached_fds = 16;
+
+namespace {
+thread_local OutgoingFds* current_outgoing_fds = nullptr;
+thread_local IncomingFds* current_incoming_fds = nullptr;
+
+/**
+ * Wait until the socket becomes readable or writable. Asio puts sockets in
+ * non-blocking mode when they're used asynchronously, and in that case
+ * `sendmsg()` and `recvmsg()` can return `EAGAIN` like they would in Asio's own
+ * synchronous operations.
+ */
+void wait_for_socket(int socket_fd, short events) {
+    pollfd poll_fd{.fd = socket_fd, .events = events, .revents = 0};
+    while (poll(&poll_fd, 1, -1) == -1) {
+        if (errno != EINTR) {
+            throw std::system_error(errno, std::system_category());
+        }
+    }
+}
+}  // namespace
+
+int create_sealed_memfd(const uint8_t* data, size_t size) {
+    const int fd =
+        memfd_create("yabridge-buffer", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd == -1) {
+        throw std::system_error(errno, std::system_category(),
+                                "Could not create memfd");
+    }
+
+    size_t bytes_written = 0;
+    while (bytes_written < size) {
+        const ssize_t result =
+            write(fd, data + bytes_written, size - bytes_written);
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const int error = errno;
+            close(fd);
+            throw std::system_error(error, std::system_category(),
+                                    "Could not write to memfd");
+        }
+
+        bytes_written += static_cast<size_t>(result);
+    }
+
+    if (fcntl(fd, F_ADD_SEALS,
+              F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == -1) {
+        const int error = errno;
+        close(fd);
+        throw std::system_error(error, std::system_category(),
+                                "Could not seal memfd");
+    }
+
+    return fd;
+}
+
+MemfdMapping::MemfdMapping(int fd, size_t size) : size_(size) {
+    // We don't want the other side to be able to modify the buffer after
+    // sending it, or to have the file be smaller than what we're going to
+    // map. The latter would cause a `SIGBUS` when reading past the end.
+    struct stat file_info;
+    const int seals = fcntl(fd, F_GET_SEALS);
+    if (fstat(fd, &file_info) == -1 || seals == -1 ||
+        (seals & (F_SEAL_SHRINK | F_SEAL_WRITE)) !=
+            (F_SEAL_SHRINK | F_SEAL_WRITE) ||
+        static_cast<size_t>(file_info.st_size) < size) {
+        close(fd);
+        throw std::system_error(std::make_error_code(std::errc::io_error),
+                                "Received an invalid memfd");
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                         fd, 0);
+    const int error = errno;
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::system_error(error, std::system_category(),
+                                "Could not map memfd");
+    }
+
+    data_ = static_cast<uint8_t*>(mapping);
+}
+
+MemfdMapping::~MemfdMapping() noexcept {
+    if (data_) {
+        munmap(data_, size_);
+    }
+}
+
+MemfdWriter::MemfdWriter()
+    : fd_(memfd_create("yabridge-buffer", MFD_CLOEXEC | MFD_ALLOW_SEALING)) {
+    if (fd_ == -1) {
+        throw std::system_error(errno, std::system_category(),
+                                "Could not create memfd");
+    }
+}
+
+MemfdWriter::~MemfdWriter() noexcept {
+    if (data_) {
+        munmap(data_, capacity_);
+    }
+    close(fd_);
+}
+
+void MemfdWriter::resize(size_t size) {
+    if (size <= capacity_) {
+        size_ = size;
+        return;
+    }
+
+    // The file and the mapping are grown together in large steps. Growing the
+    // mapping may move it, but that doesn't copy the underlying pages.
+    const size_t new_capacity =
+        ((size + memfd_writer_chunk_size - 1) / memfd_writer_chunk_size) *
+        memfd_writer_chunk_size;
+    if (ftruncate(fd_, static_cast<off_t>(new_capacity)) == -1) {
+        throw std::system_error(errno, std::system_category(),
+                                "Could not resize memfd");
+    }
+
+    void* mapping =
+        data_ ? mremap(data_, capacity_, new_capacity, MREMAP_MAYMOVE)
+              : mmap(nullptr, new_capacity, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fd_, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::system_error(errno, std::system_category(),
+                                "Could not map memfd");
+    }
+
+    data_ = static_cast<uint8_t*>(mapping);
+    capacity_ = new_capacity;
+    size_ = size;
+}
+
+int MemfdWriter::seal() {
+    if (!sealed_) {
+        // The write seal can't be added while there are still writable shared
+        // mappings, so we'll unmap the buffer first and then map it again as
+        // read-only
+        if (data_) {
+            munmap(data_, capacity_);
+            data_ = nullptr;
+        }
+        capacity_ = 0;
+
+        if (ftruncate(fd_, static_cast<off_t>(size_)) == -1 ||
+            fcntl(fd_, F_ADD_SEALS,
+                  F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) ==
+                -1) {
+            throw std::system_error(errno, std::system_category(),
+                                    "Could not seal memfd");
+        }
+        sealed_ = true;
+
+        if (size_ > 0) {
+            void* mapping =
+                mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+            if (mapping == MAP_FAILED) {
+                throw std::system_error(errno, std::system_category(),
+                                        "Could not map memfd");
+            }
+
+            data_ = static_cast<uint8_t*>(mapping);
+            capacity_ = size_;
+        }
+    }
+
+    const int fd = dup(fd_);
+    if (fd == -1) {
+        throw std::system_error(errno, std::system_category(),
+                                "Could not duplicate memfd");
+    }
+
+    return fd;
+}
+
+BinaryBuffer::BinaryBuffer() noexcept {}
+
+BinaryBuffer::BinaryBuffer(std::vector<uint8_t> data) noexcept
+    : owned_(std::move(data)) {}
+
+BinaryBuffer BinaryBuffer::borrow(const uint8_t* data, size_t size) noexcept {
+    BinaryBuffer buffer;
+    buffer.borrowed_data_ = data;
+    buffer.borrowed_size_ = size;
+
+    return buffer;
+}
+
+const uint8_t* BinaryBuffer::data() const noexcept {
+    if (memfd_writer_) {
+        return memfd_writer_->data();
+    } else if (mapping_) {
+        return mapping_->data();
+    } else if (borrowed_data_) {
+        return borrowed_data_;
+    } else {
+        return owned_.data();
+    }
+}
+
+size_t BinaryBuffer::size() const noexcept {
+    if (memfd_writer_) {
+        return memfd_writer_->size();
+    } else if (mapping_) {
+        return mapping_->size();
+    } else if (borrowed_data_) {
+        return borrowed_size_;
+    } else {
+        return owned_.size();
+    }
+}
+
+void BinaryBuffer::set_mapping(
+    std::shared_ptr<const MemfdMapping> mapping) noexcept {
+    owned_.clear();
+    borrowed_data_ = nullptr;
+    borrowed_size_ = 0;
+    memfd_writer_.reset();
+    mapping_ = std::move(mapping);
+}
+
+std::vector<uint8_t>& BinaryBuffer::reset_to_owned() noexcept {
+    borrowed_data_ = nullptr;
+    borrowed_size_ = 0;
+    mapping_.reset();
+    memfd_writer_.reset();
+
+    return owned_;
+}
+
+uint8_t* BinaryBuffer::resize(size_t size) {
+    // Mappings, borrowed data, and writers we can't write to are copied first.
+    // Small buffers are kept in the vector.
+    const bool writable_writer = memfd_writer_ && !memfd_writer_->sealed() &&
+                                 memfd_writer_.use_count() == 1;
+    if (mapping_ || borrowed_data_ || (memfd_writer_ && !writable_writer)) {
+        const uint8_t* old_data = data();
+        const size_t old_size = this->size();
+        const size_t copied_size = std::min(old_size, size);
+        if (size >= memfd_transfer_threshold) {
+            auto writer = std::make_shared<MemfdWriter>();
+            writer->resize(size);
+            std::copy_n(old_data, copied_size, writer->data());
+
+            reset_to_owned().clear();
+            memfd_writer_ = std::move(writer);
+        } else {
+            std::vector<uint8_t> copy(old_data, old_data + copied_size);
+            copy.resize(size);
+
+            reset_to_owned() = std::move(copy);
+        }
+    } else if (memfd_writer_) {
+        memfd_writer_->resize(size);
+    } else if (size >= memfd_transfer_threshold) {
+        auto writer = std::make_shared<MemfdWriter>();
+        writer->resize(size);
+        std::copy_n(owned_.data(), std::min(owned_.size(), size),
+                    writer->data());
+
+        owned_.clear();
+        owned_.shrink_to_fit();
+        memfd_writer_ = std::move(writer);
+    } else {
+        owned_.resize(size);
+    }
+
+    return memfd_writer_ ? memfd_writer_->data() : owned_.data();
+}
+
+std::optional<int> BinaryBuffer::seal_memfd() const {
+    if (memfd_writer_) {
+        return memfd_writer_->seal();
+    } else {
+        return std::nullopt;
+    }
+}
+
+OutgoingFds::OutgoingFds() noexcept : previous_(current_outgoing_fds) {
+    current_outgoing_fds = this;
+}
+
+OutgoingFds::~OutgoingFds() noexcept {
+    current_outgoing_fds = previous_;
+    for (const int fd : fds_) {
+        close(fd);
+    }
+}
+
+OutgoingFds* OutgoingFds::current() noexcept {
+    return current_outgoing_fds;
+}
+
+uint32_t OutgoingFds::attach(int fd) {
+    if (fds_.size() >= max_attached_fds) {
+        close(fd);
+        throw std::system_error(
+            std::make_error_code(std::errc::too_many_files_open),
+            "Too many file descriptors attached to a single message");
+    }
+
+    fds_.push_back(fd);
+
+    return static_cast<uint32_t>(fds_.size() - 1);
+}
+
+IncomingFds::IncomingFds() noexcept : previous_(current_incoming_fds) {
+    current_incoming_fds = this;
+}
+
+IncomingFds::~IncomingFds() noexcept {
+    current_incoming_fds = previous_;
+    for (const int fd : fds_) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+}
+
+IncomingFds* IncomingFds::current() noexcept {
+    return current_incoming_fds;
+}
+
+std::optional<int> IncomingFds::take(uint32_t index) noexcept {
+    if (index >= fds_.size() || fds_[index] == -1) {
+        return std::nullopt;
+    }
+
+    const int fd = fds_[index];
+    fds_[index] = -1;
+
+    return fd;
+}
+
+void send_message_header(int socket_fd, uint64_t size, const OutgoingFds& fds) {
+    uint64_t header = size | (static_cast<uint64_t>(fds.fds_.size())
+                              << message_header_fd_count_shift);
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * max_attached_fds)];
+    std::memset(control, 0, sizeof(control));
+
+    // The ancillary data is only sent along with the first `sendmsg()` call.
+    // The kernel will attach it to the first byte of the header.
+    size_t bytes_written = 0;
+    while (bytes_written < sizeof(header)) {
+        iovec io{.iov_base = reinterpret_cast<char*>(&header) + bytes_written,
+                 .iov_len = sizeof(header) - bytes_written};
+        msghdr message{};
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        if (bytes_written == 0 && !fds.fds_.empty()) {
+            const size_t fds_size = sizeof(int) * fds.fds_.size();
+            message.msg_control = control;
+            message.msg_controllen = CMSG_SPACE(fds_size);
+
+            cmsghdr* control_message = CMSG_FIRSTHDR(&message);
+            control_message->cmsg_level = SOL_SOCKET;
+            control_message->cmsg_type = SCM_RIGHTS;
+            control_message->cmsg_len = CMSG_LEN(fds_size);
+            std::memcpy(CMSG_DATA(control_message), fds.fds_.data(), fds_size);
+        }
+
+        const ssize_t result = sendmsg(socket_fd, &message, MSG_NOSIGNAL);
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                wait_for_socket(socket_fd, POLLOUT);
+                continue;
+            }
+
+            throw std::system_error(errno, std::system_category());
+        }
+
+        bytes_written += static_cast<size_t>(result);
+    }
+}
+
+uint64_t receive_message_header(int socket_fd, IncomingFds& fds) {
+    uint64_t header = 0;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * max_attached_fds)];
+
+    size_t bytes_read = 0;
+    while (bytes_read < sizeof(header)) {
+        iovec io{.iov_base = reinterpret_cast<char*>(&header) + bytes_read,
+                 .iov_len = sizeof(header) - bytes_read};
+        msghdr message{};
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        const ssize_t result =
+            recvmsg(socket_fd, &message, MSG_CMSG_CLOEXEC);
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                wait_for_socket(socket_fd, POLLIN);
+                continue;
+            }
+
+            throw std::system_error(errno, std::system_category());
+        } else if (result == 0) {
+            // The other side has closed the socket. This is what Asio would
+            // also throw.
+            throw std::system_error(
+                std::make_error_code(std::errc::connection_reset));
+        }
+
+        for (cmsghdr* control_message = CMSG_FIRSTHDR(&message);
+             control_message;
+             control_message = CMSG_NXTHDR(&message, control_message)) {
+            if (control_message->cmsg_level == SOL_SOCKET &&
+                control_message->cmsg_type == SCM_RIGHTS) {
+                const size_t num_fds =
+                    (control_message->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                const size_t offset = fds.fds_.size();
+                fds.fds_.resize(offset + num_fds);
+                std::memcpy(fds.fds_.data() + offset,
+                            CMSG_DATA(control_message), num_fds * sizeof(int));
+            }
+        }
+
+        if (message.msg_flags & MSG_CTRUNC) {
+            throw std::system_error(
+                std::make_error_code(std::errc::message_size),
+                "Too many file descriptors attached to message");
+        }
+
+        bytes_read += static_cast<size_t>(result);
+    }
+
+    const uint64_t num_fds = header >> message_header_fd_count_shift;
+    if (num_fds != fds.fds_.size()) {
+        throw std::system_error(std::make_error_code(std::errc::protocol_error),
+                                "Received an unexpected number of file "
+                                "descriptors");
+    }
+
+    return header & ((uint64_t(1) << message_header_fd_count_shift) - 1);
+}
@@ -0,0 +1,359 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+/**
+ * Binary blobs (plugin state, mostly) at least this large will be sent to the
+ * other side as a sealed memfd file descriptor instead of being copied through
+ * the socket. Smaller blobs are still serialized inline since setting up a
+ * mapping is not free either.
+ */
+constexpr size_t memfd_transfer_threshold = 1 << 20;
+
+/**
+ * `MemfdWriter` grows its file and its mapping in multiples of this size, so
+ * writing a large buffer a few bytes at a time doesn't result in a system call
+ * for every write.
+ */
+constexpr size_t memfd_writer_chunk_size = 8 << 20;
+
+/**
+ * Create an anonymous memfd file containing a copy of `data`, and seal it so
+ * the contents can no longer be modified or resized by anyone. The receiving
+ * side can then safely map the file without having to worry about the sender
+ * modifying it behind its back.
+ *
+ * @param data The data to write to the file.
+ * @param size The number of bytes in `data`.
+ *
+ * @return The file descriptor for the memfd. The caller takes ownership.
+ *
+ * @throw std::system_error If the file could not be created or written to.
+ */
+int create_sealed_memfd(const uint8_t* data, size_t size);
+
+/**
+ * An RAII wrapper around a copy-on-write mapping of a sealed memfd received
+ * from the other side. The underlying file can't be modified anymore, so the
+ * mapping is effectively read-only. We still map it with `PROT_WRITE` (using a
+ * private mapping, so writes never reach the file) because the VST2 API passes
+ * chunks as non-const pointers and some plugins may use that buffer as scratch
+ * space.
+ */
+class MemfdMapping {
+   public:
+    /**
+     * Map a memfd file descriptor. This takes ownership of the file descriptor,
+     * which will be closed after it has been mapped (or if mapping it failed).
+     *
+     * @param fd The file descriptor for a memfd created with
+     *   `create_sealed_memfd()`.
+     * @param size The expected size of the file. We'll check this against the
+     *   file's actual size.
+     *
+     * @throw std::system_error If the file could not be mapped.
+     */
+    MemfdMapping(int fd, size_t size);
+
+    ~MemfdMapping() noexcept;
+
+    MemfdMapping(const MemfdMapping&) = delete;
+    MemfdMapping& operator=(const MemfdMapping&) = delete;
+    MemfdMapping(MemfdMapping&&) = delete;
+    MemfdMapping& operator=(MemfdMapping&&) = delete;
+
+    inline uint8_t* data() const noexcept { return data_; }
+    inline size_t size() const noexcept { return size_; }
+
+   private:
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * A memfd that can be written to directly through a shared mapping. This is
+ * used for large buffers that are being written to on this side and that will
+ * then be sent to the other side, like the state a VST3 plugin writes to an
+ * `IBStream`. The data ends up in shared memory as it's being written instead
+ * of first being collected in a vector and then being copied to a memfd during
+ * serialization, and the file grows in `memfd_writer_chunk_size` increments
+ * instead of the data being reallocated and copied every time the buffer runs
+ * out of capacity.
+ *
+ * Before the file descriptor can be sent to the other side, the memfd needs to
+ * be sealed with `seal()`. After that the contents can still be read, but the
+ * buffer can no longer be changed.
+ */
+class MemfdWriter {
+   public:
+    /**
+     * Create an empty memfd.
+     *
+     * @throw std::system_error If the memfd could not be created.
+     */
+    MemfdWriter();
+
+    ~MemfdWriter() noexcept;
+
+    MemfdWriter(const MemfdWriter&) = delete;
+    MemfdWriter& operator=(const MemfdWriter&) = delete;
+    MemfdWriter(MemfdWriter&&) = delete;
+    MemfdWriter& operator=(MemfdWriter&&) = delete;
+
+    /**
+     * A pointer to the buffer's contents. This can only be written to until
+     * the buffer has been sealed.
+     */
+    inline uint8_t* data() const noexcept { return data_; }
+    inline size_t size() const noexcept { return size_; }
+    inline bool sealed() const noexcept { return sealed_; }
+
+    /**
+     * Change the size of the buffer, keeping its contents. Growing the buffer
+     * may move the mapping, which invalidates any earlier `data()` pointers.
+     * This may not be called after the buffer has been sealed.
+     *
+     * @throw std::system_error If the file or the mapping could not be resized.
+     */
+    void resize(size_t size);
+
+    /**
+     * Shrink the file to `size()` and seal it the same way
+     * `create_sealed_memfd()` does. The contents remain readable through
+     * `data()`. Calling this again after the buffer has been sealed is
+     * allowed.
+     *
+     * @return A new file descriptor for the memfd that can be sent to the
+     *   other side. The caller takes ownership.
+     *
+     * @throw std::system_error If the memfd could not be sealed.
+     */
+    int seal();
+
+   private:
+    int fd_ = -1;
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    /**
+     * The size of the file and the mapping. Always a multiple of
+     * `memfd_writer_chunk_size`, or the exact size after sealing.
+     */
+    size_t capacity_ = 0;
+    bool sealed_ = false;
+};
+
+/**
+ * A binary buffer for large opaque blobs like VST2 chunks that avoids copies
+ * wherever possible. This can hold one of three things:
+ *
+ * - An owned `std::vector<uint8_t>`. This is what we'll get when a small buffer
+ *   was serialized inline.
+ * - A borrowed pointer to data owned by the host or the plugin. This is only
+ *   used for sending, and the data has to outlive the message.
+ * - A `MemfdMapping` for large buffers received through a memfd. This lets us
+ *   hand the mapped memory to the plugin or the host directly.
+ *
+ * When the buffer gets written to through `resize()` and it grows beyond
+ * `memfd_transfer_threshold`, the contents are moved to a `MemfdWriter`
+ * instead. Those buffers can then be sent to the other side without copying
+ * the data again.
+ *
+ * This uses the `bitsery::ext::LargeBinary` extension for serialization.
+ */
+class BinaryBuffer {
+   public:
+    BinaryBuffer() noexcept;
+
+    /**
+     * Take ownership of an existing vector.
+     */
+    BinaryBuffer(std::vector<uint8_t> data) noexcept;
+
+    /**
+     * Create a buffer that points to data owned by someone else. The data
+     * needs to stay alive for as long as this object does, so this should only
+     * be used for sending data to the other side.
+     */
+    static BinaryBuffer borrow(const uint8_t* data, size_t size) noexcept;
+
+    const uint8_t* data() const noexcept;
+    size_t size() const noexcept;
+
+    /**
+     * Replace the contents of this buffer with a mapping received from the
+     * other side.
+     */
+    void set_mapping(std::shared_ptr<const MemfdMapping> mapping) noexcept;
+
+    /**
+     * Drop any mapping or borrowed data and return a reference to the owned
+     * vector so it can be deserialized into. This keeps the vector's capacity
+     * intact.
+     */
+    std::vector<uint8_t>& reset_to_owned() noexcept;
+
+    /**
+     * Resize the buffer while keeping its contents, and return a pointer to
+     * the contents that can be written to. If the buffer currently holds a
+     * mapping or borrowed data, then that data will be copied first. Once the
+     * buffer reaches `memfd_transfer_threshold` bytes the contents will be
+     * moved to a `MemfdWriter`. Resizing may invalidate earlier pointers.
+     *
+     * @throw std::system_error If a memfd could not be created or resized.
+     */
+    uint8_t* resize(size_t size);
+
+    /**
+     * If the contents are stored in a `MemfdWriter`, then seal it and return a
+     * file descriptor for it that can be sent to the other side. The caller
+     * takes ownership. Returns a nullopt for all other buffers.
+     *
+     * @throw std::system_error If the memfd could not be sealed.
+     */
+    std::optional<int> seal_memfd() const;
+
+   private:
+    std::vector<uint8_t> owned_;
+    const uint8_t* borrowed_data_ = nullptr;
+    size_t borrowed_size_ = 0;
+    /**
+     * This is a shared pointer so the buffer stays copyable, since it will be
+     * stored in variants that may get copied.
+     */
+    std::shared_ptr<const MemfdMapping> mapping_;
+    /**
+     * Also a shared pointer for the same reason. `resize()` will make a copy
+     * before writing if the writer is shared with another buffer, or if it has
+     * already been sealed.
+     */
+    std::shared_ptr<MemfdWriter> memfd_writer_;
+};
+
+/**
+ * While an object of this type is alive, serialization on the current thread
+ * may attach file descriptors to the message being serialized. `write_object()`
+ * sets this up so `bitsery::ext::LargeBinary` can send large buffers as memfds.
+ * Any file descriptors that are still attached when this object gets destroyed
+ * will be closed, since they'll have been duplicated into the receiving process
+ * by then.
+ */
+class OutgoingFds {
+   public:
+    OutgoingFds() noexcept;
+    ~OutgoingFds() noexcept;
+
+    OutgoingFds(const OutgoingFds&) = delete;
+    OutgoingFds& operator=(const OutgoingFds&) = delete;
+
+    /**
+     * The scope active on this thread, or a null pointer if the current
+     * (de)serialization is not happening as part of `write_object()`. In that
+     * case all data should be serialized inline.
+     */
+    static OutgoingFds* current() noexcept;
+
+    /**
+     * Attach a file descriptor to the message. This object takes ownership of
+     * the file descriptor.
+     *
+     * @return The index of the file descriptor in the message. The receiving
+     *   side can retrieve the file descriptor using `IncomingFds::take()`.
+     */
+    uint32_t attach(int fd);
+
+    /**
+     * Whether any file descriptors have been attached to the message.
+     */
+    inline bool empty() const noexcept { return fds_.empty(); }
+
+   private:
+    std::vector<int> fds_;
+    OutgoingFds* previous_;
+
+    friend void send_message_header(int socket_fd,
+                                    uint64_t size,
+                                    const OutgoingFds& fds);
+};
+
+/**
+ * The receiving side counterpart to `OutgoingFds`, set up by `read_object()`.
+ * File descriptors that have not been taken during deserialization will be
+ * closed when this object gets destroyed.
+ */
+class IncomingFds {
+   public:
+    IncomingFds() noexcept;
+    ~IncomingFds() noexcept;
+
+    IncomingFds(const IncomingFds&) = delete;
+    IncomingFds& operator=(const IncomingFds&) = delete;
+
+    /**
+     * @see OutgoingFds::current
+     */
+    static IncomingFds* current() noexcept;
+
+    /**
+     * Take ownership of the file descriptor at index `index`. Returns a
+     * nullopt if the index is not valid or if the file descriptor has already
+     * been taken.
+     */
+    std::optional<int> take(uint32_t index) noexcept;
+
+   private:
+    std::vector<int> fds_;
+    IncomingFds* previous_;
+
+    friend uint64_t receive_message_header(int socket_fd, IncomingFds& fds);
+};
+
+/**
+ * The number of bits in the 64-bit size header `write_object()` sends before
+ * every message that are used to encode the number of attached file
+ * descriptors. These are the most significant bits. No message will ever come
+ * close to being 2^56 bytes large.
+ */
+constexpr unsigned int message_header_fd_count_shift = 56;
+
+/**
+ * Write the 64-bit message header to a Unix domain socket, attaching the
+ * file descriptors in `fds` as `SCM_RIGHTS` ancillary data. The file descriptor
+ * count will be encoded in the header.
+ *
+ * @throw std::system_error If the socket got closed.
+ */
+void send_message_header(int socket_fd, uint64_t size, const OutgoingFds& fds);
+
+/**
+ * Read a 64-bit message header written by either `send_message_header()` or by
+ * a regular `asio::write()`, receiving any file descriptors sent along with it
+ * into `fds`. This also works for sockets Asio has put in non-blocking mode.
+ *
+ * @return The message header without the file descriptor count bits. This is
+ *   the size of the message's payload, possibly combined with
+ *   `message_header_compressed_flag`.
+ *
+ * @throw std::system_error If the socket got closed, or if the number of file
+ *   descriptors we received did not match the count encoded in the header.
+ */
+uint64_t receive_message_header(int socket_fd, IncomingFds& fds);
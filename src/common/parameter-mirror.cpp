@@ -0,0 +1,230 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "parameter-mirror.h"
+
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * How many times `ParameterMirror::read()` retries when the table is being
+ * written to before giving up. Writing a value or a batch of values to the
+ * table only takes a couple of nanoseconds, so this should practically never
+ * be reached.
+ */
+constexpr int max_read_attempts = 64;
+
+/**
+ * Whether the current thread is inside of `ParameterMirror::refresh()`.
+ */
+thread_local bool is_refreshing_parameter_mirror = false;
+
+ParameterMirror ParameterMirror::create(const std::string& name,
+                                        uint32_t num_parameters) {
+    const int shm_fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+    if (shm_fd == -1) {
+        throw std::system_error(std::error_code(errno, std::system_category()),
+                                "Could not create shared memory object " +
+                                    name);
+    }
+
+    const size_t shm_size =
+        sizeof(Header) + (static_cast<size_t>(num_parameters) * sizeof(float));
+    if (ftruncate(shm_fd, static_cast<off_t>(shm_size)) != 0) {
+        const int error = errno;
+        close(shm_fd);
+        shm_unlink(name.c_str());
+
+        throw std::system_error(std::error_code(error, std::system_category()),
+                                "Could not resize shared memory object " +
+                                    name);
+    }
+
+    void* shm_bytes = mmap(nullptr, shm_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, shm_fd, 0);
+    if (shm_bytes == MAP_FAILED) {
+        const int error = errno;
+        close(shm_fd);
+        shm_unlink(name.c_str());
+
+        throw std::system_error(std::error_code(error, std::system_category()),
+                                "Could not map shared memory");
+    }
+
+    // `ftruncate()` zero fills the object, so the table starts out unpopulated
+    auto* header = static_cast<Header*>(shm_bytes);
+    header->num_parameters = num_parameters;
+
+    return ParameterMirror(name, shm_fd, static_cast<uint8_t*>(shm_bytes),
+                           shm_size);
+}
+
+ParameterMirror ParameterMirror::open(const std::string& name) {
+    const int shm_fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (shm_fd == -1) {
+        throw std::system_error(std::error_code(errno, std::system_category()),
+                                "Could not open shared memory object " + name);
+    }
+
+    struct stat shm_stat {};
+    if (fstat(shm_fd, &shm_stat) != 0 ||
+        static_cast<size_t>(shm_stat.st_size) < sizeof(Header)) {
+        close(shm_fd);
+        throw std::runtime_error("Shared memory object " + name +
+                                 " is too small");
+    }
+
+    const auto shm_size = static_cast<size_t>(shm_stat.st_size);
+    void* shm_bytes = mmap(nullptr, shm_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, shm_fd, 0);
+    if (shm_bytes == MAP_FAILED) {
+        const int error = errno;
+        close(shm_fd);
+
+        throw std::system_error(std::error_code(error, std::system_category()),
+                                "Could not map shared memory");
+    }
+
+    // The parameter count is written once by the Wine plugin host before it
+    // sends anything to the native plugin, but we'll still verify that it
+    // fits within the object
+    const auto* header = static_cast<const Header*>(shm_bytes);
+    if (sizeof(Header) + (static_cast<size_t>(header->num_parameters) *
+                          sizeof(float)) >
+        shm_size) {
+        munmap(shm_bytes, shm_size);
+        close(shm_fd);
+
+        throw std::runtime_error("Shared memory object " + name +
+                                 " is too small");
+    }
+
+    return ParameterMirror(name, shm_fd, static_cast<uint8_t*>(shm_bytes),
+                           shm_size);
+}
+
+ParameterMirror::ParameterMirror(std::string name,
+                                 int shm_fd,
+                                 uint8_t* shm_bytes,
+                                 size_t shm_size) noexcept
+    : name_(std::move(name)),
+      shm_fd_(shm_fd),
+      shm_bytes_(shm_bytes),
+      shm_size_(shm_size),
+      header_(reinterpret_cast<Header*>(shm_bytes)),
+      values_(reinterpret_cast<float*>(shm_bytes + sizeof(Header))),
+      num_parameters_(header_->num_parameters) {}
+
+ParameterMirror::~ParameterMirror() noexcept {
+    if (!is_moved_) {
+        munmap(shm_bytes_, shm_size_);
+        close(shm_fd_);
+        shm_unlink(name_.c_str());
+    }
+}
+
+ParameterMirror::ParameterMirror(ParameterMirror&& o) noexcept
+    : name_(std::move(o.name_)),
+      shm_fd_(o.shm_fd_),
+      shm_bytes_(o.shm_bytes_),
+      shm_size_(o.shm_size_),
+      header_(o.header_),
+      values_(o.values_),
+      num_parameters_(o.num_parameters_) {
+    o.is_moved_ = true;
+}
+
+std::optional<float> ParameterMirror::read(int index) const noexcept {
+    if (index < 0 || static_cast<uint32_t>(index) >= num_parameters_ ||
+        !populated()) {
+        return std::nullopt;
+    }
+
+    for (int attempt = 0; attempt < max_read_attempts; attempt++) {
+        const uint32_t sequence_before = std::atomic_ref(header_->sequence)
+                                             .load(std::memory_order_acquire);
+        if (sequence_before & 1) {
+            continue;
+        }
+
+        const float value =
+            std::atomic_ref(values_[index]).load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint32_t sequence_after = std::atomic_ref(header_->sequence)
+                                            .load(std::memory_order_relaxed);
+        if (sequence_before == sequence_after) {
+            return value;
+        }
+    }
+
+    return std::nullopt;
+}
+
+bool ParameterMirror::write(int index, float value, bool blocking) noexcept {
+    if (index < 0 || static_cast<uint32_t>(index) >= num_parameters_) {
+        return true;
+    }
+
+    std::unique_lock lock(write_mutex_, std::defer_lock);
+    if (blocking) {
+        lock.lock();
+    } else if (!lock.try_lock()) {
+        return false;
+    }
+
+    begin_write();
+    std::atomic_ref(values_[index]).store(value, std::memory_order_relaxed);
+    end_write();
+
+    return true;
+}
+
+bool ParameterMirror::populated() const noexcept {
+    return std::atomic_ref(header_->populated)
+               .load(std::memory_order_acquire) != 0;
+}
+
+void ParameterMirror::begin_write() noexcept {
+    std::atomic_ref sequence(header_->sequence);
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void ParameterMirror::end_write() noexcept {
+    std::atomic_ref sequence(header_->sequence);
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_release);
+}
+
+bool ParameterMirror::begin_refresh() noexcept {
+    if (is_refreshing_parameter_mirror) {
+        return false;
+    }
+
+    is_refreshing_parameter_mirror = true;
+    return true;
+}
+
+void ParameterMirror::end_refresh() noexcept {
+    is_refreshing_parameter_mirror = false;
+}
@@ -0,0 +1,242 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "utils.h"
+
+/**
+ * The number of parameters `ParameterMirror::refresh()` writes to the table at
+ * once. Readers only have to retry while a batch is being written, so this
+ * keeps that window short even for plugins with thousands of parameters.
+ */
+constexpr uint32_t parameter_mirror_refresh_batch_size = 32;
+
+/**
+ * A table of a VST2 plugin's current parameter values in shared memory, so
+ * `getParameter()` can be answered on the native plugin side without a round
+ * trip to the Wine plugin host. Hosts like REAPER and Bitwig poll every
+ * parameter to draw automation lanes and generic editors, which for plugins
+ * with thousands of parameters would otherwise result in thousands of socket
+ * round trips per second.
+ *
+ * The Wine plugin host creates this table right after loading the plugin, and
+ * writes to it after `effOpen()`, after `setParameter()`, after loading a
+ * preset, and when the plugin reports parameter changes through
+ * `audioMasterAutomate()` or `audioMasterUpdateDisplay()`. The native plugin
+ * only reads from it. Writes are protected by a seqlock: the writer increments
+ * a sequence number before and after writing, and readers retry if the
+ * sequence number was odd or if it changed while reading. That way readers
+ * never block, and they never have to take a lock that the Wine plugin host may
+ * be holding. Refreshing the entire table is done in batches of
+ * `parameter_mirror_refresh_batch_size` values, and the sequence number is
+ * only odd while a batch is being copied into the table.
+ *
+ * Until the Wine plugin host has written the entire table for the first time,
+ * and for parameter indices outside of the table (the plugin may increase its
+ * parameter count after `effOpen()`), `read()` returns a nullopt and the
+ * caller should fall back to asking the plugin directly.
+ */
+class ParameterMirror {
+   public:
+    /**
+     * Create a new table for `num_parameters` parameters. This should be done
+     * on the Wine plugin host side.
+     *
+     * @param name The name of the shared memory object. The backing file will
+     *   be created in `/dev/shm` by the operating system.
+     * @param num_parameters The number of parameters the plugin reports.
+     *
+     * @throw std::system_error If the shared memory object could not be
+     *   created or mapped.
+     */
+    static ParameterMirror create(const std::string& name,
+                                  uint32_t num_parameters);
+
+    /**
+     * Connect to a table created by the Wine plugin host. This should be done
+     * on the native plugin side.
+     *
+     * @throw std::system_error If the shared memory object does not exist or
+     *   could not be mapped.
+     * @throw std::runtime_error If the shared memory object is too small.
+     */
+    static ParameterMirror open(const std::string& name);
+
+    /**
+     * Unmap the table. Like `AudioShmBuffer`, either side dropping the object
+     * will unlink the shared memory object to avoid leaking memory when a
+     * plugin or the host crashes.
+     */
+    ~ParameterMirror() noexcept;
+
+    ParameterMirror(const ParameterMirror&) = delete;
+    ParameterMirror& operator=(const ParameterMirror&) = delete;
+
+    ParameterMirror(ParameterMirror&&) noexcept;
+    ParameterMirror& operator=(ParameterMirror&&) = delete;
+
+    /**
+     * Read a parameter's value. Returns a nullopt if the table hasn't been
+     * populated yet, if the index is out of bounds, or if the table kept
+     * getting written to while we were reading from it. This never blocks.
+     */
+    std::optional<float> read(int index) const noexcept;
+
+    /**
+     * Update a single parameter's value. Does nothing if the index is out of
+     * bounds.
+     *
+     * @param blocking If this is `false`, then the write is skipped when
+     *   another thread is currently writing to the table. Used on the audio
+     *   thread, where the caller should schedule a refresh instead.
+     *
+     * @return Whether the value was written. Writes to out of bounds indices
+     *   count as written.
+     */
+    bool write(int index, float value, bool blocking = true) noexcept;
+
+    /**
+     * Read all parameters using `get_value` and write them to the table. This
+     * will also mark the table as populated so the native plugin can start
+     * using it. The values are read and written in batches, and other writers
+     * are only held back while a batch is being read. This should not be
+     * called from the audio thread since it calls `get_value` for every
+     * parameter.
+     *
+     * @param get_value A function that returns the plugin's current value for
+     *   a parameter index.
+     *
+     * @return Whether the table was refreshed. This is `false` when called
+     *   while already refreshing the table, e.g. when a plugin calls
+     *   `audioMasterUpdateDisplay()` from its `getParameter()` function.
+     */
+    template <invocable_returning<float, int> F>
+    bool refresh(F&& get_value) noexcept {
+        if (!begin_refresh()) {
+            return false;
+        }
+
+        std::array<float, parameter_mirror_refresh_batch_size> batch;
+        for (uint32_t start = 0; start < num_parameters_;
+             start += parameter_mirror_refresh_batch_size) {
+            const uint32_t end = std::min(
+                start + parameter_mirror_refresh_batch_size, num_parameters_);
+
+            // The lock is held while reading the values so a value written by
+            // another thread in the meantime can't be overwritten by an older
+            // one. The plugin may call `audioMasterAutomate()` from
+            // `getParameter()`, which is why this mutex is recursive.
+            std::lock_guard lock(write_mutex_);
+            for (uint32_t i = start; i < end; i++) {
+                batch[i - start] = get_value(static_cast<int>(i));
+            }
+
+            begin_write();
+            for (uint32_t i = start; i < end; i++) {
+                std::atomic_ref(values_[i])
+                    .store(batch[i - start], std::memory_order_relaxed);
+            }
+            end_write();
+        }
+        end_refresh();
+
+        std::atomic_ref(header_->populated)
+            .store(1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * Whether the Wine plugin host has called `refresh()` at least once.
+     */
+    bool populated() const noexcept;
+
+    /**
+     * The number of parameters in the table.
+     */
+    inline uint32_t size() const noexcept { return num_parameters_; }
+
+   private:
+    /**
+     * The layout of the start of the shared memory object. The parameter
+     * values follow directly after this header.
+     */
+    struct Header {
+        /**
+         * The seqlock's sequence number. Odd while the table is being written
+         * to.
+         */
+        uint32_t sequence;
+        uint32_t num_parameters;
+        /**
+         * Set to 1 after the table has been populated for the first time.
+         */
+        uint32_t populated;
+        uint32_t reserved;
+    };
+
+    ParameterMirror(std::string name,
+                    int shm_fd,
+                    uint8_t* shm_bytes,
+                    size_t shm_size) noexcept;
+
+    /**
+     * Increment the sequence number before and after writing to the table.
+     * Must be called while holding `write_mutex_`, and the plugin must not be
+     * called in between.
+     */
+    void begin_write() noexcept;
+    void end_write() noexcept;
+
+    /**
+     * Mark the calling thread as refreshing a table. Returns `false` if it
+     * already is, in which case `refresh()` was called recursively from
+     * `get_value` and it should not do anything. Other threads can still
+     * refresh or write to the table at the same time, since every batch is
+     * read and written while holding `write_mutex_`.
+     */
+    static bool begin_refresh() noexcept;
+    static void end_refresh() noexcept;
+
+    std::string name_;
+    int shm_fd_;
+    uint8_t* shm_bytes_;
+    size_t shm_size_;
+
+    Header* header_;
+    float* values_;
+    uint32_t num_parameters_;
+
+    /**
+     * Serializes writers within this process. The seqlock only supports a
+     * single writer at a time. This is recursive because the plugin may call
+     * `audioMasterAutomate()` from within `getParameter()` while we're
+     * refreshing the table.
+     */
+    std::recursive_mutex write_mutex_;
+
+    bool is_moved_ = false;
+};
@@ -0,0 +1,193 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "process-watchdog.h"
+
+#include <vector>
+
+#include <asio/post.hpp>
+
+#include "process.h"
+
+ProcessWatchdog::Guard::Guard(ProcessWatchdog& watchdog, size_t id) noexcept
+    : watchdog_(&watchdog), id_(id) {}
+
+ProcessWatchdog::Guard::~Guard() noexcept {
+    if (watchdog_) {
+        watchdog_->remove(id_);
+    }
+}
+
+ProcessWatchdog::Guard::Guard(Guard&& o) noexcept
+    : watchdog_(o.watchdog_), id_(o.id_) {
+    o.watchdog_ = nullptr;
+}
+
+ProcessWatchdog::Guard& ProcessWatchdog::Guard::operator=(Guard&& o) noexcept {
+    if (this != &o) {
+        if (watchdog_) {
+            watchdog_->remove(id_);
+        }
+
+        watchdog_ = o.watchdog_;
+        id_ = o.id_;
+        o.watchdog_ = nullptr;
+    }
+
+    return *this;
+}
+
+ProcessWatchdog::ProcessWatchdog(
+    asio::io_context& io_context,
+    std::chrono::steady_clock::duration poll_interval)
+    : io_context_(io_context),
+      poll_interval_(poll_interval),
+      poll_timer_(io_context) {}
+
+ProcessWatchdog::~ProcessWatchdog() noexcept {
+    // All guards should have been dropped by now, but the descriptors need to
+    // be closed before the IO context gets destroyed
+    std::lock_guard lock(watches_mutex_);
+    watches_.clear();
+}
+
+ProcessWatchdog::Guard ProcessWatchdog::watch(pid_t pid, Callback on_exit) {
+    auto watch = std::make_shared<Watch>();
+    watch->on_exit = std::move(on_exit);
+    if (const std::optional<int> pidfd = open_pidfd(pid)) {
+        watch->pidfd.emplace(io_context_, *pidfd);
+    } else {
+        // Either the kernel doesn't support pidfds, or the process has already
+        // exited. In both cases the poll will take care of it.
+        watch->is_running = [pid]() { return pid_running(pid); };
+    }
+
+    return add(std::move(watch));
+}
+
+ProcessWatchdog::Guard ProcessWatchdog::watch(
+    std::function<bool()> is_running,
+    Callback on_exit) {
+    auto watch = std::make_shared<Watch>();
+    watch->on_exit = std::move(on_exit);
+    watch->is_running = std::move(is_running);
+
+    return add(std::move(watch));
+}
+
+ProcessWatchdog::Guard ProcessWatchdog::add(std::shared_ptr<Watch> watch) {
+    size_t id;
+    {
+        std::lock_guard lock(watches_mutex_);
+        id = next_id_++;
+        watches_.emplace(id, watch);
+    }
+
+    if (watch->pidfd) {
+        // The pidfd becomes readable when the process exits. The reactor keeps
+        // track of this through epoll, so this doesn't cost anything until
+        // that happens.
+        watch->pidfd->async_wait(
+            asio::posix::stream_descriptor::wait_read,
+            [this, id](const std::error_code& error) {
+                // This will be `operation_aborted` when the guard got dropped
+                if (error) {
+                    return;
+                }
+
+                std::lock_guard lock(watches_mutex_);
+                trigger_locked(id);
+            });
+    } else {
+        // The timer can only be touched from the IO context's thread
+        asio::post(io_context_, [this]() {
+            if (!polling_) {
+                polling_ = true;
+                async_poll();
+            }
+        });
+    }
+
+    return Guard(*this, id);
+}
+
+void ProcessWatchdog::remove(size_t id) noexcept {
+    std::shared_ptr<Watch> watch;
+    {
+        std::lock_guard lock(watches_mutex_);
+        if (const auto it = watches_.find(id); it != watches_.end()) {
+            watch = std::move(it->second);
+            watches_.erase(it);
+        }
+    }
+
+    // This cancels the outstanding wait. Since the callback checks whether the
+    // watch is still in `watches_`, it won't be called after this point even
+    // when the process exits at the same time.
+    if (watch && watch->pidfd) {
+        std::error_code err;
+        watch->pidfd->close(err);
+    }
+}
+
+void ProcessWatchdog::trigger_locked(size_t id) {
+    const auto it = watches_.find(id);
+    if (it == watches_.end()) {
+        return;
+    }
+
+    // The watch is kept alive until the callback has finished
+    const std::shared_ptr<Watch> watch = std::move(it->second);
+    watches_.erase(it);
+
+    watch->on_exit();
+}
+
+void ProcessWatchdog::async_poll() {
+    poll_timer_.expires_after(poll_interval_);
+    poll_timer_.async_wait([this](const std::error_code& error) {
+        if (error) {
+            polling_ = false;
+            return;
+        }
+
+        std::lock_guard lock(watches_mutex_);
+
+        std::vector<size_t> exited_ids;
+        bool has_polled_watches = false;
+        for (const auto& [id, watch] : watches_) {
+            if (watch->pidfd) {
+                continue;
+            }
+
+            has_polled_watches = true;
+            if (!watch->is_running()) {
+                exited_ids.push_back(id);
+            }
+        }
+
+        for (const size_t id : exited_ids) {
+            trigger_locked(id);
+        }
+
+        // There's no need to keep waking up if we're not polling anything
+        if (has_polled_watches) {
+            async_poll();
+        } else {
+            polling_ = false;
+        }
+    });
+}
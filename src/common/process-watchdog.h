@@ -0,0 +1,172 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#ifdef __WINE__
+#include "../wine-host/use-linux-asio.h"
+#endif
+
+#include <asio/io_context.hpp>
+#include <asio/posix/stream_descriptor.hpp>
+#include <asio/steady_timer.hpp>
+
+/**
+ * A process-wide watchdog that calls a function when another process exits.
+ * All watched processes share a single IO context, and thus a single thread,
+ * regardless of how many plugin instances are active. Processes are watched
+ * through a `pidfd`, which Asio's reactor will add to its epoll set. That way
+ * we'll know about a process exiting the moment it happens, and the thread
+ * will not wake up at all otherwise.
+ *
+ * On kernels that don't support `pidfd_open()` (anything older than Linux 5.3),
+ * and for conditions that cannot be expressed as a process ID, the watchdog
+ * falls back to polling. All polled watches share a single timer that only runs
+ * while there's something to poll.
+ *
+ * This is used on the plugin side to abort the initialization when the Wine
+ * plugin host fails to start, and on the Wine side to shut down plugins when
+ * the native plugin host they're connected to has exited.
+ */
+class ProcessWatchdog {
+   public:
+    /**
+     * The function called from the watchdog's thread when a watched process
+     * exits. This is called at most once. The watchdog's mutex is held while
+     * the callback runs, so the callback must not destroy its own `Guard`.
+     * The flip side is that after a `Guard` has been destroyed, its callback is
+     * guaranteed to not run anymore.
+     */
+    using Callback = std::function<void()>;
+
+    /**
+     * The RAII guard returned by `watch()`. The process will be watched until
+     * this guard gets dropped. A default constructed guard doesn't watch
+     * anything.
+     */
+    class Guard {
+       public:
+        Guard() noexcept = default;
+        Guard(ProcessWatchdog& watchdog, size_t id) noexcept;
+        ~Guard() noexcept;
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        Guard(Guard&& o) noexcept;
+        Guard& operator=(Guard&& o) noexcept;
+
+       private:
+        /**
+         * Will be a null pointer if this guard has been moved from.
+         */
+        ProcessWatchdog* watchdog_ = nullptr;
+        size_t id_ = 0;
+    };
+
+    /**
+     * Create a watchdog running on an IO context. The caller is responsible for
+     * running the IO context on its own thread. The IO context should outlive
+     * this object.
+     *
+     * @param io_context The IO context the pidfds and the polling timer will be
+     *   bound to.
+     * @param poll_interval The interval for the fallback polling.
+     */
+    ProcessWatchdog(asio::io_context& io_context,
+                    std::chrono::steady_clock::duration poll_interval);
+
+    ~ProcessWatchdog() noexcept;
+
+    ProcessWatchdog(const ProcessWatchdog&) = delete;
+    ProcessWatchdog& operator=(const ProcessWatchdog&) = delete;
+
+    /**
+     * Call `on_exit` once the process with ID `pid` has exited. If the process
+     * has already exited, then `on_exit` is called during the next poll.
+     */
+    Guard watch(pid_t pid, Callback on_exit);
+
+    /**
+     * Call `on_exit` once `is_running()` returns false. This is always polled.
+     * Both functions are called from the watchdog's thread.
+     */
+    Guard watch(std::function<bool()> is_running, Callback on_exit);
+
+   private:
+    struct Watch {
+        Callback on_exit;
+
+        /**
+         * The process' pidfd, if we could open one. If this is set, then we
+         * can wait for the process to exit without polling.
+         */
+        std::optional<asio::posix::stream_descriptor> pidfd;
+        /**
+         * Used for polling when `pidfd` is not set.
+         */
+        std::function<bool()> is_running;
+    };
+
+    /**
+     * Add a new watch and start waiting on it. Returns the guard for the new
+     * watch.
+     */
+    Guard add(std::shared_ptr<Watch> watch);
+
+    /**
+     * Remove a watch without calling its callback. Called from `Guard`'s
+     * destructor.
+     */
+    void remove(size_t id) noexcept;
+
+    /**
+     * Remove a watch and call its callback, if it's still active. Must be
+     * called with `watches_mutex_` locked.
+     */
+    void trigger_locked(size_t id);
+
+    /**
+     * Check all polled watches, and then schedule another poll if there are
+     * still polled watches left. Only called from the IO context's thread.
+     */
+    void async_poll();
+
+    asio::io_context& io_context_;
+    std::chrono::steady_clock::duration poll_interval_;
+
+    /**
+     * The timer used for the polling fallback. Only accessed from the IO
+     * context's thread.
+     */
+    asio::steady_timer poll_timer_;
+    /**
+     * Whether `poll_timer_` is currently running. Only accessed from the IO
+     * context's thread.
+     */
+    bool polling_ = false;
+
+    std::unordered_map<size_t, std::shared_ptr<Watch>> watches_;
+    std::mutex watches_mutex_;
+    size_t next_id_ = 0;
+};
@@ -20,7 +20,16 @@
 #include <iostream>
 
 #include <spawn.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
+#include <unistd.h>
+
+// glibc only added a wrapper for this in 2.36, and older kernel headers won't
+// define the syscall number either. The number is the same on every
+// architecture.
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
 
 namespace fs = ghc::filesystem;
 
@@ -40,6 +49,15 @@ bool pid_running(pid_t pid) {
     return !err || err.value() == EACCES;
 }
 
+std::optional<int> open_pidfd(pid_t pid) noexcept {
+    const long fd = syscall(SYS_pidfd_open, pid, 0);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    return static_cast<int>(fd);
+}
+
 std::vector<fs::path> get_augmented_search_path() {
     // HACK: `std::locale("")` would return the current locale, but this
     //       overload is implementation specific, and libstdc++ returns an error
@@ -45,6 +45,14 @@
  */
 bool pid_running(pid_t pid);
 
+/**
+ * Open a pidfd for the process with the given PID using `pidfd_open()`. The
+ * file descriptor becomes readable once the process exits. Returns a nullopt if
+ * the process doesn't exist or if the kernel doesn't support pidfds, which
+ * requires Linux 5.3 or newer. The caller owns the returned file descriptor.
+ */
+std::optional<int> open_pidfd(pid_t pid) noexcept;
+
 /**
  * Return the search path as defined in `$PATH`, with `~/.local/share/yabridge`
  * appended to the end. Even though it likely won't be set, this does respect
@@ -85,6 +85,7 @@ using ClapMainThreadControlRequest =
                  clap::ext::note_ports::plugin::Get,
                  clap::ext::params::plugin::GetInfos,
                  clap::ext::params::plugin::GetValue,
+                 clap::ext::params::plugin::GetValues,
                  clap::ext::params::plugin::ValueToText,
                  clap::ext::params::plugin::TextToValue,
                  clap::ext::render::plugin::HasHardRealtimeRequirement,
@@ -282,6 +282,9 @@ class EventList {
      */
     inline size_t size() const noexcept { return events_.size(); }
 
+    inline auto begin() const noexcept { return events_.begin(); }
+    inline auto end() const noexcept { return events_.end(); }
+
     template <typename S>
     void serialize(S& s) {
         s.container(events_, 1 << 16);
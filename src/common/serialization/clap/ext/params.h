@@ -147,6 +147,58 @@ struct GetValue {
     }
 };
 
+/**
+ * A parameter's current value along with the display string for that value.
+ * Both are nullopts if the plugin returned `false`.
+ *
+ * @see GetValues
+ */
+struct ValueAndText {
+    std::optional<double> value;
+    std::optional<std::string> text;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.ext(value, bitsery::ext::InPlaceOptional(),
+              [](S& s, auto& v) { s.value8b(v); });
+        s.ext(text, bitsery::ext::InPlaceOptional(),
+              [](S& s, auto& v) { s.text1b(v, 4096); });
+    }
+};
+
+/**
+ * The response to the `clap::ext::params::plugin::GetValues` message defined
+ * below. The values are in the same order as the requested parameter IDs.
+ */
+struct GetValuesResponse {
+    std::vector<ValueAndText> values;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.container(values, 1 << 16);
+    }
+};
+
+/**
+ * Message struct for calling `clap_plugin_params::get_value()` followed by
+ * `clap_plugin_params::value_to_text()` for multiple parameters at once. This
+ * is sent speculatively when the host queries a plugin's parameters one by one
+ * in order, so the following calls can be answered from the parameter value
+ * cache.
+ */
+struct GetValues {
+    using Response = GetValuesResponse;
+
+    native_size_t instance_id;
+    std::vector<clap_id> param_ids;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.value8b(instance_id);
+        s.container4b(param_ids, 1 << 16);
+    }
+};
+
 /**
  * The response to the `clap::ext::params::plugin::ValueToText` message defined
  * below.
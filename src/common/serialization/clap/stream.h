@@ -21,6 +21,8 @@
 #include <bitsery/traits/vector.h>
 #include <clap/stream.h>
 
+#include "../../bitsery/ext/large-binary.h"
+
 // Serialization messages for `clap/stream.h`
 
 namespace clap {
@@ -68,7 +70,7 @@ class Stream {
 
     template <typename S>
     void serialize(S& s) {
-        s.container1b(buffer_, 50 << 20);
+        s.ext(buffer_, bitsery::ext::LargeBinary{50 << 20});
     }
 
    protected:
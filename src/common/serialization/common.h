@@ -76,10 +76,16 @@ struct WantsConfiguration {
     using Response = Configuration;
 
     std::string host_version;
+    /**
+     * Whether the Wine plugin host was able to load LZ4. The plugin will only
+     * enable `compress_large_messages` if this is the case.
+     */
+    bool host_supports_compression = false;
 
     template <typename S>
     void serialize(S& s) {
         s.text1b(host_version, 128);
+        s.value1b(host_supports_compression);
     }
 };
 
@@ -93,6 +99,13 @@ struct HostRequest {
     std::string plugin_path;
     std::string endpoint_base_dir;
     pid_t parent_pid;
+    /**
+     * Whether a group host process should give this plugin its own GUI thread
+     * instead of hosting it on the group's shared GUI thread. This is set
+     * through the `group_dedicated_gui_thread` option, and it's ignored for
+     * individually hosted plugins since those already have their own process.
+     */
+    bool dedicated_gui_thread = false;
 
     template <typename S>
     void serialize(S& s) {
@@ -100,6 +113,7 @@ struct HostRequest {
         s.text1b(plugin_path, 4096);
         s.text1b(endpoint_base_dir, 4096);
         s.value4b(parent_pid);
+        s.value1b(dedicated_gui_thread);
     }
 };
 
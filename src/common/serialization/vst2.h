@@ -26,6 +26,7 @@
 #include "../audio-shm.h"
 #include "../bitsery/ext/in-place-optional.h"
 #include "../bitsery/ext/in-place-variant.h"
+#include "../bitsery/ext/large-binary.h"
 #include "../bitsery/traits/small-vector.h"
 #include "../utils.h"
 #include "../vst24.h"
@@ -50,6 +51,12 @@ constexpr size_t max_buffer_size = 1 << 16;
  * buffer, which sounds kinda intense, so hopefully this is enough.
  */
 constexpr size_t max_midi_events = max_buffer_size;
+/**
+ * The maximum number of `setParameter()` calls made from the host's audio
+ * thread that can be queued up and sent along with a single
+ * `Vst2ProcessRequest`. See `Vst2PluginBridge::queued_parameter_changes_`.
+ */
+constexpr size_t max_queued_parameter_changes = 1024;
 /**
  * The maximum size in bytes of a string or buffer passed through a void pointer
  * in one of the dispatch functions. This is used to create buffers for plugins
@@ -74,16 +81,19 @@ AEffect& update_aeffect(AEffect& plugin,
                         const AEffect& updated_plugin) noexcept;
 
 /**
- * Wrapper for chunk data.
+ * Wrapper for chunk data. Large chunks are sent as a memfd, in which case the
+ * receiving side can pass the mapped memory directly to the plugin or the host.
+ * When sending, the buffer can borrow the chunk from the host or the plugin to
+ * avoid another copy.
  */
 struct ChunkData {
     using Response = std::nullptr_t;
 
-    std::vector<uint8_t> buffer;
+    BinaryBuffer buffer;
 
     template <typename S>
     void serialize(S& s) {
-        s.container1b(buffer, binary_buffer_size);
+        s.ext(buffer, bitsery::ext::LargeBinary{binary_buffer_size});
     }
 };
 
@@ -528,6 +538,23 @@ struct Parameter {
     }
 };
 
+/**
+ * A `setParameter()` call the host made from its audio thread. Instead of doing
+ * a blocking round trip for every one of these, these changes are queued on the
+ * plugin side and sent along with the next `Vst2ProcessRequest`. The Wine
+ * plugin host then applies them in order right before processing audio.
+ */
+struct Vst2ParameterChange {
+    int index;
+    float value;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.value4b(index);
+        s.value4b(value);
+    }
+};
+
 /**
  * When the host calls `processReplacing()`, `processDoubleReplacing()`, or the
  * deprecated `process()` function on our VST2 plugin, we'll write the input
@@ -574,6 +601,15 @@ struct Vst2ProcessRequest {
      */
     std::optional<int> new_realtime_priority;
 
+    /**
+     * Parameter changes from `setParameter()` calls the host made on its audio
+     * thread since the last processing cycle, in the order they were made.
+     * These should be applied before processing audio. This can hold the
+     * entire queue inline so draining it never allocates on the audio thread.
+     */
+    llvm::SmallVector<Vst2ParameterChange, max_queued_parameter_changes>
+        parameter_changes;
+
     template <typename S>
     void serialize(S& s) {
         s.value4b(sample_frames);
@@ -584,6 +620,8 @@ struct Vst2ProcessRequest {
 
         s.ext(new_realtime_priority, bitsery::ext::InPlaceOptional{},
               [](S& s, int& priority) { s.value4b(priority); });
+
+        s.container(parameter_changes, max_queued_parameter_changes);
     }
 };
 
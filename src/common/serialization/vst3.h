@@ -76,6 +76,7 @@ using Vst3ControlRequest =
                  YaContextMenuTarget::ExecuteMenuItem,
                  YaEditController::SetComponentState,
                  YaEditController::GetParameterInfos,
+                 YaEditController::GetParamValues,
                  YaEditController::GetParamStringByValue,
                  YaEditController::GetParamValueByString,
                  YaEditController::NormalizedParamToPlain,
@@ -92,10 +93,13 @@ using Vst3ControlRequest =
                  YaInfoListener::SetChannelContextInfos,
                  YaKeyswitchController::GetKeyswitchCount,
                  YaKeyswitchController::GetKeyswitchInfo,
+                 YaKeyswitchController::GetKeyswitchInfos,
                  YaMidiLearn::OnLiveMIDIControllerInput,
                  YaMidiMapping::GetMidiControllerAssignment,
+                 YaMidiMapping::GetMidiControllerAssignments,
                  YaNoteExpressionController::GetNoteExpressionCount,
                  YaNoteExpressionController::GetNoteExpressionInfo,
+                 YaNoteExpressionController::GetNoteExpressionInfos,
                  YaNoteExpressionController::GetNoteExpressionStringByValue,
                  YaNoteExpressionController::GetNoteExpressionValueByString,
                  YaNoteExpressionPhysicalUIMapping::GetNotePhysicalUIMapping,
@@ -127,7 +131,9 @@ using Vst3ControlRequest =
                  YaUnitInfo::GetUnitInfo,
                  YaUnitInfo::GetProgramListCount,
                  YaUnitInfo::GetProgramListInfo,
+                 YaUnitInfo::GetUnitInfos,
                  YaUnitInfo::GetProgramName,
+                 YaUnitInfo::GetProgramNames,
                  YaUnitInfo::GetProgramInfo,
                  YaUnitInfo::HasProgramPitchNames,
                  YaUnitInfo::GetProgramPitchName,
@@ -185,8 +191,10 @@ struct Vst3AudioProcessorRequest {
                      YaComponent::SetIoMode,
                      YaComponent::GetBusCount,
                      YaComponent::GetBusInfo,
+                     YaComponent::GetBusTopology,
                      YaComponent::GetRoutingInfo,
                      YaComponent::ActivateBus,
+                     YaComponent::ActivateBusses,
                      YaComponent::SetActive,
                      YaPrefetchableSupport::GetPrefetchableSupport>;
 
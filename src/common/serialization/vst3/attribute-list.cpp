@@ -22,6 +22,8 @@
 
 #include "pluginterfaces/vst/ivstchannelcontextinfo.h"
 
+#include "../../utils.h"
+
 /**
  * Keys for channel context attributes passed in
  * `IInfoListener::setChannelContextInfos` that contain a string value.
@@ -88,17 +90,23 @@ IMPLEMENT_FUNKNOWN_METHODS(YaAttributeList,
 
     std::vector<std::string> YaAttributeList::keys_and_types() const {
     std::vector<std::string> result{};
-    for (const auto& [key, value] : attrs_int_) {
-        result.push_back("\"" + key + "\" (int)");
-    }
-    for (const auto& [key, value] : attrs_float_) {
-        result.push_back("\"" + key + "\" (float)");
-    }
-    for (const auto& [key, value] : attrs_string_) {
-        result.push_back("\"" + key + "\" (string)");
-    }
-    for (const auto& [key, value] : attrs_binary_) {
-        result.push_back("\"" + key + "\" (binary)");
+    for (const auto& attribute : attrs_) {
+        std::visit(
+            overload{
+                [&](const int64&) {
+                    result.push_back("\"" + attribute.key + "\" (int)");
+                },
+                [&](const double&) {
+                    result.push_back("\"" + attribute.key + "\" (float)");
+                },
+                [&](const std::u16string&) {
+                    result.push_back("\"" + attribute.key + "\" (string)");
+                },
+                [&](const BinaryBuffer&) {
+                    result.push_back("\"" + attribute.key + "\" (binary)");
+                },
+            },
+            attribute.value);
     }
 
     return result;
@@ -110,17 +118,23 @@ tresult YaAttributeList::write_back(
         return Steinberg::kInvalidArgument;
     }
 
-    for (const auto& [key, value] : attrs_int_) {
-        stream->setInt(key.c_str(), value);
-    }
-    for (const auto& [key, value] : attrs_float_) {
-        stream->setFloat(key.c_str(), value);
-    }
-    for (const auto& [key, value] : attrs_string_) {
-        stream->setString(key.c_str(), u16string_to_tchar_pointer(value));
-    }
-    for (const auto& [key, value] : attrs_binary_) {
-        stream->setBinary(key.c_str(), value.data(), value.size());
+    for (const auto& attribute : attrs_) {
+        const char* key = attribute.key.c_str();
+        std::visit(overload{
+                       [&](const int64& value) { stream->setInt(key, value); },
+                       [&](const double& value) {
+                           stream->setFloat(key, value);
+                       },
+                       [&](const std::u16string& value) {
+                           stream->setString(
+                               key, u16string_to_tchar_pointer(value));
+                       },
+                       [&](const BinaryBuffer& value) {
+                           stream->setBinary(key, value.data(),
+                                             static_cast<uint32>(value.size()));
+                       },
+                   },
+                   attribute.value);
     }
 
     return Steinberg::kResultOk;
@@ -177,13 +191,13 @@ YaAttributeList YaAttributeList::read_stream_attributes(
 }
 
 tresult PLUGIN_API YaAttributeList::setInt(AttrID id, int64 value) {
-    attrs_int_[id] = value;
+    find_or_insert<int64>(id) = value;
     return Steinberg::kResultOk;
 }
 
 tresult PLUGIN_API YaAttributeList::getInt(AttrID id, int64& value) {
-    if (const auto it = attrs_int_.find(id); it != attrs_int_.end()) {
-        value = it->second;
+    if (const int64* stored_value = find<int64>(id)) {
+        value = *stored_value;
         return Steinberg::kResultOk;
     } else {
         return Steinberg::kResultFalse;
@@ -191,13 +205,13 @@ tresult PLUGIN_API YaAttributeList::getInt(AttrID id, int64& value) {
 }
 
 tresult PLUGIN_API YaAttributeList::setFloat(AttrID id, double value) {
-    attrs_float_[id] = value;
+    find_or_insert<double>(id) = value;
     return Steinberg::kResultOk;
 }
 
 tresult PLUGIN_API YaAttributeList::getFloat(AttrID id, double& value) {
-    if (const auto it = attrs_float_.find(id); it != attrs_float_.end()) {
-        value = it->second;
+    if (const double* stored_value = find<double>(id)) {
+        value = *stored_value;
         return Steinberg::kResultOk;
     } else {
         return Steinberg::kResultFalse;
@@ -210,7 +224,7 @@ YaAttributeList::setString(AttrID id, const Steinberg::Vst::TChar* string) {
         return Steinberg::kInvalidArgument;
     }
 
-    attrs_string_[id] = tchar_pointer_to_u16string(string);
+    find_or_insert<std::u16string>(id) = tchar_pointer_to_u16string(string);
     return Steinberg::kResultOk;
 }
 
@@ -221,15 +235,15 @@ tresult PLUGIN_API YaAttributeList::getString(AttrID id,
         return Steinberg::kInvalidArgument;
     }
 
-    if (const auto it = attrs_string_.find(id); it != attrs_string_.end()) {
+    if (const std::u16string* stored_string = find<std::u16string>(id)) {
         // We may only copy `sizeInBytes / 2` UTF-16 characters to `string`,
         // We'll also have to make sure it's null terminated, so we'll reserve
         // another byte for that.
         const size_t copy_characters = std::min(
             (static_cast<size_t>(sizeInBytes) / sizeof(Steinberg::Vst::TChar)) -
                 1,
-            it->second.size());
-        std::copy_n(it->second.begin(), copy_characters, string);
+            stored_string->size());
+        std::copy_n(stored_string->begin(), copy_characters, string);
         string[copy_characters] = 0;
 
         return Steinberg::kResultOk;
@@ -245,16 +259,21 @@ tresult PLUGIN_API YaAttributeList::setBinary(AttrID id,
         return Steinberg::kInvalidArgument;
     }
 
+    // This reuses the existing buffer's capacity if the plugin keeps sending
+    // messages with the same attribute
     const uint8_t* data_bytes = static_cast<const uint8_t*>(data);
-    attrs_binary_[id].assign(data_bytes, data_bytes + sizeInBytes);
+    find_or_insert<BinaryBuffer>(id).reset_to_owned().assign(
+        data_bytes, data_bytes + sizeInBytes);
     return Steinberg::kResultOk;
 }
 tresult PLUGIN_API YaAttributeList::getBinary(AttrID id,
                                               const void*& data,
                                               uint32& sizeInBytes) {
-    if (const auto it = attrs_binary_.find(id); it != attrs_binary_.end()) {
-        data = it->second.data();
-        sizeInBytes = it->second.size();
+    // If the attribute was received through a memfd, then this points directly
+    // into the mapping
+    if (const BinaryBuffer* buffer = find<BinaryBuffer>(id)) {
+        data = buffer->data();
+        sizeInBytes = static_cast<uint32>(buffer->size());
         return Steinberg::kResultOk;
     } else {
         return Steinberg::kResultFalse;
@@ -16,19 +16,44 @@
 
 #pragma once
 
-#include <unordered_map>
+#include <string>
+#include <variant>
 
-#include <bitsery/ext/std_map.h>
+#include <llvm/small-vector.h>
 #include <pluginterfaces/vst/ivstmessage.h>
 
-#include "../../bitsery/ext/in-place-optional.h"
+#include "../../bitsery/ext/in-place-variant.h"
+#include "../../bitsery/ext/large-binary.h"
+#include "../../bitsery/traits/small-vector.h"
+#include "../../memfd.h"
 #include "base.h"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
 
+/**
+ * The number of attributes a `YaAttributeList` can store before it needs to
+ * allocate.
+ */
+constexpr unsigned attribute_list_inline_capacity = 8;
+
 /**
  * Wraps around `IAttributeList` for storing parameters in `YaMessage`.
+ *
+ * Plugins normally only store a handful of attributes in a message, so instead
+ * of a hash map per attribute type we store all attributes in a single flat
+ * array that's searched linearly. As long as the keys are short enough for the
+ * small string optimization and there are no more than
+ * `attribute_list_inline_capacity` attributes, setting and getting integer and
+ * floating point attributes will not allocate. Like with the SDK's
+ * implementation, a single key can hold a value for each of the four attribute
+ * types at the same time.
+ *
+ * Binary attributes are stored in a `BinaryBuffer`. When an attribute list
+ * gets serialized as part of a message, binary attributes larger than
+ * `memfd_transfer_threshold` are sent through a sealed memfd instead of being
+ * copied through the socket, and `getBinary()` on the receiving side returns a
+ * pointer directly into that mapping.
  */
 class YaAttributeList : public Steinberg::Vst::IAttributeList {
    public:
@@ -92,33 +117,63 @@ class YaAttributeList : public Steinberg::Vst::IAttributeList {
 
     template <typename S>
     void serialize(S& s) {
-        s.ext(attrs_int_, bitsery::ext::StdMap{1 << 20},
-              [](S& s, std::string& key, int64& value) {
-                  s.text1b(key, 1024);
-                  s.value8b(value);
-              });
-        s.ext(attrs_float_, bitsery::ext::StdMap{1 << 20},
-              [](S& s, std::string& key, double& value) {
-                  s.text1b(key, 1024);
-                  s.value8b(value);
-              });
-        s.ext(attrs_string_, bitsery::ext::StdMap{1 << 20},
-              [](S& s, std::string& key, std::u16string& value) {
-                  s.text1b(key, 1024);
-                  s.text2b(value, 1 << 20);
-              });
-        s.ext(attrs_binary_, bitsery::ext::StdMap{1 << 20},
-              [](S& s, std::string& key, std::vector<uint8_t>& value) {
-                  s.text1b(key, 1024);
-                  s.container1b(value, 1 << 20);
-              });
+        s.container(attrs_, 1 << 20, [](S& s, Attribute& attribute) {
+            s.text1b(attribute.key, 1024);
+            s.ext(attribute.value,
+                  bitsery::ext::InPlaceVariant{
+                      [](S& s, int64& value) { s.value8b(value); },
+                      [](S& s, double& value) { s.value8b(value); },
+                      [](S& s, std::u16string& value) {
+                          s.text2b(value, 1 << 20);
+                      },
+                      [](S& s, BinaryBuffer& value) {
+                          s.ext(value, bitsery::ext::LargeBinary{1 << 20});
+                      }});
+        });
     }
 
    private:
-    std::unordered_map<std::string, int64> attrs_int_;
-    std::unordered_map<std::string, double> attrs_float_;
-    std::unordered_map<std::string, std::u16string> attrs_string_;
-    std::unordered_map<std::string, std::vector<uint8_t>> attrs_binary_;
+    /**
+     * A single attribute. The variant's active member determines the
+     * attribute's type.
+     */
+    struct Attribute {
+        std::string key;
+        std::variant<int64, double, std::u16string, BinaryBuffer> value;
+    };
+
+    /**
+     * Find the attribute with type `T` stored under `id`. Returns a null
+     * pointer if there is no such attribute.
+     */
+    template <typename T>
+    T* find(AttrID id) noexcept {
+        for (auto& attribute : attrs_) {
+            if (attribute.key == id) {
+                if (T* value = std::get_if<T>(&attribute.value)) {
+                    return value;
+                }
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * Find the attribute with type `T` stored under `id`, or add a new
+     * default initialized attribute if it does not yet exist.
+     */
+    template <typename T>
+    T& find_or_insert(AttrID id) {
+        if (T* value = find<T>(id)) {
+            return *value;
+        }
+
+        return std::get<T>(
+            attrs_.emplace_back(Attribute{.key = id, .value = T{}}).value);
+    }
+
+    llvm::SmallVector<Attribute, attribute_list_inline_capacity> attrs_;
 };
 
 #pragma GCC diagnostic pop
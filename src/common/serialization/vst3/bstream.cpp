@@ -18,6 +18,7 @@
 
 #include <cassert>
 #include <stdexcept>
+#include <system_error>
 
 YaBStream::YaBStream() noexcept {FUNKNOWN_CTOR}
 
@@ -43,12 +44,13 @@ YaBStream::YaBStream(Steinberg::IBStream* stream) {
         size -= old_position;
 
         if (size > 0) {
+            // For large streams this reads directly into a memfd, which can
+            // then be sent to the Wine plugin host without copying
             int32 num_bytes_read = 0;
-            buffer_.resize(size);
+            uint8_t* data = buffer_.resize(static_cast<size_t>(size));
             stream->seek(old_position,
                          Steinberg::IBStream::IStreamSeekMode::kIBSeekSet);
-            stream->read(buffer_.data(), static_cast<int32>(size),
-                         &num_bytes_read);
+            stream->read(data, static_cast<int32>(size), &num_bytes_read);
             assert(num_bytes_read == 0 || num_bytes_read == size);
         }
     }
@@ -151,7 +153,7 @@ tresult PLUGIN_API YaBStream::read(void* buffer,
                  static_cast<int64_t>(buffer_.size()) - seek_position_);
 
     if (bytes_to_read > 0) {
-        std::copy_n(&buffer_[seek_position_], bytes_to_read,
+        std::copy_n(buffer_.data() + seek_position_, bytes_to_read,
                     reinterpret_cast<uint8_t*>(buffer));
         seek_position_ += bytes_to_read;
     }
@@ -170,12 +172,18 @@ tresult PLUGIN_API YaBStream::write(void* buffer,
         return Steinberg::kInvalidArgument;
     }
 
-    if (seek_position_ + numBytes > static_cast<int64_t>(buffer_.size())) {
-        buffer_.resize(seek_position_ + numBytes);
+    // This may need to move the buffer to a memfd, or to copy a mapping we
+    // received from the other side, so we'll always go through `resize()`
+    uint8_t* data;
+    try {
+        data = buffer_.resize(std::max(
+            buffer_.size(), static_cast<size_t>(seek_position_ + numBytes)));
+    } catch (const std::system_error&) {
+        return Steinberg::kOutOfMemory;
     }
 
     std::copy_n(reinterpret_cast<uint8_t*>(buffer), numBytes,
-                &buffer_[seek_position_]);
+                data + seek_position_);
 
     seek_position_ += numBytes;
     if (numBytesWritten) {
@@ -226,7 +234,16 @@ tresult PLUGIN_API YaBStream::getStreamSize(int64& size) {
 }
 
 tresult PLUGIN_API YaBStream::setStreamSize(int64 size) {
-    buffer_.resize(size);
+    if (size < 0) {
+        return Steinberg::kInvalidArgument;
+    }
+
+    try {
+        buffer_.resize(static_cast<size_t>(size));
+    } catch (const std::system_error&) {
+        return Steinberg::kOutOfMemory;
+    }
+
     return Steinberg::kResultOk;
 }
 
@@ -21,6 +21,7 @@
 #include <pluginterfaces/base/ibstream.h>
 #include <pluginterfaces/vst/ivstattributes.h>
 
+#include "../../bitsery/ext/large-binary.h"
 #include "attribute-list.h"
 #include "base.h"
 
@@ -28,9 +29,15 @@
 #pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
 
 /**
- * Serialize an `IBStream` into an `std::vector<uint8_t>`, and allow the
- * receiving side to use it as an `IBStream` again. `ISizeableStream` is defined
- * but then for whatever reason never used, but we'll implement it anyways.
+ * Serialize an `IBStream` into a `BinaryBuffer`, and allow the receiving side
+ * to use it as an `IBStream` again. `ISizeableStream` is defined but then for
+ * whatever reason never used, but we'll implement it anyways.
+ *
+ * Plugins can write hundreds of megabytes of state to these streams. Once the
+ * stream grows past `memfd_transfer_threshold`, it is written directly to a
+ * memfd that grows in large chunks, and that memfd is then sent to the other
+ * side as is. The receiving side reads from the mapped memfd without copying
+ * the data again.
  *
  * If we're copying data from an existing `IBstream` and that stream supports
  * VST 3.6.0 preset meta data, then we'll copy that meta data as well.
@@ -90,7 +97,7 @@ class YaBStream : public Steinberg::IBStream,
 
     template <typename S>
     void serialize(S& s) {
-        s.container1b(buffer_, max_vector_stream_size);
+        s.ext(buffer_, bitsery::ext::LargeBinary{max_vector_stream_size});
         // The seek position should always be initialized at 0
 
         s.value1b(supports_stream_attributes_);
@@ -119,7 +126,7 @@ class YaBStream : public Steinberg::IBStream,
     std::optional<YaAttributeList> attributes_;
 
    private:
-    std::vector<uint8_t> buffer_;
+    BinaryBuffer buffer_;
     int64_t seek_position_ = 0;
 };
 
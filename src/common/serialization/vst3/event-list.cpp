@@ -81,29 +81,89 @@ Steinberg::Vst::ScaleEvent YaScaleEvent::get() const noexcept {
         .text = u16string_to_tchar_pointer(text)};
 }
 
-YaEvent::YaEvent() noexcept {}
+std::optional<YaPackedEvent> YaPackedEvent::pack(
+    const Steinberg::Vst::Event& event) noexcept {
+    YaPackedEvent packed_event{};
+    packed_event.bus_index = event.busIndex;
+    packed_event.sample_offset = event.sampleOffset;
+    packed_event.ppq_position = event.ppqPosition;
+    packed_event.flags = event.flags;
+    packed_event.type = event.type;
 
-YaEvent::YaEvent(const Steinberg::Vst::Event& event) noexcept
-    : bus_index(event.busIndex),
-      sample_offset(event.sampleOffset),
-      ppq_position(event.ppqPosition),
-      flags(event.flags) {
-    // Now we need the correct event type
     switch (event.type) {
         case Steinberg::Vst::Event::kNoteOnEvent:
-            payload = event.noteOn;
+            packed_event.note_on = event.noteOn;
             break;
         case Steinberg::Vst::Event::kNoteOffEvent:
-            payload = event.noteOff;
+            packed_event.note_off = event.noteOff;
             break;
-        case Steinberg::Vst::Event::kDataEvent:
-            payload = YaDataEvent(event.data);
+        case Steinberg::Vst::Event::kPolyPressureEvent:
+            packed_event.poly_pressure = event.polyPressure;
+            break;
+        case Steinberg::Vst::Event::kNoteExpressionValueEvent:
+            packed_event.note_expression_value = event.noteExpressionValue;
+            break;
+        case Steinberg::Vst::Event::kLegacyMIDICCOutEvent:
+            packed_event.midi_cc_out = event.midiCCOut;
+            break;
+        default:
+            return std::nullopt;
+            break;
+    }
+
+    return packed_event;
+}
+
+YaPackedEvent YaPackedEvent::unpacked(uint32 index) noexcept {
+    YaPackedEvent packed_event{};
+    packed_event.type = unpacked_type;
+    packed_event.unpacked_index = index;
+
+    return packed_event;
+}
+
+Steinberg::Vst::Event YaPackedEvent::get() const noexcept {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+    Steinberg::Vst::Event event{.busIndex = bus_index,
+                                .sampleOffset = sample_offset,
+                                .ppqPosition = ppq_position,
+                                .flags = flags,
+                                .type = type};
+#pragma GCC diagnostic pop
+    switch (type) {
+        case Steinberg::Vst::Event::kNoteOnEvent:
+            event.noteOn = note_on;
+            break;
+        case Steinberg::Vst::Event::kNoteOffEvent:
+            event.noteOff = note_off;
             break;
         case Steinberg::Vst::Event::kPolyPressureEvent:
-            payload = event.polyPressure;
+            event.polyPressure = poly_pressure;
             break;
         case Steinberg::Vst::Event::kNoteExpressionValueEvent:
-            payload = event.noteExpressionValue;
+            event.noteExpressionValue = note_expression_value;
+            break;
+        case Steinberg::Vst::Event::kLegacyMIDICCOutEvent:
+            event.midiCCOut = midi_cc_out;
+            break;
+    }
+
+    return event;
+}
+
+YaEvent::YaEvent() noexcept {}
+
+YaEvent::YaEvent(const Steinberg::Vst::Event& event) noexcept
+    : bus_index(event.busIndex),
+      sample_offset(event.sampleOffset),
+      ppq_position(event.ppqPosition),
+      flags(event.flags) {
+    // Now we need the correct event type. The other event types are stored as
+    // `YaPackedEvent`s.
+    switch (event.type) {
+        case Steinberg::Vst::Event::kDataEvent:
+            payload = YaDataEvent(event.data);
             break;
         case Steinberg::Vst::Event::kNoteExpressionTextEvent:
             payload = YaNoteExpressionTextEvent(event.noteExpressionText);
@@ -114,9 +174,6 @@ YaEvent::YaEvent(const Steinberg::Vst::Event& event) noexcept
         case Steinberg::Vst::Event::kScaleEvent:
             payload = YaScaleEvent(event.scale);
             break;
-        case Steinberg::Vst::Event::kLegacyMIDICCOutEvent:
-            payload = event.midiCCOut;
-            break;
         default:
             // XXX: When encountering something we don't know about, should we
             //      throw or silently ignore it? We can't properly log about
@@ -136,27 +193,10 @@ Steinberg::Vst::Event YaEvent::get() const noexcept {
 #pragma GCC diagnostic pop
     std::visit(
         overload{
-            [&](const Steinberg::Vst::NoteOnEvent& specific_event) {
-                event.type = Steinberg::Vst::Event::kNoteOnEvent;
-                event.noteOn = specific_event;
-            },
-            [&](const Steinberg::Vst::NoteOffEvent& specific_event) {
-                event.type = Steinberg::Vst::Event::kNoteOffEvent;
-                event.noteOff = specific_event;
-            },
             [&](const YaDataEvent& specific_event) {
                 event.type = Steinberg::Vst::Event::kDataEvent;
                 event.data = specific_event.get();
             },
-            [&](const Steinberg::Vst::PolyPressureEvent& specific_event) {
-                event.type = Steinberg::Vst::Event::kPolyPressureEvent;
-                event.polyPressure = specific_event;
-            },
-            [&](const Steinberg::Vst::NoteExpressionValueEvent&
-                    specific_event) {
-                event.type = Steinberg::Vst::Event::kNoteExpressionValueEvent;
-                event.noteExpressionValue = specific_event;
-            },
             [&](const YaNoteExpressionTextEvent& specific_event) {
                 event.type = Steinberg::Vst::Event::kNoteExpressionTextEvent;
                 event.noteExpressionText = specific_event.get();
@@ -168,10 +208,6 @@ Steinberg::Vst::Event YaEvent::get() const noexcept {
             [&](const YaScaleEvent& specific_event) {
                 event.type = Steinberg::Vst::Event::kScaleEvent;
                 event.scale = specific_event.get();
-            },
-            [&](const Steinberg::Vst::LegacyMIDICCOutEvent& specific_event) {
-                event.type = Steinberg::Vst::Event::kLegacyMIDICCOutEvent;
-                event.midiCCOut = specific_event;
             }},
         payload);
 
@@ -184,18 +220,19 @@ YaEventList::YaEventList() noexcept {
 
 void YaEventList::clear() noexcept {
     events_.clear();
+    unpacked_events_.clear();
 }
 
 void YaEventList::repopulate(Steinberg::Vst::IEventList& event_list) {
-    // Copy over all events. Everything gets converted to `YaEvent`s. We sadly
-    // can't construct these in place because we don't know the event type yet.
-    events_.clear();
+    // Copy over all events. Most events get stored as `YaPackedEvent`s, and
+    // events with heap data get converted to `YaEvent`s.
+    clear();
     events_.reserve(event_list.getEventCount());
     for (int i = 0; i < event_list.getEventCount(); i++) {
         // We're skipping the `kResultOk` assertions here
         Steinberg::Vst::Event event;
         event_list.getEvent(i, event);
-        events_.emplace_back(event);
+        add(event);
     }
 }
 
@@ -207,9 +244,11 @@ size_t YaEventList::num_events() const noexcept {
 
 void YaEventList::write_back_outputs(
     Steinberg::Vst::IEventList& output_events) const {
-    for (auto& event : events_) {
-        Steinberg::Vst::Event reconstructed_event = event.get();
-        output_events.addEvent(reconstructed_event);
+    for (const auto& event : events_) {
+        if (std::optional<Steinberg::Vst::Event> reconstructed_event =
+                get(event)) {
+            output_events.addEvent(*reconstructed_event);
+        }
     }
 }
 
@@ -231,15 +270,40 @@ tresult PLUGIN_API YaEventList::getEvent(int32 index,
     }
 
     // Reconstructing an event is cheap, but some events may contain pointers to
-    // heap data stored within the `events` vector so this event will still have
-    // the same lifetime as this class
-    e = events_[index].get();
-
-    return Steinberg::kResultOk;
+    // heap data stored within the `unpacked_events_` vector so this event will
+    // still have the same lifetime as this class
+    if (std::optional<Steinberg::Vst::Event> event = get(events_[index])) {
+        e = *event;
+        return Steinberg::kResultOk;
+    } else {
+        return Steinberg::kInvalidArgument;
+    }
 }
 
 tresult PLUGIN_API YaEventList::addEvent(Steinberg::Vst::Event& e /*in*/) {
-    events_.push_back(e);
+    add(e);
 
     return Steinberg::kResultOk;
 }
+
+void YaEventList::add(const Steinberg::Vst::Event& event) {
+    if (std::optional<YaPackedEvent> packed_event =
+            YaPackedEvent::pack(event)) {
+        events_.push_back(*packed_event);
+    } else {
+        events_.push_back(YaPackedEvent::unpacked(
+            static_cast<uint32>(unpacked_events_.size())));
+        unpacked_events_.emplace_back(event);
+    }
+}
+
+std::optional<Steinberg::Vst::Event> YaEventList::get(
+    const YaPackedEvent& event) const noexcept {
+    if (event.type != YaPackedEvent::unpacked_type) {
+        return event.get();
+    } else if (event.unpacked_index < unpacked_events_.size()) {
+        return unpacked_events_[event.unpacked_index].get();
+    } else {
+        return std::nullopt;
+    }
+}
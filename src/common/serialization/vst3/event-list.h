@@ -16,10 +16,16 @@
 
 #pragma once
 
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
 #include <llvm/small-vector.h>
 #include <pluginterfaces/vst/ivstevents.h>
 
 #include "../../bitsery/ext/in-place-variant.h"
+#include "../../bitsery/ext/packed-array.h"
 #include "../../bitsery/traits/small-vector.h"
 #include "base.h"
 
@@ -165,8 +171,69 @@ struct YaScaleEvent {
 };
 
 /**
- * A wrapper around `Event` for serialization purposes, as some event types
- * include heap pointers.
+ * A fixed-size copy of an `Event` for the event types that don't contain any
+ * heap pointers. These are by far the most common events (notes, poly
+ * pressure, note expression values, and MIDI CC output), so `YaEventList`
+ * stores all events in this format and serializes them in one go using
+ * `bitsery::ext::PackedArray`. Events that do contain heap data are stored as
+ * a `YaEvent` in a separate list instead, and the packed event then only
+ * contains that event's index in that list.
+ *
+ * The layout is spelled out explicitly so it's the same in 32-bit and 64-bit
+ * builds.
+ */
+struct alignas(8) YaPackedEvent {
+    /**
+     * The value of `type` for events stored in `YaEventList`'s list of
+     * unpacked events. This is not a valid `Event::EventTypes` value.
+     */
+    static constexpr uint16 unpacked_type = 0xffff;
+
+    /**
+     * Copy an `Event`. Returns a nullopt if the event contains heap pointers,
+     * or if it's of a type we don't know about. Those events need to be stored
+     * as a `YaEvent` instead.
+     */
+    static std::optional<YaPackedEvent> pack(
+        const Steinberg::Vst::Event& event) noexcept;
+
+    /**
+     * Create a placeholder for the unpacked event at `index`.
+     */
+    static YaPackedEvent unpacked(uint32 index) noexcept;
+
+    /**
+     * Reconstruct an `Event` from this object. This should not be called for
+     * placeholders created with `unpacked()`.
+     */
+    Steinberg::Vst::Event get() const noexcept;
+
+    // These fields directly reflect those from `Event`
+    int32 bus_index;
+    int32 sample_offset;
+    Steinberg::Vst::TQuarterNotes ppq_position;
+    uint16 flags;
+    uint16 type;
+    uint32 padding;
+
+    union {
+        Steinberg::Vst::NoteOnEvent note_on;
+        Steinberg::Vst::NoteOffEvent note_off;
+        Steinberg::Vst::PolyPressureEvent poly_pressure;
+        Steinberg::Vst::NoteExpressionValueEvent note_expression_value;
+        Steinberg::Vst::LegacyMIDICCOutEvent midi_cc_out;
+        uint32 unpacked_index;
+    };
+};
+
+static_assert(std::is_trivially_copyable_v<YaPackedEvent>);
+static_assert(offsetof(YaPackedEvent, note_on) == 24);
+static_assert(sizeof(YaPackedEvent) == 48);
+
+/**
+ * A wrapper around `Event` for serialization purposes, used for the event
+ * types that include heap pointers. Every other event is stored as a
+ * `YaPackedEvent`.
  */
 struct alignas(16) YaEvent {
     YaEvent() noexcept;
@@ -191,17 +258,12 @@ struct alignas(16) YaEvent {
     uint16 flags;
 
     // `Event` stores an event type and a union, we'll encode both in a variant.
-    // We can use simple types directly, and we need serializable wrappers
-    // around move event types with heap pointers.
-    std::variant<Steinberg::Vst::NoteOnEvent,
-                 Steinberg::Vst::NoteOffEvent,
-                 YaDataEvent,
-                 Steinberg::Vst::PolyPressureEvent,
-                 Steinberg::Vst::NoteExpressionValueEvent,
+    // We need serializable wrappers around these event types since they
+    // contain heap pointers.
+    std::variant<YaDataEvent,
                  YaNoteExpressionTextEvent,
                  YaChordEvent,
-                 YaScaleEvent,
-                 Steinberg::Vst::LegacyMIDICCOutEvent>
+                 YaScaleEvent>
         payload;
 
     template <typename S>
@@ -263,57 +325,32 @@ class YaEventList : public Steinberg::Vst::IEventList {
 
     template <typename S>
     void serialize(S& s) {
-        s.container(events_, 1 << 16);
+        s.ext(events_, bitsery::ext::PackedArray{1 << 16});
+        s.container(unpacked_events_, 1 << 16);
     }
 
    private:
-    llvm::SmallVector<YaEvent, 64> events_;
+    /**
+     * Add an event to the end of the list, packing it if possible.
+     */
+    void add(const Steinberg::Vst::Event& event);
+
+    /**
+     * Reconstruct the `Event` for an entry in `events_`. Returns a nullopt if
+     * it refers to an unpacked event that doesn't exist.
+     */
+    std::optional<Steinberg::Vst::Event> get(
+        const YaPackedEvent& event) const noexcept;
+
+    /**
+     * All events in the order they were added.
+     */
+    llvm::SmallVector<YaPackedEvent, 64> events_;
+    /**
+     * Events that could not be packed, like SysEx and text events. These are
+     * referenced by index from the placeholders in `events_`.
+     */
+    std::vector<YaEvent> unpacked_events_;
 };
 
 #pragma GCC diagnostic pop
-
-namespace Steinberg {
-namespace Vst {
-template <typename S>
-void serialize(S& s, NoteOnEvent& event) {
-    s.value2b(event.channel);
-    s.value2b(event.pitch);
-    s.value4b(event.tuning);
-    s.value4b(event.velocity);
-    s.value4b(event.length);
-    s.value4b(event.noteId);
-}
-
-template <typename S>
-void serialize(S& s, NoteOffEvent& event) {
-    s.value2b(event.channel);
-    s.value2b(event.pitch);
-    s.value4b(event.velocity);
-    s.value4b(event.noteId);
-    s.value4b(event.tuning);
-}
-
-template <typename S>
-void serialize(S& s, PolyPressureEvent& event) {
-    s.value2b(event.channel);
-    s.value2b(event.pitch);
-    s.value4b(event.pressure);
-    s.value4b(event.noteId);
-}
-
-template <typename S>
-void serialize(S& s, NoteExpressionValueEvent& event) {
-    s.value4b(event.typeId);
-    s.value4b(event.noteId);
-    s.value8b(event.value);
-}
-
-template <typename S>
-void serialize(S& s, LegacyMIDICCOutEvent& event) {
-    s.value1b(event.controlNumber);
-    s.value1b(event.channel);
-    s.value1b(event.value);
-    s.value1b(event.value2);
-}
-}  // namespace Vst
-}  // namespace Steinberg
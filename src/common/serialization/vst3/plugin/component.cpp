@@ -24,3 +24,25 @@ YaComponent::ConstructArgs::ConstructArgs(
 
 YaComponent::YaComponent(ConstructArgs&& args) noexcept
     : arguments_(std::move(args)) {}
+
+const std::vector<YaComponent::BusTopologyEntry>*
+YaComponent::GetBusTopologyResponse::busses(
+    Steinberg::Vst::MediaType type,
+    Steinberg::Vst::BusDirection dir) const noexcept {
+    const bool is_input = dir == Steinberg::Vst::kInput;
+    if (!is_input && dir != Steinberg::Vst::kOutput) {
+        return nullptr;
+    }
+
+    switch (type) {
+        case Steinberg::Vst::kAudio:
+            return is_input ? &audio_inputs : &audio_outputs;
+            break;
+        case Steinberg::Vst::kEvent:
+            return is_input ? &event_inputs : &event_outputs;
+            break;
+        default:
+            return nullptr;
+            break;
+    }
+}
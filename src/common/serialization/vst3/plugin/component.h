@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <pluginterfaces/vst/ivstcomponent.h>
 
 #include "../../../audio-shm.h"
@@ -254,6 +256,132 @@ class YaComponent : public Steinberg::Vst::IComponent {
                                            int32 index,
                                            TBool state) override = 0;
 
+    /**
+     * A single bus activation in `ActivateBusses`.
+     */
+    struct BusActivation {
+        Steinberg::Vst::MediaType type;
+        Steinberg::Vst::BusDirection dir;
+        int32 index;
+        TBool state;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value4b(type);
+            s.value4b(dir);
+            s.value4b(index);
+            s.value1b(state);
+        }
+    };
+
+    /**
+     * The response codes for every bus activation in `ActivateBusses`, in the
+     * same order.
+     */
+    struct ActivateBussesResponse {
+        std::vector<UniversalTResult> results;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.container(results, 1 << 16);
+        }
+    };
+
+    /**
+     * Message to pass through multiple `IComponent::activateBus(type, dir,
+     * index, state)` calls to the Wine plugin host at once. Hosts often
+     * (de)activate every bus one by one before activating the plugin, so while
+     * the plugin is inactive the plugin side will collect these calls and send
+     * them right before they can start to matter.
+     */
+    struct ActivateBusses {
+        using Response = ActivateBussesResponse;
+
+        native_size_t instance_id;
+
+        std::vector<BusActivation> activations;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(instance_id);
+            s.container(activations, 1 << 16);
+        }
+    };
+
+    /**
+     * A single bus in `GetBusTopologyResponse`.
+     */
+    struct BusTopologyEntry {
+        /**
+         * The result of `IComponent::getBusInfo()` for this bus.
+         */
+        GetBusInfoResponse info;
+        /**
+         * The result of `IAudioProcessor::getBusArrangement()` for this bus.
+         * This is only queried for audio busses, and it's left at
+         * `kResultFalse` for event busses and for objects that don't implement
+         * `IAudioProcessor`.
+         */
+        UniversalTResult arrangement_result;
+        Steinberg::Vst::SpeakerArrangement arrangement = 0;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.object(info);
+            s.object(arrangement_result);
+            s.value8b(arrangement);
+        }
+    };
+
+    /**
+     * All of a plugin's audio and event busses, for both directions. The
+     * vectors contain an entry for every index up to the bus count.
+     *
+     * @see GetBusTopology
+     */
+    struct GetBusTopologyResponse {
+        std::vector<BusTopologyEntry> audio_inputs;
+        std::vector<BusTopologyEntry> audio_outputs;
+        std::vector<BusTopologyEntry> event_inputs;
+        std::vector<BusTopologyEntry> event_outputs;
+
+        /**
+         * Get the busses for a media type and direction. Returns a null pointer
+         * for values we don't know about, in which case the plugin should be
+         * asked directly.
+         */
+        const std::vector<BusTopologyEntry>* busses(
+            Steinberg::Vst::MediaType type,
+            Steinberg::Vst::BusDirection dir) const noexcept;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.container(audio_inputs, 1 << 16);
+            s.container(audio_outputs, 1 << 16);
+            s.container(event_inputs, 1 << 16);
+            s.container(event_outputs, 1 << 16);
+        }
+    };
+
+    /**
+     * Get the plugin's entire I/O topology at once using
+     * `IComponent::getBusCount()`, `IComponent::getBusInfo()` and
+     * `IAudioProcessor::getBusArrangement()`. Hosts query every bus many
+     * times while setting up a plugin, so like with `GetParameterInfos` this
+     * is fetched all at once and then cached on the plugin side until the
+     * bus layout may have changed.
+     */
+    struct GetBusTopology {
+        using Response = GetBusTopologyResponse;
+
+        native_size_t instance_id;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(instance_id);
+        }
+    };
+
     /**
      * The response code and written state for a call to
      * `IAudioProcessor::setActive(state)`.
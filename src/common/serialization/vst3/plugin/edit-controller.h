@@ -138,6 +138,61 @@ class YaEditController : public Steinberg::Vst::IEditController {
         }
     };
 
+    /**
+     * A parameter's current normalized value along with the display string for
+     * that value.
+     *
+     * @see GetParamValues
+     */
+    struct ParamValueAndString {
+        Steinberg::Vst::ParamValue value_normalized;
+        UniversalTResult string_result;
+        std::u16string string;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(value_normalized);
+            s.object(string_result);
+            s.text2b(string, std::extent_v<Steinberg::Vst::String128>);
+        }
+    };
+
+    /**
+     * The values and display strings for the parameters requested in
+     * `GetParamValues`, in the same order as the requested IDs.
+     *
+     * @see GetParamValues
+     */
+    struct GetParamValuesResponse {
+        std::vector<ParamValueAndString> values;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.container(values, 1 << 16);
+        }
+    };
+
+    /**
+     * Query the results of `IEditController::getParamNormalized()` and
+     * `IEditController::getParamStringByValue()` for the current value of
+     * multiple parameters at once. This is sent speculatively when the host
+     * queries a plugin's parameters one by one in order, so the following
+     * calls can be answered from the parameter value cache.
+     */
+    struct GetParamValues {
+        using Response = GetParamValuesResponse;
+
+        native_size_t instance_id;
+
+        std::vector<Steinberg::Vst::ParamID> ids;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(instance_id);
+            s.container4b(ids, 1 << 16);
+        }
+    };
+
     virtual int32 PLUGIN_API getParameterCount() override = 0;
     virtual tresult PLUGIN_API
     getParameterInfo(int32 paramIndex,
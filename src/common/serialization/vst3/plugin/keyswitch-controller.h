@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <pluginterfaces/vst/ivstnoteexpression.h>
 
 #include "../../common.h"
@@ -132,6 +134,47 @@ class YaKeyswitchController : public Steinberg::Vst::IKeyswitchController {
                      int32 keySwitchIndex,
                      Steinberg::Vst::KeyswitchInfo& info /*out*/) override = 0;
 
+    /**
+     * All of the keyswitches for a bus and channel.
+     *
+     * @see GetKeyswitchInfos
+     */
+    struct GetKeyswitchInfosResponse {
+        /**
+         * The results of `IKeyswitchController::getKeyswitchInfo()` for every
+         * index up to the keyswitch count.
+         */
+        std::vector<GetKeyswitchInfoResponse> infos;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.container(infos, 1 << 16);
+        }
+    };
+
+    /**
+     * Get all of a bus and channel's keyswitches at once using both
+     * `IKeyswitchController::getKeyswitchCount()` and
+     * `IKeyswitchController::getKeyswitchInfo()`. Hosts query every keyswitch
+     * to populate their articulation lists, so like with `GetParameterInfos`
+     * these are fetched all at once and then cached on the plugin side.
+     */
+    struct GetKeyswitchInfos {
+        using Response = GetKeyswitchInfosResponse;
+
+        native_size_t instance_id;
+
+        int32 bus_index;
+        int16 channel;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(instance_id);
+            s.value4b(bus_index);
+            s.value2b(channel);
+        }
+    };
+
    protected:
     ConstructArgs arguments_;
 };
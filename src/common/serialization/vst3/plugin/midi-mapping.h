@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include <vector>
+
 #include <pluginterfaces/vst/ivsteditcontroller.h>
+#include <pluginterfaces/vst/ivstmidicontrollers.h>
 
 #include "../../common.h"
 #include "../base.h"
@@ -24,6 +27,14 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
 
+/**
+ * The number of MIDI channels per event bus `GetMidiControllerAssignments`
+ * fetches the assignments for. Hosts can technically ask for any channel within
+ * a bus's channel count, but everything beyond the 16 regular MIDI channels is
+ * passed through to the plugin one call at a time.
+ */
+constexpr int16 midi_mapping_num_channels = 16;
+
 /**
  * Wraps around `IMidiMapping` for serialization purposes. This is instantiated
  * as part of `Vst3PluginProxy`.
@@ -102,6 +113,69 @@ class YaMidiMapping : public Steinberg::Vst::IMidiMapping {
         }
     };
 
+    /**
+     * A single assignment returned by
+     * `IMidiMapping::getMidiControllerAssignment()`.
+     *
+     * @see GetMidiControllerAssignments
+     */
+    struct MidiControllerAssignment {
+        int16 channel;
+        Steinberg::Vst::CtrlNumber midi_controller_number;
+        Steinberg::Vst::ParamID id;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value2b(channel);
+            s.value2b(midi_controller_number);
+            s.value4b(id);
+        }
+    };
+
+    /**
+     * All MIDI controller assignments for an event bus.
+     *
+     * @see GetMidiControllerAssignments
+     */
+    struct GetMidiControllerAssignmentsResponse {
+        /**
+         * Every channel and controller number combination for which
+         * `IMidiMapping::getMidiControllerAssignment()` returned `kResultOk`.
+         * All other combinations don't have an assignment.
+         */
+        std::vector<MidiControllerAssignment> assignments;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.container(assignments,
+                        midi_mapping_num_channels *
+                            Steinberg::Vst::kCountCtrlNumber);
+        }
+    };
+
+    /**
+     * Call `IMidiMapping::getMidiControllerAssignment()` for every MIDI
+     * controller number on the first `midi_mapping_num_channels` channels of an
+     * event bus at once. Hosts like Cubase and Bitwig query every single
+     * combination whenever a plugin gets loaded and after every component
+     * restart, which would otherwise take thousands of round trips per plugin
+     * instance. The results are cached on the plugin side until the plugin
+     * restarts its component.
+     */
+    struct GetMidiControllerAssignments {
+        using Response = GetMidiControllerAssignmentsResponse;
+
+        native_size_t instance_id;
+
+        int32 bus_index;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(instance_id);
+            s.value4b(bus_index);
+        }
+    };
+
     virtual tresult PLUGIN_API getMidiControllerAssignment(
         int32 busIndex,
         int16 channel,
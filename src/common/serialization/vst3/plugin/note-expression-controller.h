@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <pluginterfaces/vst/ivstnoteexpression.h>
 
 #include "../../common.h"
@@ -136,6 +138,46 @@ class YaNoteExpressionController
         int32 noteExpressionIndex,
         Steinberg::Vst::NoteExpressionTypeInfo& info /*out*/) override = 0;
 
+    /**
+     * All of the note expression types for a bus and channel.
+     *
+     * @see GetNoteExpressionInfos
+     */
+    struct GetNoteExpressionInfosResponse {
+        /**
+         * The results of `INoteExpressionController::getNoteExpressionInfo()`
+         * for every index up to the note expression count.
+         */
+        std::vector<GetNoteExpressionInfoResponse> infos;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.container(infos, 1 << 16);
+        }
+    };
+
+    /**
+     * Get all of a bus and channel's note expression types at once using both
+     * `INoteExpressionController::getNoteExpressionCount()` and
+     * `INoteExpressionController::getNoteExpressionInfo()`. These are cached on
+     * the plugin side, just like `GetParameterInfos`.
+     */
+    struct GetNoteExpressionInfos {
+        using Response = GetNoteExpressionInfosResponse;
+
+        native_size_t instance_id;
+
+        int32 bus_index;
+        int16 channel;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(instance_id);
+            s.value4b(bus_index);
+            s.value2b(channel);
+        }
+    };
+
     /**
      * The response code and returned string for a call to
      * `INoteExpressionController::getNoteExpressionStringByValue(bus_index,
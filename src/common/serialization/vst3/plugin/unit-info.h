@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <pluginterfaces/vst/ivstunits.h>
 
 #include "../../common.h"
@@ -173,6 +175,49 @@ class YaUnitInfo : public Steinberg::Vst::IUnitInfo {
         int32 listIndex,
         Steinberg::Vst::ProgramListInfo& info /*out*/) override = 0;
 
+    /**
+     * All of a plugin's unit and program list information.
+     *
+     * @see GetUnitInfos
+     */
+    struct GetUnitInfosResponse {
+        /**
+         * The results of `IUnitInfo::getUnitInfo()` for every index up to the
+         * unit count.
+         */
+        std::vector<GetUnitInfoResponse> unit_infos;
+        /**
+         * The results of `IUnitInfo::getProgramListInfo()` for every index up
+         * to the program list count.
+         */
+        std::vector<GetProgramListInfoResponse> program_list_infos;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.container(unit_infos, 1 << 16);
+            s.container(program_list_infos, 1 << 16);
+        }
+    };
+
+    /**
+     * Get all of the plugin's units and program lists at once using
+     * `IUnitInfo::getUnitCount()`, `IUnitInfo::getUnitInfo()`,
+     * `IUnitInfo::getProgramListCount()` and `IUnitInfo::getProgramListInfo()`.
+     * Hosts enumerate all of these whenever they build a preset menu, so like
+     * with `GetParameterInfos` this is fetched all at once and then cached on
+     * the plugin side until the plugin reports that something has changed.
+     */
+    struct GetUnitInfos {
+        using Response = GetUnitInfosResponse;
+
+        native_size_t instance_id;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(instance_id);
+        }
+    };
+
     /**
      * The response code and returned name for a call to
      * `IUnitInfo::getProgramName(list_id, program_index, &name)`.
@@ -213,6 +258,48 @@ class YaUnitInfo : public Steinberg::Vst::IUnitInfo {
                    int32 programIndex,
                    Steinberg::Vst::String128 name /*out*/) override = 0;
 
+    /**
+     * The names of all programs in a program list.
+     *
+     * @see GetProgramNames
+     */
+    struct GetProgramNamesResponse {
+        /**
+         * The results of `IUnitInfo::getProgramName()` for every program in
+         * the list, indexed by program index.
+         */
+        std::vector<GetProgramNameResponse> names;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.container(names, 1 << 16);
+        }
+    };
+
+    /**
+     * Call `IUnitInfo::getProgramName()` for every program in a program list at
+     * once. A sampler with a thousand programs would otherwise require a
+     * thousand round trips every time the host populates its preset menu.
+     */
+    struct GetProgramNames {
+        using Response = GetProgramNamesResponse;
+
+        native_size_t instance_id;
+
+        Steinberg::Vst::ProgramListID list_id;
+        /**
+         * The program count from the list's `ProgramListInfo`.
+         */
+        int32 num_programs;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(instance_id);
+            s.value4b(list_id);
+            s.value4b(num_programs);
+        }
+    };
+
     /**
      * The response code and returned value for a call to
      * `IUnitInfo::getPrograminfo(list_id, program_index, attribute_name,
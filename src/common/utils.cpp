@@ -16,6 +16,8 @@
 
 #include "utils.h"
 
+#include <fstream>
+#include <sstream>
 #include <stdlib.h>
 
 #include <sched.h>
@@ -85,6 +87,38 @@ std::optional<rlim_t> get_rttime_limit() noexcept {
     }
 }
 
+std::optional<MemoryUsage> get_memory_usage() noexcept {
+    try {
+        // These values are reported in kibibytes
+        std::ifstream status("/proc/self/status");
+        std::optional<size_t> resident_kib;
+        std::optional<size_t> peak_resident_kib;
+        for (std::string line; std::getline(status, line);) {
+            std::istringstream fields(line);
+            std::string key;
+            size_t value = 0;
+            if (!(fields >> key >> value)) {
+                continue;
+            }
+
+            if (key == "VmRSS:") {
+                resident_kib = value;
+            } else if (key == "VmHWM:") {
+                peak_resident_kib = value;
+            }
+        }
+
+        if (resident_kib && peak_resident_kib) {
+            return MemoryUsage{.resident_bytes = *resident_kib * 1024,
+                               .peak_resident_bytes = *peak_resident_kib * 1024};
+        } else {
+            return std::nullopt;
+        }
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
 bool is_watchdog_timer_disabled() {
     // This is safe because we're not storing the pointer anywhere and the
     // environment doesn't get modified anywhere
@@ -130,6 +130,21 @@ std::optional<rlim_t> get_memlock_limit() noexcept;
  */
 std::optional<rlim_t> get_rttime_limit() noexcept;
 
+/**
+ * The resident set size of this process and its high-water mark, as reported
+ * in `/proc/self/status`.
+ */
+struct MemoryUsage {
+    size_t resident_bytes;
+    size_t peak_resident_bytes;
+};
+
+/**
+ * Read this process's current and peak resident set size from
+ * `/proc/self/status`. Returns a nullopt if this information could not be read.
+ */
+std::optional<MemoryUsage> get_memory_usage() noexcept;
+
 /**
  * Returns `true` if `YABRIDGE_NO_WATCHDOG` is set to `1`. In that case we will
  * not check if the Wine plugin host process successfully started, and we'll
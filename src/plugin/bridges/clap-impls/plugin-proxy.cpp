@@ -149,6 +149,11 @@ clap_plugin_proxy::clap_plugin_proxy(ClapPluginBridge& bridge,
 void clap_plugin_proxy::clear_param_info_cache() {
     std::lock_guard lock(param_info_cache_mutex_);
     param_info_cache_.clear();
+    param_indices_.clear();
+}
+
+void clap_plugin_proxy::clear_param_value_cache() {
+    param_value_cache_.clear();
 }
 
 bool CLAP_ABI clap_plugin_proxy::plugin_init(const struct clap_plugin* plugin) {
@@ -313,6 +318,12 @@ clap_plugin_proxy::plugin_process(const struct clap_plugin* plugin,
     self->process_request_.process.write_back_outputs(*process,
                                                       *self->process_buffers_);
 
+    // Parameter values can only be changed through events in CLAP, so keeping
+    // track of these lets us answer `clap_plugin_params::get_value()` without
+    // asking the plugin
+    self->update_param_value_cache(self->process_request_.process.in_events_);
+    self->update_param_value_cache(self->process_request_.process.out_events_);
+
     return self->process_response_.result;
 }
 
@@ -765,14 +776,31 @@ clap_plugin_proxy::ext_params_get_value(const clap_plugin_t* plugin,
                                         clap_id param_id,
                                         double* value) {
     assert(plugin && plugin->plugin_data && value);
-    auto self = static_cast<const clap_plugin_proxy*>(plugin->plugin_data);
+    auto self = static_cast<clap_plugin_proxy*>(plugin->plugin_data);
 
+    // Hosts query this for every visible parameter when redrawing generic
+    // editors and automation lanes, so these values are cached
+    std::optional<double> cached_value =
+        self->param_value_cache_.value(param_id);
+    if (!cached_value) {
+        self->maybe_prefetch_parameters(param_id);
+        cached_value = self->param_value_cache_.value(param_id);
+    }
+    if (cached_value) {
+        *value = *cached_value;
+
+        return true;
+    }
+
+    const auto fetch = self->param_value_cache_.begin_fetch(param_id);
     const clap::ext::params::plugin::GetValueResponse response =
         self->bridge_.send_main_thread_message(
             clap::ext::params::plugin::GetValue{
                 .instance_id = self->instance_id(), .param_id = param_id});
     if (response.result) {
         *value = *response.result;
+        self->param_value_cache_.store_value(param_id, *response.result,
+                                             fetch);
 
         return true;
     } else {
@@ -787,8 +815,22 @@ clap_plugin_proxy::ext_params_value_to_text(const clap_plugin_t* plugin,
                                             char* display,
                                             uint32_t size) {
     assert(plugin && plugin->plugin_data && display);
-    auto self = static_cast<const clap_plugin_proxy*>(plugin->plugin_data);
+    auto self = static_cast<clap_plugin_proxy*>(plugin->plugin_data);
+
+    // See above
+    std::optional<std::string> cached_text =
+        self->param_value_cache_.text(param_id, value);
+    if (!cached_text) {
+        self->maybe_prefetch_parameters(param_id);
+        cached_text = self->param_value_cache_.text(param_id, value);
+    }
+    if (cached_text) {
+        strlcpy_buffer(display, *cached_text, size);
+
+        return true;
+    }
 
+    const auto fetch = self->param_value_cache_.begin_fetch(param_id);
     const clap::ext::params::plugin::ValueToTextResponse response =
         self->bridge_.send_main_thread_message(
             clap::ext::params::plugin::ValueToText{
@@ -797,6 +839,8 @@ clap_plugin_proxy::ext_params_value_to_text(const clap_plugin_t* plugin,
                 .value = value});
     if (response.result) {
         strlcpy_buffer(display, *response.result, size);
+        self->param_value_cache_.store_text(param_id, value, *response.result,
+                                            fetch);
 
         return true;
     } else {
@@ -832,13 +876,14 @@ clap_plugin_proxy::ext_params_flush(const clap_plugin_t* plugin,
                                     const clap_input_events_t* in,
                                     const clap_output_events_t* out) {
     assert(plugin && plugin->plugin_data && in && out);
-    auto self = static_cast<const clap_plugin_proxy*>(plugin->plugin_data);
+    auto self = static_cast<clap_plugin_proxy*>(plugin->plugin_data);
 
     // This will not allocate below 64 events. Since flush will primarily be
     // called on the main thread, we don't really care about minimizing
     // allocations beyond that point here.
     clap::events::EventList events{};
     events.repopulate(*in);
+    self->update_param_value_cache(events);
 
     // This may also be called on the audio thread and it is never called during
     // process, so always using the audio thread here is safe
@@ -848,6 +893,7 @@ clap_plugin_proxy::ext_params_flush(const clap_plugin_t* plugin,
                                              .in = std::move(events)});
 
     response.out.write_back_outputs(*out);
+    self->update_param_value_cache(response.out);
 }
 
 bool CLAP_ABI clap_plugin_proxy::ext_render_has_hard_realtime_requirement(
@@ -890,15 +936,22 @@ bool CLAP_ABI clap_plugin_proxy::ext_state_save(const clap_plugin_t* plugin,
 bool CLAP_ABI clap_plugin_proxy::ext_state_load(const clap_plugin_t* plugin,
                                                 const clap_istream_t* stream) {
     assert(plugin && plugin->plugin_data && stream);
-    auto self = static_cast<const clap_plugin_proxy*>(plugin->plugin_data);
+    auto self = static_cast<clap_plugin_proxy*>(plugin->plugin_data);
 
     // NOTE: We need to be able to handle mutual recursion here. DPF will call
     //       `clap_host_params::rescan()` during state loading, and that
     //       callback needs to be handled on the main thread. Other plugins may
     //       also do latency change calblacks in this function.
-    return self->bridge_.send_mutually_recursive_main_thread_message(
-        clap::ext::state::plugin::Load{.instance_id = self->instance_id(),
-                                       .stream = *stream});
+    const bool result =
+        self->bridge_.send_mutually_recursive_main_thread_message(
+            clap::ext::state::plugin::Load{.instance_id = self->instance_id(),
+                                           .stream = *stream});
+
+    // Loading a new state will change most if not all parameters, and not all
+    // plugins will ask the host to rescan their parameter values
+    self->param_value_cache_.clear();
+
+    return result;
 }
 
 uint32_t CLAP_ABI clap_plugin_proxy::ext_tail_get(const clap_plugin_t* plugin) {
@@ -927,6 +980,22 @@ bool CLAP_ABI clap_plugin_proxy::ext_voice_info_get(const clap_plugin_t* plugin,
     }
 }
 
+void clap_plugin_proxy::update_param_value_cache(
+    const clap::events::EventList& events) noexcept {
+    for (const auto& event : events) {
+        if (const auto* param_value =
+                std::get_if<clap::events::payload::ParamValue>(
+                    &event.payload)) {
+            const clap_event_param_value_t& param_event = param_value->event;
+            if (param_event.note_id == -1 && param_event.port_index == -1 &&
+                param_event.channel == -1 && param_event.key == -1) {
+                param_value_cache_.update_value(param_event.param_id,
+                                                param_event.value);
+            }
+        }
+    }
+}
+
 void clap_plugin_proxy::maybe_query_parameter_info() {
     std::lock_guard lock(param_info_cache_mutex_);
 
@@ -939,5 +1008,54 @@ void clap_plugin_proxy::maybe_query_parameter_info() {
                 clap::ext::params::plugin::GetInfos{.instance_id =
                                                         instance_id()});
         param_info_cache_ = std::move(response.infos);
+
+        param_indices_.clear();
+        for (size_t i = 0; i < param_info_cache_.size(); i++) {
+            if (const auto& info = param_info_cache_[i]) {
+                param_indices_[info->id] = i;
+            }
+        }
     }
 }
+
+void clap_plugin_proxy::maybe_prefetch_parameters(clap_id param_id) {
+    std::vector<clap_id> param_ids;
+    size_t end_index;
+    {
+        std::lock_guard lock(param_info_cache_mutex_);
+        const auto index_it = param_indices_.find(param_id);
+        if (index_it == param_indices_.end() ||
+            !param_prefetch_detector_.record_miss(index_it->second)) {
+            return;
+        }
+
+        end_index = std::min(index_it->second + parameter_prefetch_batch_size,
+                             param_info_cache_.size());
+        for (size_t i = index_it->second; i < end_index; i++) {
+            if (param_info_cache_[i]) {
+                param_ids.push_back(param_info_cache_[i]->id);
+            }
+        }
+    }
+
+    const auto fetch = param_value_cache_.begin_fetch(param_ids);
+    const clap::ext::params::plugin::GetValuesResponse response =
+        bridge_.send_main_thread_message(clap::ext::params::plugin::GetValues{
+            .instance_id = instance_id(), .param_ids = param_ids});
+
+    for (size_t i = 0; i < param_ids.size() && i < response.values.size();
+         i++) {
+        const clap::ext::params::plugin::ValueAndText& result =
+            response.values[i];
+        if (result.value) {
+            param_value_cache_.store_value(param_ids[i], *result.value,
+                                           fetch);
+            if (result.text) {
+                param_value_cache_.store_text(param_ids[i], *result.value,
+                                              *result.text, fetch);
+            }
+        }
+    }
+
+    param_prefetch_detector_.record_prefetch(end_index);
+}
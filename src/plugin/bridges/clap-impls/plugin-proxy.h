@@ -18,6 +18,7 @@
 
 #include <future>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <clap/ext/audio-ports-config.h>
@@ -38,6 +39,7 @@
 
 #include "../../common/serialization/clap/ext/params.h"
 #include "../../common/serialization/clap/plugin.h"
+#include "../../parameter-value-cache.h"
 
 // Forward declaration to avoid circular includes
 class ClapPluginBridge;
@@ -165,6 +167,15 @@ class clap_plugin_proxy {
      */
     void clear_param_info_cache();
 
+    /**
+     * Clear the cached parameter values and display strings. Needs to be
+     * called when the plugin calls `clap_host_params::rescan()` or
+     * `clap_host_params::clear()`.
+     *
+     * @see param_value_cache_
+     */
+    void clear_param_value_cache();
+
     /**
      * The `clap_host_t*` passed when creating the instance. Any callbacks made
      * by the proxied plugin instance must go through here.
@@ -314,6 +325,29 @@ class clap_plugin_proxy {
      */
     void maybe_query_parameter_info();
 
+    /**
+     * Update `param_value_cache_` with the values from the parameter value
+     * events in an event list. Polyphonic parameter value events are ignored
+     * since those don't change the value returned by
+     * `clap_plugin_params::get_value()`.
+     */
+    void update_param_value_cache(
+        const clap::events::EventList& events) noexcept;
+
+    /**
+     * Called after a cache miss in `param_value_cache_`. If the host seems to
+     * be querying the plugin's parameters one by one in order, then this
+     * fetches the values and display strings for the next
+     * `parameter_prefetch_batch_size` parameters starting at `param_id` in a
+     * single message and stores them in `param_value_cache_`. Every parameter
+     * is stored on its own, so a parameter changing during the round trip
+     * does not cause the rest of the batch to be discarded. This only works
+     * when the host has already queried the plugin's parameter information.
+     *
+     * @see param_prefetch_detector_
+     */
+    void maybe_prefetch_parameters(clap_id param_id);
+
     ClapPluginBridge& bridge_;
     size_t instance_id_;
     clap::plugin::Descriptor descriptor_;
@@ -402,5 +436,29 @@ class clap_plugin_proxy {
      * `false` when querying info for a parameter that should be in range.
      */
     std::vector<std::optional<clap::ext::params::ParamInfo>> param_info_cache_;
+    /**
+     * The index in `param_info_cache_` for every parameter ID. Populated and
+     * cleared together with `param_info_cache_`, and used to detect when the
+     * host is querying parameters in order.
+     */
+    std::unordered_map<clap_id, size_t> param_indices_;
     std::mutex param_info_cache_mutex_;
+
+    /**
+     * Caches the results of `clap_plugin_params::get_value()` and
+     * `clap_plugin_params::value_to_text()`. Values are updated from the
+     * parameter value events sent to and received from the plugin during
+     * audio processing and when flushing parameters, and the entire cache is
+     * cleared when the plugin asks the host to rescan or clear its parameters
+     * or when its state gets restored.
+     */
+    ParameterValueCache<std::string> param_value_cache_;
+
+    /**
+     * Used to detect when the host queries parameter values or display strings
+     * one by one in order, so we can prefetch them in batches.
+     *
+     * @see maybe_prefetch_parameters
+     */
+    SequentialAccessDetector param_prefetch_detector_;
 };
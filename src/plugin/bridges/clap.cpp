@@ -52,6 +52,7 @@ ClapPluginBridge::ClapPluginBridge(const ghc::filesystem::path& plugin_path)
                 [&](const WantsConfiguration& request)
                     -> WantsConfiguration::Response {
                     warn_on_version_mismatch(request.host_version);
+                    negotiate_compression(request.host_supports_compression);
 
                     return config_;
                 },
@@ -257,6 +258,7 @@ ClapPluginBridge::ClapPluginBridge(const ghc::filesystem::path& plugin_path)
                             // Parameter information is cached and fetched in
                             // bulk as an optimization
                             plugin_proxy->clear_param_info_cache();
+                            plugin_proxy->clear_param_value_cache();
 
                             params->rescan(host, request.flags);
                         })
@@ -269,6 +271,8 @@ ClapPluginBridge::ClapPluginBridge(const ghc::filesystem::path& plugin_path)
                     const auto& [plugin_proxy, _] =
                         get_proxy(request.owner_instance_id);
 
+                    plugin_proxy.clear_param_value_cache();
+
                     run_on_main_thread(
                         plugin_proxy,
                         [&, host = plugin_proxy.host_,
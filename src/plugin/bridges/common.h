@@ -25,6 +25,8 @@
 #include <config.h>
 #include <version.h>
 
+#include "../../common/buffer-pool.h"
+#include "../../common/compression.h"
 #include "../../common/configuration.h"
 #include "../../common/linking.h"
 #include "../../common/notifications.h"
@@ -101,7 +103,9 @@ class PluginBridge {
                             .plugin_type = plugin_type,
                             .plugin_path = info_.windows_plugin_path_.string(),
                             .endpoint_base_dir = sockets_.base_dir_.string(),
-                            .parent_pid = getpid()}))
+                            .parent_pid = getpid(),
+                            .dedicated_gui_thread =
+                                config_.group_dedicated_gui_thread}))
                   : std::unique_ptr<HostProcess>(
                         std::make_unique<IndividualHost>(
                             io_context_,
@@ -127,9 +131,25 @@ class PluginBridge {
               pthread_setname_np(pthread_self(), "wine-stdio");
 
               io_context_.run();
-          }) {}
+          }) {
+        // The buffer pool is shared by all instances of this plugin library
+        SerializationBufferPool::global().limit_idle_timeout(
+            config_.buffer_idle_timeout_duration());
+    }
 
-    virtual ~PluginBridge() noexcept = default;
+    virtual ~PluginBridge() noexcept {
+        // If large messages were compressed, then we'll print some statistics
+        // so it's possible to tell whether the option is actually worth it
+        try {
+            if (const std::string statistics =
+                    sockets_.compression_statistics_.format();
+                !statistics.empty()) {
+                generic_logger_.log("Compression: " + statistics);
+            }
+        } catch (...) {
+            // Don't let logging failures escape the destructor
+        }
+    }
 
    protected:
     /**
@@ -284,6 +304,15 @@ class PluginBridge {
 
         init_msg << "other options: ";
         std::vector<std::string> other_options;
+        if (config_.buffer_idle_timeout) {
+            std::ostringstream option;
+            option << "buffer idle timeout: " << *config_.buffer_idle_timeout
+                   << " s";
+            other_options.push_back(option.str());
+        }
+        if (config_.compress_large_messages) {
+            other_options.push_back("compress large messages");
+        }
         if (config_.disable_pipes) {
             other_options.push_back(
                 "hack: pipes disabled, plugin output will go to \"" +
@@ -298,6 +327,18 @@ class PluginBridge {
         if (config_.editor_force_dnd) {
             other_options.push_back("editor: force drag-and-drop");
         }
+        if (config_.editor_hidden_frame_rate) {
+            std::ostringstream option;
+            option << "editor: hidden frame rate: " << std::setprecision(2)
+                   << *config_.editor_hidden_frame_rate << " fps";
+            other_options.push_back(option.str());
+        }
+        if (config_.editor_max_frame_rate) {
+            std::ostringstream option;
+            option << "editor: max frame rate: " << std::setprecision(2)
+                   << *config_.editor_max_frame_rate << " fps";
+            other_options.push_back(option.str());
+        }
         if (config_.editor_xembed) {
             other_options.push_back("editor: XEmbed");
         }
@@ -307,9 +348,24 @@ class PluginBridge {
                    << *config_.frame_rate << " fps";
             other_options.push_back(option.str());
         }
+        if (config_.group_dedicated_gui_thread) {
+            other_options.push_back("group: dedicated GUI thread");
+        }
+        if (config_.gui_stall_threshold) {
+            std::ostringstream option;
+            option << "GUI stall threshold: " << *config_.gui_stall_threshold
+                   << " ms";
+            other_options.push_back(option.str());
+        }
         if (config_.hide_daw) {
             other_options.push_back("hack: hide DAW name");
         }
+        if (config_.parallel_state_restore) {
+            other_options.push_back("state: parallel restore");
+        }
+        if (config_.vst2_disable_param_mirror) {
+            other_options.push_back("vst2: no parameter mirror");
+        }
         if (config_.vst3_prefer_32bit) {
             other_options.push_back("vst3: prefer 32-bit");
         }
@@ -361,7 +417,7 @@ class PluginBridge {
     }
 
     /**
-     * Connect the sockets, while starting another thread that will terminate
+     * Connect the sockets, while watching the host process so we can terminate
      * the plugin (through `std::terminate`/SIGABRT) when the host process fails
      * to start. This is the only way to stop listening on our sockets without
      * moving everything over to asynchronous listeners (which may actually be a
@@ -374,43 +430,31 @@ class PluginBridge {
 #ifndef WITH_WINEDBG
         // If the Wine process fails to start, then nothing will connect to the
         // sockets and we'll be hanging here indefinitely. To prevent this,
-        // we'll periodically poll whether the Wine process is still running,
-        // and throw when it is not. The alternative would be to rewrite this to
-        // using `async_accept`, Asio timers, and another IO context, but
-        // I feel like this a much simpler solution.
-        host_watchdog_handler_ = std::jthread([&](std::stop_token st) {
-            using namespace std::literals::chrono_literals;
-
-            pthread_setname_np(pthread_self(), "watchdog");
-
-            while (!st.stop_requested()) {
-                if (!plugin_host_->running()) {
-                    generic_logger_.log(
-                        "The Wine host process has exited unexpectedly. Check "
-                        "the output above for more information.");
-
-                    // Also show a desktop notification so users running from
-                    // the GUI get a heads up
-                    send_notification(
-                        "Failed to start the Wine plugin host",
-                        "Check yabridge's output for more information on what "
-                        "went wrong. You may need to rerun your DAW from a "
-                        "terminal and restart the plugin scanning process to "
-                        "see the error.",
-                        info_.native_library_path_);
-
-                    std::terminate();
-                }
-
-                std::this_thread::sleep_for(20ms);
-            }
-        });
+        // we'll register the Wine process with the watchdog shared by all
+        // plugin instances, and throw when it exits before we're connected.
+        // This used to be a thread per instance that polled the process every
+        // 20 milliseconds, which adds up when loading a project with hundreds
+        // of plugins.
+        ProcessWatchdog::Guard host_watchdog_guard =
+            plugin_host_->watch([&]() {
+                generic_logger_.log(
+                    "The Wine host process has exited unexpectedly. Check the "
+                    "output above for more information.");
+
+                // Also show a desktop notification so users running from the
+                // GUI get a heads up
+                send_notification(
+                    "Failed to start the Wine plugin host",
+                    "Check yabridge's output for more information on what went "
+                    "wrong. You may need to rerun your DAW from a terminal and "
+                    "restart the plugin scanning process to see the error.",
+                    info_.native_library_path_);
+
+                std::terminate();
+            });
 #endif
 
         sockets_.connect();
-#ifndef WITH_WINEDBG
-        host_watchdog_handler_.request_stop();
-#endif
     }
 
     /**
@@ -438,6 +482,36 @@ class PluginBridge {
         }
     }
 
+    /**
+     * Decide whether large messages should be compressed based on the
+     * `compress_large_messages` option and on whether both sides can load LZ4.
+     * If compression gets enabled, then this will also enable it for our end of
+     * the sockets. This should be called during the handshake, right before
+     * sending `config_` to the Wine plugin host. The host will then enable
+     * compression for its end of the sockets based on the same option.
+     *
+     * @param host_supports_compression Whether the Wine plugin host was able to
+     *   load LZ4.
+     */
+    void negotiate_compression(bool host_supports_compression) {
+        if (!config_.compress_large_messages) {
+            return;
+        }
+
+        if (host_supports_compression && is_compression_available()) {
+            sockets_.enable_compression();
+        } else {
+            config_.compress_large_messages = false;
+            generic_logger_.log(
+                "WARNING: 'compress_large_messages' is enabled, but LZ4 could "
+                "not be loaded");
+            generic_logger_.log(
+                "         by either the plugin or the Wine plugin host. "
+                "Messages will not be");
+            generic_logger_.log("         compressed.");
+        }
+    }
+
     /**
      * The configuration for this instance of yabridge. Set based on the values
      * from a `yabridge.toml`, if it exists.
@@ -499,14 +573,4 @@ class PluginBridge {
      * STDOUT and STDERR messages.
      */
     std::jthread wine_io_handler_;
-
-   private:
-    /**
-     * A thread used during the initialisation process to terminate listening on
-     * the sockets if the Wine process cannot start for whatever reason. This
-     * has to be defined here instead of in the constructor we can't simply
-     * detach the thread as it has to check whether the VST host is still
-     * running.
-     */
-    std::jthread host_watchdog_handler_;
 };
@@ -52,6 +52,7 @@ Vst2PluginBridge::Vst2PluginBridge(const ghc::filesystem::path& plugin_path,
       // `Vst2PluginInstance::vstAudioMasterCallback` from Bitwig's plugin
       // bridge will crash otherwise
       plugin_(),
+      queued_parameter_changes_(max_queued_parameter_changes),
       host_callback_function_(host_callback),
       logger_(generic_logger_) {
     log_init_message();
@@ -185,11 +186,26 @@ Vst2PluginBridge::Vst2PluginBridge(const ghc::filesystem::path& plugin_path,
     const auto host_version =
         std::get<std::string>(*initialization_data.value_payload);
     warn_on_version_mismatch(host_version);
+    negotiate_compression(initialization_data.return_value != 0);
 
     // After receiving the `AEffect` values we'll want to send the configuration
     // back to complete the startup process
     sockets_.host_plugin_control_.send(config_);
 
+    // The Wine plugin host creates this table before sending the `AEffect`
+    // struct, so it should already exist at this point
+    if (!config_.vst2_disable_param_mirror) {
+        try {
+            parameter_mirror_.emplace(
+                ParameterMirror::open(sockets_.parameter_mirror_name()));
+        } catch (const std::exception& error) {
+            generic_logger_.log(
+                "Could not connect to the shared parameter table, falling "
+                "back to querying parameters over the socket: " +
+                std::string(error.what()));
+        }
+    }
+
     update_aeffect(plugin_, initialized_plugin);
 }
 
@@ -211,7 +227,7 @@ Vst2PluginBridge::~Vst2PluginBridge() noexcept {
 class DispatchDataConverter : public DefaultDataConverter {
    public:
     DispatchDataConverter(std::optional<AudioShmBuffer>& process_buffers,
-                          std::vector<uint8_t>& chunk_data,
+                          BinaryBuffer& chunk_data,
                           AEffect& plugin,
                           VstRect& editor_rectangle) noexcept
         : process_buffers_(process_buffers),
@@ -262,9 +278,10 @@ class DispatchDataConverter : public DefaultDataConverter {
                 const uint8_t* chunk_data = static_cast<const uint8_t*>(data);
 
                 // When the host passes a chunk it will use the value parameter
-                // to tell us its length
-                return ChunkData{
-                    std::vector<uint8_t>(chunk_data, chunk_data + value)};
+                // to tell us its length. The chunk gets sent before this
+                // function returns, so we don't need to copy it.
+                return ChunkData{BinaryBuffer::borrow(
+                    chunk_data, static_cast<size_t>(value))};
             } break;
             case effBeginLoadBank:
             case effBeginLoadProgram:
@@ -412,12 +429,12 @@ class DispatchDataConverter : public DefaultDataConverter {
             case effGetChunk: {
                 // Write the chunk data to some publically accessible place in
                 // `Vst2PluginBridge` and write a pointer to that struct to the
-                // data pointer
-                const auto& buffer =
-                    std::get<ChunkData>(response.payload).buffer;
-                chunk_.assign(buffer.begin(), buffer.end());
+                // data pointer. If the chunk was sent through a memfd then
+                // this will simply keep the mapping alive.
+                chunk_ = std::get<ChunkData>(response.payload).buffer;
 
-                *static_cast<uint8_t**>(data) = chunk_.data();
+                *static_cast<uint8_t**>(data) =
+                    const_cast<uint8_t*>(chunk_.data());
             } break;
             case effGetInputProperties:
             case effGetOutputProperties: {
@@ -501,7 +518,7 @@ class DispatchDataConverter : public DefaultDataConverter {
 
    private:
     std::optional<AudioShmBuffer>& process_buffers_;
-    std::vector<uint8_t>& chunk_;
+    BinaryBuffer& chunk_;
     AEffect& plugin_;
     VstRect& rect_;
 };
@@ -529,6 +546,22 @@ intptr_t Vst2PluginBridge::dispatch(AEffect* /*plugin*/,
         return 0;
     }
 
+    // Parameter changes made on the audio thread are normally sent along with
+    // the next processing call. Any request made from another thread should
+    // not be able to overtake those changes, so they're applied first. Events
+    // dispatched from the audio thread itself, like `effProcessEvents()`, are
+    // also only handled during the next processing call.
+    if (!is_audio_thread() && !queued_parameter_changes_.empty()) {
+        std::lock_guard lock(parameters_mutex_);
+        flush_queued_parameter_changes();
+    }
+
+    // Changes queued after this point will be flushed by the next synchronous
+    // request
+    if (opcode == effMainsChanged && value == 0) {
+        audio_thread_id_.store(std::thread::id(), std::memory_order_relaxed);
+    }
+
     DispatchDataConverter converter(process_buffers_, chunk_data_, plugin_,
                                     editor_rectangle_);
 
@@ -629,6 +662,16 @@ void Vst2PluginBridge::do_process(T** inputs, T** outputs, int sample_frames) {
     // and we'll then send this request alongside it with additional information
     // needed to process audio
     Vst2ProcessRequest request{};
+    audio_thread_id_.store(std::this_thread::get_id(),
+                           std::memory_order_relaxed);
+
+    // Parameter changes the host made from this thread since the last
+    // processing cycle will be applied by the Wine plugin host right before
+    // processing this buffer
+    Vst2ParameterChange parameter_change;
+    while (queued_parameter_changes_.try_pop(parameter_change)) {
+        request.parameter_changes.push_back(parameter_change);
+    }
 
     // To prevent unnecessary bridging overhead, we'll send the time information
     // together with the buffers because basically every plugin needs this
@@ -770,6 +813,17 @@ void Vst2PluginBridge::process_double_replacing(AEffect* /*plugin*/,
 float Vst2PluginBridge::get_parameter(AEffect* /*plugin*/, int index) {
     logger_.log_get_parameter(index);
 
+    // Hosts may poll every parameter many times per second, so we'll try to
+    // read the value from the shared parameter table first. This returns a
+    // nullopt until the plugin has been initialized.
+    if (parameter_mirror_) {
+        if (const std::optional<float> value = parameter_mirror_->read(index)) {
+            logger_.log_get_parameter_response(*value, true);
+
+            return *value;
+        }
+    }
+
     const Parameter request{index, std::nullopt};
     ParameterResult response;
 
@@ -777,6 +831,8 @@ float Vst2PluginBridge::get_parameter(AEffect* /*plugin*/, int index) {
     // called at the same time since  they share the same socket
     {
         std::lock_guard lock(parameters_mutex_);
+        flush_queued_parameter_changes();
+
         sockets_.host_plugin_parameters_.send(request);
 
         response =
@@ -793,11 +849,26 @@ void Vst2PluginBridge::set_parameter(AEffect* /*plugin*/,
                                      float value) {
     logger_.log_set_parameter(index, value);
 
+    // Automation is applied from the audio thread, and waiting for the Wine
+    // plugin host there would add a round trip for every automated parameter.
+    // These changes are sent along with the next processing call instead.
+    if (is_audio_thread() &&
+        queued_parameter_changes_.try_push(Vst2ParameterChange{index, value})) {
+        logger_.log_set_parameter_response();
+        return;
+    }
+
     const Parameter request{index, value};
     ParameterResult response;
 
     {
         std::lock_guard lock(parameters_mutex_);
+
+        // If the queue was full or if this is called from another thread,
+        // then the queued changes need to be applied first to keep the
+        // parameter changes in order
+        flush_queued_parameter_changes();
+
         sockets_.host_plugin_parameters_.send(request);
 
         response =
@@ -810,6 +881,20 @@ void Vst2PluginBridge::set_parameter(AEffect* /*plugin*/,
     assert(!response.value);
 }
 
+void Vst2PluginBridge::flush_queued_parameter_changes() {
+    Vst2ParameterChange parameter_change;
+    while (queued_parameter_changes_.try_pop(parameter_change)) {
+        sockets_.host_plugin_parameters_.send(
+            Parameter{parameter_change.index, parameter_change.value});
+        sockets_.host_plugin_parameters_.receive_single<ParameterResult>();
+    }
+}
+
+bool Vst2PluginBridge::is_audio_thread() const noexcept {
+    return std::this_thread::get_id() ==
+           audio_thread_id_.load(std::memory_order_relaxed);
+}
+
 // The below functions are proxy functions for the methods defined in
 // `Bridge.cpp`
 
@@ -16,13 +16,16 @@
 
 #pragma once
 
+#include <rigtorp/MPMCQueue.h>
 #include <vestige/aeffectx.h>
 
 #include <asio/io_context.hpp>
+#include <atomic>
 #include <thread>
 
 #include "../../common/communication/vst2.h"
 #include "../../common/logging/vst2.h"
+#include "../../common/parameter-mirror.h"
 #include "common.h"
 
 /**
@@ -109,6 +112,21 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
     float get_parameter(AEffect* plugin, int index);
     void set_parameter(AEffect* plugin, int index, float value);
 
+    /**
+     * Send all queued audio thread parameter changes to the Wine plugin host
+     * using synchronous `setParameter()` calls. This is done before every
+     * other synchronous request so those requests can't overtake the queued
+     * parameter changes. `parameters_mutex_` should be locked when calling
+     * this.
+     */
+    void flush_queued_parameter_changes();
+
+    /**
+     * Whether this function is being called from the thread the host last
+     * processed audio on for this plugin instance.
+     */
+    bool is_audio_thread() const noexcept;
+
     /**
      * Process audio and handle plugin-generated MIDI events afterwards.
      *
@@ -148,6 +166,30 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
      */
     std::mutex parameters_mutex_;
 
+    /**
+     * The thread the host last called `do_process()` from for this plugin
+     * instance. This is reset when the host suspends the plugin.
+     */
+    std::atomic<std::thread::id> audio_thread_id_;
+
+    /**
+     * `setParameter()` calls made from the host's audio thread, i.e. from
+     * within `do_process()` or from `audio_thread_id_`. Doing a blocking round
+     * trip to the Wine plugin host for every one of those would add to the
+     * audio thread's latency for every automated parameter, so instead we'll
+     * append them to this queue and send them along with the next
+     * `Vst2ProcessRequest`. The Wine plugin host then applies them in order
+     * right before processing audio. Since the host already expects these
+     * changes to take effect on the next processing cycle, this does not change
+     * any observable behavior except for `getParameter()` possibly returning
+     * the old value until then.
+     *
+     * If this queue is full, then we'll flush it over `host_plugin_parameters_`
+     * and fall back to the synchronous path. The same happens before any other
+     * synchronous request made from outside of the audio thread.
+     */
+    rigtorp::MPMCQueue<Vst2ParameterChange> queued_parameter_changes_;
+
     /**
      * The callback function passed by the host to the VST plugin instance.
      */
@@ -173,6 +215,17 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
      */
     std::optional<AudioShmBuffer> process_buffers_;
 
+    /**
+     * The shared memory table containing the plugin's current parameter values,
+     * maintained by the Wine plugin host. `getParameter()` calls are answered
+     * from this table when possible, and only fall back to a round trip over
+     * `host_plugin_parameters_` when the table has not been populated yet or
+     * when the index is not in the table. This will be a nullopt when the
+     * `vst2_disable_param_mirror` option is enabled or when we could not
+     * connect to the table.
+     */
+    std::optional<ParameterMirror> parameter_mirror_;
+
     /**
      * We'll periodically synchronize the Wine host's audio thread priority with
      * that of the host. Since the overhead from doing so does add up, we'll
@@ -183,10 +236,11 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
     /**
      * The VST host can query a plugin for arbitrary binary data such as
      * presets. It will expect the plugin to write back a pointer that points to
-     * that data. This vector is where we store the chunk data for the last
-     * `effGetChunk` event.
+     * that data. This buffer is where we store the chunk data for the last
+     * `effGetChunk` event. For large chunks this holds on to the memfd mapping
+     * we received from the Wine plugin host.
      */
-    std::vector<uint8_t> chunk_data_;
+    BinaryBuffer chunk_data_;
     /**
      * The VST host will expect to be returned a pointer to a struct that stores
      * the dimensions of the editor window.
@@ -16,6 +16,11 @@
 
 #include "plugin-proxy.h"
 
+#include <algorithm>
+#include <bit>
+#include <iomanip>
+#include <sstream>
+
 #include <pluginterfaces/vst/ivstmidicontrollers.h>
 
 #include "plug-view-proxy.h"
@@ -41,6 +46,90 @@ Vst3PluginProxyImpl::ContextMenu::ContextMenu(
     Steinberg::IPtr<Steinberg::Vst::IContextMenu> menu)
     : menu(menu) {}
 
+namespace {
+constexpr uint32_t cache_bit(Vst3PluginProxyImpl::CachedData cache) {
+    return 1u << cache;
+}
+
+constexpr uint32_t all_caches =
+    cache_bit(Vst3PluginProxyImpl::num_caches) - 1;
+
+/**
+ * The caches that need to be cleared for each of the
+ * `IComponentHandler::restartComponent()` flags. `kReloadComponent` and any
+ * flags not listed here clear everything. Latency, prefetchable support and
+ * routing information are never cached, so those flags don't clear anything.
+ */
+constexpr std::array<std::pair<int32, uint32_t>, 10> restart_flag_caches{{
+    {Steinberg::Vst::kIoChanged,
+     cache_bit(Vst3PluginProxyImpl::bus_info_cache) |
+         cache_bit(Vst3PluginProxyImpl::midi_mapping_cache) |
+         cache_bit(Vst3PluginProxyImpl::keyswitch_cache) |
+         cache_bit(Vst3PluginProxyImpl::note_expression_cache)},
+    // Display strings can change along with the values, for instance when a
+    // plugin switches a parameter's unit or syncs it to the host's tempo
+    {Steinberg::Vst::kParamValuesChanged,
+     cache_bit(Vst3PluginProxyImpl::parameter_value_cache) |
+         cache_bit(Vst3PluginProxyImpl::parameter_string_cache)},
+    {Steinberg::Vst::kLatencyChanged, 0},
+    {Steinberg::Vst::kParamTitlesChanged,
+     cache_bit(Vst3PluginProxyImpl::parameter_info_cache) |
+         cache_bit(Vst3PluginProxyImpl::parameter_value_cache) |
+         cache_bit(Vst3PluginProxyImpl::parameter_string_cache) |
+         cache_bit(Vst3PluginProxyImpl::unit_info_cache) |
+         cache_bit(Vst3PluginProxyImpl::program_name_cache) |
+         cache_bit(Vst3PluginProxyImpl::program_info_cache)},
+    {Steinberg::Vst::kMidiCCAssignmentChanged,
+     cache_bit(Vst3PluginProxyImpl::midi_mapping_cache)},
+    {Steinberg::Vst::kNoteExpressionChanged,
+     cache_bit(Vst3PluginProxyImpl::note_expression_cache)},
+    {Steinberg::Vst::kIoTitlesChanged,
+     cache_bit(Vst3PluginProxyImpl::bus_info_cache)},
+    {Steinberg::Vst::kPrefetchableSupportChanged, 0},
+    {Steinberg::Vst::kRoutingInfoChanged, 0},
+    {Steinberg::Vst::kKeyswitchChanged,
+     cache_bit(Vst3PluginProxyImpl::keyswitch_cache)},
+}};
+
+/**
+ * Translate `IComponentHandler::restartComponent()` flags to a bit set of
+ * caches that should be cleared using `cache_bit()`.
+ */
+constexpr uint32_t invalidated_caches(int32 restart_flags) {
+    if (restart_flags & Steinberg::Vst::kReloadComponent) {
+        return all_caches;
+    }
+
+    uint32_t caches = 0;
+    for (const auto& [flag, flag_caches] : restart_flag_caches) {
+        if (restart_flags & flag) {
+            caches |= flag_caches;
+            restart_flags &= ~flag;
+        }
+    }
+
+    // Anything left over is a flag from a newer SDK that we don't know about
+    return restart_flags == 0 ? caches : all_caches;
+}
+
+/**
+ * Names for the caches in `Vst3PluginProxyImpl::CacheStatistics::format()`.
+ */
+constexpr const char* cache_names[Vst3PluginProxyImpl::num_caches] = {
+    "bus info",
+    "sample sizes",
+    "parameter info",
+    "parameter values",
+    "parameter strings",
+    "MIDI mappings",
+    "unit info",
+    "program names",
+    "program info",
+    "keyswitches",
+    "note expressions",
+};
+}  // namespace
+
 Vst3PluginProxyImpl::Vst3PluginProxyImpl(Vst3PluginBridge& bridge,
                                          Vst3PluginProxy::ConstructArgs&& args)
     : Vst3PluginProxy(std::move(args)), bridge_(bridge) {
@@ -54,6 +143,13 @@ Vst3PluginProxyImpl::~Vst3PluginProxyImpl() noexcept {
     bridge_.send_message(
         Vst3PluginProxy::Destruct{.instance_id = instance_id()});
     bridge_.unregister_plugin_proxy(*this);
+
+    bridge_.logger_.log_trace([&]() {
+        const std::string statistics = cache_statistics_.format();
+        return "Cache statistics for instance " +
+               std::to_string(instance_id()) + ": " +
+               (statistics.empty() ? "unused" : statistics);
+    });
 }
 
 tresult PLUGIN_API
@@ -85,11 +181,102 @@ bool Vst3PluginProxyImpl::unregister_context_menu(size_t context_menu_id) {
     return context_menus_.erase(context_menu_id);
 }
 
-void Vst3PluginProxyImpl::clear_caches() noexcept {
-    clear_bus_cache();
+std::string Vst3PluginProxyImpl::CacheStatistics::format() const {
+    std::ostringstream message;
+    message << std::fixed << std::setprecision(1);
+    for (size_t cache = 0; cache < num_caches; cache++) {
+        const uint64_t num_hits = hits[cache].load();
+        const uint64_t num_misses = misses[cache].load();
+        if (num_hits == 0 && num_misses == 0) {
+            continue;
+        }
+
+        if (message.tellp() > 0) {
+            message << ", ";
+        }
+        message << cache_names[cache] << " " << num_hits << "/"
+                << (num_hits + num_misses) << " hits ("
+                << (static_cast<double>(num_hits) * 100.0 /
+                    static_cast<double>(num_hits + num_misses))
+                << "%)";
+    }
+
+    if (message.tellp() == 0) {
+        return "";
+    }
+
+    message << ", " << invalidations.load() << " invalidations from "
+            << restarts.load() << " component restarts";
+
+    return message.str();
+}
+
+void Vst3PluginProxyImpl::clear_caches(int32 restart_flags) noexcept {
+    const uint32_t caches = invalidated_caches(restart_flags);
+    const auto should_clear = [&](CachedData cache) {
+        return (caches & cache_bit(cache)) != 0;
+    };
+
+    cache_statistics_.restarts.fetch_add(1, std::memory_order_relaxed);
+    cache_statistics_.invalidations.fetch_add(std::popcount(caches),
+                                              std::memory_order_relaxed);
+
+    if (should_clear(bus_info_cache)) {
+        clear_bus_cache();
+    }
+    if (should_clear(parameter_value_cache) ||
+        should_clear(parameter_string_cache)) {
+        parameter_value_cache_.clear();
+    }
+
+    std::lock_guard lock(function_result_cache_mutex_);
+    if (should_clear(sample_size_cache)) {
+        function_result_cache_.can_process_sample_size.clear();
+    }
+    if (should_clear(parameter_info_cache)) {
+        function_result_cache_.parameter_info.clear();
+        function_result_cache_.parameter_indices.clear();
+    }
+    if (should_clear(midi_mapping_cache)) {
+        function_result_cache_.midi_controller_assignments.clear();
+    }
+    if (should_clear(unit_info_cache) || should_clear(program_name_cache) ||
+        should_clear(program_info_cache)) {
+        function_result_cache_.unit_infos.reset();
+        function_result_cache_.program_names.clear();
+        function_result_cache_.program_infos.clear();
+        program_cache_generation_++;
+    }
+    if (should_clear(keyswitch_cache)) {
+        function_result_cache_.keyswitch_infos.clear();
+    }
+    if (should_clear(note_expression_cache)) {
+        function_result_cache_.note_expression_infos.clear();
+    }
+}
 
+void Vst3PluginProxyImpl::clear_program_list_cache(
+    Steinberg::Vst::ProgramListID list_id,
+    int32 program_index) noexcept {
     std::lock_guard lock(function_result_cache_mutex_);
-    function_result_cache_ = FunctionResultCache{};
+    program_cache_generation_++;
+
+    // The names are fetched per list, so those always need to be refetched
+    function_result_cache_.program_names.erase(list_id);
+    if (program_index < 0) {
+        // The list's program count may have changed
+        function_result_cache_.unit_infos.reset();
+        std::erase_if(function_result_cache_.program_infos,
+                      [&](const auto& entry) {
+                          return std::get<0>(entry.first) == list_id;
+                      });
+    } else {
+        std::erase_if(function_result_cache_.program_infos,
+                      [&](const auto& entry) {
+                          return std::get<0>(entry.first) == list_id &&
+                                 std::get<1>(entry.first) == program_index;
+                      });
+    }
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::setAudioPresentationLatencySamples(
@@ -110,6 +297,7 @@ tresult PLUGIN_API Vst3PluginProxyImpl::setBusArrangements(
     Steinberg::Vst::SpeakerArrangement* outputs,
     int32 numOuts) {
     clear_bus_cache();
+    flush_bus_activations();
 
     // NOTE: Ardour passes a null pointer when `numIns` or `numOuts` is 0, so we
     //       need to work around that
@@ -133,10 +321,34 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getBusArrangement(
     Steinberg::Vst::BusDirection dir,
     int32 index,
     Steinberg::Vst::SpeakerArrangement& arr) {
+    const auto request = YaAudioProcessor::GetBusArrangement{
+        .instance_id = instance_id(), .dir = dir, .index = index};
+
+    // The arrangements are fetched together with the bus information, which is
+    // part of `IComponent`
+    if (YaComponent::supported()) {
+        const auto topology = maybe_query_bus_topology();
+        if (const auto busses = topology->busses(Steinberg::Vst::kAudio, dir);
+            busses && index >= 0 &&
+            static_cast<size_t>(index) < busses->size()) {
+            const BusTopologyEntry& entry = (*busses)[index];
+            const GetBusArrangementResponse response{
+                .result = entry.arrangement_result, .arr = entry.arrangement};
+
+            const bool log_response =
+                bridge_.logger_.log_request(true, request);
+            if (log_response) {
+                bridge_.logger_.log_response(false, response, true);
+            }
+
+            arr = response.arr;
+
+            return response.result;
+        }
+    }
+
     const GetBusArrangementResponse response =
-        bridge_.send_audio_processor_message(
-            YaAudioProcessor::GetBusArrangement{
-                .instance_id = instance_id(), .dir = dir, .index = index});
+        bridge_.send_audio_processor_message(request);
 
     arr = response.arr;
 
@@ -164,10 +376,13 @@ Vst3PluginProxyImpl::canProcessSampleSize(int32 symbolicSampleSize) {
                     true);
             }
 
+            cache_statistics_.record(sample_size_cache, true);
             return it->second;
         }
     }
 
+    cache_statistics_.record(sample_size_cache, false);
+
     const tresult result = bridge_.send_audio_processor_message(request);
 
     {
@@ -180,31 +395,23 @@ Vst3PluginProxyImpl::canProcessSampleSize(int32 symbolicSampleSize) {
 }
 
 uint32 PLUGIN_API Vst3PluginProxyImpl::getLatencySamples() {
+    flush_bus_activations();
+
     return bridge_.send_audio_processor_message(
         YaAudioProcessor::GetLatencySamples{.instance_id = instance_id()});
 }
 
 tresult PLUGIN_API
 Vst3PluginProxyImpl::setupProcessing(Steinberg::Vst::ProcessSetup& setup) {
+    flush_bus_activations();
+
     return bridge_.send_audio_processor_message(
         YaAudioProcessor::SetupProcessing{.instance_id = instance_id(),
                                           .setup = setup});
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::setProcessing(TBool state) {
-    // REAPER used to repeatedly query the plugin for its bus information on
-    // every processing cycle. Because this really adds up in terms of latency
-    // we sadly have to deviate from yabridge's principles and implement a
-    // cache. We keep this in because it can still help performance a little in
-    // some DAWs.
-    {
-        std::lock_guard lock(processing_bus_cache_mutex_);
-        if (state) {
-            processing_bus_cache_.emplace();
-        } else {
-            processing_bus_cache_.reset();
-        }
-    }
+    flush_bus_activations();
 
     return bridge_.send_audio_processor_message(YaAudioProcessor::SetProcessing{
         .instance_id = instance_id(), .state = state});
@@ -256,6 +463,29 @@ Vst3PluginProxyImpl::process(Steinberg::Vst::ProcessData& data) {
     // changes and events
     process_request_.data.write_back_outputs(data, *process_buffers_);
 
+    // The last point for every output parameter queue is the parameter's new
+    // value, which saves the host a round trip when it then asks for that
+    // parameter's value
+    if (data.outputParameterChanges) {
+        const int32 num_changed_parameters =
+            data.outputParameterChanges->getParameterCount();
+        for (int32 i = 0; i < num_changed_parameters; i++) {
+            Steinberg::Vst::IParamValueQueue* queue =
+                data.outputParameterChanges->getParameterData(i);
+            if (!queue || queue->getPointCount() <= 0) {
+                continue;
+            }
+
+            int32 sample_offset;
+            Steinberg::Vst::ParamValue value;
+            if (queue->getPoint(queue->getPointCount() - 1, sample_offset,
+                                value) == Steinberg::kResultOk) {
+                parameter_value_cache_.update_value(queue->getParameterId(),
+                                                    value);
+            }
+        }
+    }
+
     return process_response_.result;
 }
 
@@ -290,6 +520,8 @@ Vst3PluginProxyImpl::getControllerClassId(Steinberg::TUID classId) {
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::setIoMode(Steinberg::Vst::IoMode mode) {
+    clear_bus_cache();
+
     return bridge_.send_audio_processor_message(
         YaComponent::SetIoMode{.instance_id = instance_id(), .mode = mode});
 }
@@ -300,36 +532,20 @@ Vst3PluginProxyImpl::getBusCount(Steinberg::Vst::MediaType type,
     const auto request = YaComponent::GetBusCount{
         .instance_id = instance_id(), .type = type, .dir = dir};
 
-    std::tuple<Steinberg::Vst::MediaType, Steinberg::Vst::BusDirection> args{
-        type, dir};
-    {
-        std::lock_guard lock(processing_bus_cache_mutex_);
-        if (processing_bus_cache_) {
-            if (auto it = processing_bus_cache_->bus_count.find(args);
-                it != processing_bus_cache_->bus_count.end()) {
-                const bool log_response =
-                    bridge_.logger_.log_request(true, request);
-                if (log_response) {
-                    bridge_.logger_.log_response(
-                        true, YaComponent::GetBusCount::Response(it->second),
-                        true);
-                }
+    const auto topology = maybe_query_bus_topology();
+    if (const auto busses = topology->busses(type, dir)) {
+        const auto num_busses = static_cast<int32>(busses->size());
 
-                return it->second;
-            }
+        const bool log_response = bridge_.logger_.log_request(true, request);
+        if (log_response) {
+            bridge_.logger_.log_response(
+                false, YaComponent::GetBusCount::Response(num_busses), true);
         }
-    }
 
-    const int32 result = bridge_.send_audio_processor_message(request);
-
-    {
-        std::lock_guard lock(processing_bus_cache_mutex_);
-        if (processing_bus_cache_) {
-            processing_bus_cache_->bus_count[args] = result;
-        }
+        return num_busses;
     }
 
-    return result;
+    return bridge_.send_audio_processor_message(request);
 }
 
 tresult PLUGIN_API
@@ -340,28 +556,21 @@ Vst3PluginProxyImpl::getBusInfo(Steinberg::Vst::MediaType type,
     const auto request = YaComponent::GetBusInfo{
         .instance_id = instance_id(), .type = type, .dir = dir, .index = index};
 
-    std::tuple<Steinberg::Vst::MediaType, Steinberg::Vst::BusDirection, int32>
-        args{type, dir, index};
-    {
-        std::lock_guard lock(processing_bus_cache_mutex_);
-        if (processing_bus_cache_) {
-            if (auto it = processing_bus_cache_->bus_info.find(args);
-                it != processing_bus_cache_->bus_info.end()) {
-                const bool log_response =
-                    bridge_.logger_.log_request(true, request);
-                if (log_response) {
-                    bridge_.logger_.log_response(
-                        false,
-                        YaComponent::GetBusInfo::Response{
-                            .result = Steinberg::kResultOk, .bus = it->second},
-                        true);
-                }
-
-                bus = it->second;
+    // Out of range indices are passed through to the plugin so it can decide
+    // how to handle them
+    const auto topology = maybe_query_bus_topology();
+    if (const auto busses = topology->busses(type, dir);
+        busses && index >= 0 && static_cast<size_t>(index) < busses->size()) {
+        const GetBusInfoResponse& response = (*busses)[index].info;
 
-                return Steinberg::kResultOk;
-            }
+        const bool log_response = bridge_.logger_.log_request(true, request);
+        if (log_response) {
+            bridge_.logger_.log_response(false, response, true);
         }
+
+        bus = response.bus;
+
+        return response.result;
     }
 
     const GetBusInfoResponse response =
@@ -369,13 +578,6 @@ Vst3PluginProxyImpl::getBusInfo(Steinberg::Vst::MediaType type,
 
     bus = response.bus;
 
-    {
-        std::lock_guard lock(processing_bus_cache_mutex_);
-        if (processing_bus_cache_) {
-            processing_bus_cache_->bus_info[args] = response.bus;
-        }
-    }
-
     return response.result;
 }
 
@@ -383,6 +585,8 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getRoutingInfo(
     // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
     Steinberg::Vst::RoutingInfo& inInfo,
     Steinberg::Vst::RoutingInfo& outInfo /*out*/) {
+    flush_bus_activations();
+
     const GetRoutingInfoResponse response =
         bridge_.send_audio_processor_message(YaComponent::GetRoutingInfo{
             .instance_id = instance_id(), .in_info = inInfo});
@@ -397,6 +601,57 @@ Vst3PluginProxyImpl::activateBus(Steinberg::Vst::MediaType type,
                                  Steinberg::Vst::BusDirection dir,
                                  int32 index,
                                  TBool state) {
+    // Hosts often (de)activate every bus one by one while setting up a plugin.
+    // While the plugin is inactive, calls for main busses that are active by
+    // default are collected and sent all at once, since plugins have no reason
+    // to reject those. Any other call may fail, for instance when a plugin
+    // doesn't allow a sidechain input to be activated on its own, so those
+    // calls are passed through directly after sending the deferred ones so the
+    // host gets the plugin's actual result.
+    const auto topology = maybe_query_bus_topology();
+    if (const auto busses = topology->busses(type, dir);
+        busses && index >= 0 && static_cast<size_t>(index) < busses->size() &&
+        (*busses)[index].info.result == Steinberg::kResultOk &&
+        (*busses)[index].info.bus.busType == Steinberg::Vst::kMain &&
+        ((*busses)[index].info.bus.flags &
+         Steinberg::Vst::BusInfo::kDefaultActive)) {
+        std::lock_guard lock(pending_bus_activations_mutex_);
+        if (!is_active_) {
+            const auto request = YaComponent::ActivateBus{
+                .instance_id = instance_id(),
+                .type = type,
+                .dir = dir,
+                .index = index,
+                .state = state};
+            // The actual result is logged when the activations get sent
+            const bool log_response =
+                bridge_.logger_.log_request(true, request);
+            if (log_response) {
+                bridge_.logger_.log_response(
+                    false, UniversalTResult(Steinberg::kResultOk));
+            }
+
+            if (auto it = std::find_if(
+                    pending_bus_activations_.begin(),
+                    pending_bus_activations_.end(),
+                    [&](const BusActivation& activation) {
+                        return activation.type == type &&
+                               activation.dir == dir &&
+                               activation.index == index;
+                    });
+                it != pending_bus_activations_.end()) {
+                it->state = state;
+            } else {
+                pending_bus_activations_.push_back(BusActivation{
+                    .type = type, .dir = dir, .index = index, .state = state});
+            }
+
+            return Steinberg::kResultOk;
+        }
+    }
+
+    flush_bus_activations();
+
     return bridge_.send_audio_processor_message(
         YaComponent::ActivateBus{.instance_id = instance_id(),
                                  .type = type,
@@ -413,6 +668,14 @@ tresult PLUGIN_API Vst3PluginProxyImpl::setActive(TBool state) {
     //       workaround of its own. Great!
     clear_bus_cache();
 
+    // Any deferred bus activations need to be sent before the plugin gets
+    // activated, and after this point they're no longer deferred
+    flush_bus_activations();
+    {
+        std::lock_guard lock(pending_bus_activations_mutex_);
+        is_active_ = state;
+    }
+
     const SetActiveResponse response = bridge_.send_audio_processor_message(
         YaComponent::SetActive{.instance_id = instance_id(), .state = state});
 
@@ -441,9 +704,16 @@ tresult PLUGIN_API Vst3PluginProxyImpl::setState(Steinberg::IBStream* state) {
         //       GUI thread. So if the GUI is active, we'll use the mutual
         //       recursion mechanism to allow this resize call to also be
         //       performed from the GUI thread.
-        return bridge_.send_mutually_recursive_message(
+        const tresult result = bridge_.send_mutually_recursive_message(
             Vst3PluginProxy::SetState{.instance_id = instance_id(),
                                       .state = state});
+
+        // Loading a new state will change most if not all parameters, and it
+        // may also change the plugin's busses
+        parameter_value_cache_.clear();
+        clear_bus_cache();
+
+        return result;
     } else {
         bridge_.logger_.log(
             "WARNING: Null pointer passed to "
@@ -498,7 +768,12 @@ tresult PLUGIN_API Vst3PluginProxyImpl::connect(IConnectionPoint* other) {
     // issues when using multiple instances of the plugin. If we cannot figure
     // out which object the plugins are connected to, we'll still proxy the
     // host's connection proxy.
-    if (auto other_instance = dynamic_cast<Vst3PluginProxy*>(other)) {
+    // Both objects need to live in the same Wine plugin host for this to work.
+    // Objects belonging to another bridge are treated like any other
+    // connection proxy.
+    if (auto other_instance = dynamic_cast<Vst3PluginProxyImpl*>(other);
+        other_instance && &other_instance->bridge_ == &bridge_) {
+        std::lock_guard lock(connection_mutex_);
         connected_instance_id_ = other_instance->instance_id();
 
         return bridge_.send_message(
@@ -523,8 +798,13 @@ tresult PLUGIN_API Vst3PluginProxyImpl::connect(IConnectionPoint* other) {
             }
 
             // If we are connected with another object instance from this
-            // plugin, `connected_instance_id` should now be set
+            // plugin, `connected_instance_id` should now be set. If the host's
+            // connection proxy delivers this message later instead,
+            // `connect_directly()` will replace the proxied connection set up
+            // below with a direct one.
             other->notify(message);
+
+            std::lock_guard lock(connection_mutex_);
             if (connected_instance_id_) {
                 return bridge_.send_message(YaConnectionPoint::Connect{
                     .instance_id = instance_id(),
@@ -534,6 +814,7 @@ tresult PLUGIN_API Vst3PluginProxyImpl::connect(IConnectionPoint* other) {
     }
 
     // If we cannot bypass the proxy, we'll just proxy the host's proxy
+    std::lock_guard lock(connection_mutex_);
     connection_point_proxy_ = other;
 
     return bridge_.send_message(YaConnectionPoint::Connect{
@@ -542,14 +823,46 @@ tresult PLUGIN_API Vst3PluginProxyImpl::connect(IConnectionPoint* other) {
             Vst3ConnectionPointProxy::ConstructArgs(other, instance_id())});
 }
 
+void Vst3PluginProxyImpl::connect_directly(size_t other_instance_id) {
+    std::lock_guard lock(connection_mutex_);
+    connected_instance_id_ = other_instance_id;
+
+    // If the host's connection proxy delivered our message asynchronously,
+    // then `connect()` will already have connected the plugin to a proxy for
+    // the host's connection proxy. In that case we'll swap that connection out
+    // for a direct one so messages between the two objects no longer have to
+    // leave the Wine plugin host.
+    if (connection_point_proxy_) {
+        bridge_.logger_.log_trace([&]() {
+            return "Replacing proxied connection between instances " +
+                   std::to_string(instance_id()) + " and " +
+                   std::to_string(other_instance_id) +
+                   " with a direct connection";
+        });
+
+        bridge_.send_message(
+            YaConnectionPoint::Disconnect{.instance_id = instance_id(),
+                                          .other_instance_id = std::nullopt});
+        connection_point_proxy_.reset();
+
+        bridge_.send_message(YaConnectionPoint::Connect{
+            .instance_id = instance_id(), .other = other_instance_id});
+    }
+}
+
 tresult PLUGIN_API
 Vst3PluginProxyImpl::disconnect(IConnectionPoint* /*other*/) {
     // See `Vst3PluginProxyImpl::connect()`, if we directly connected two
     // instances we'll also disconnect them again
+    std::lock_guard lock(connection_mutex_);
     if (connected_instance_id_) {
-        return bridge_.send_message(YaConnectionPoint::Disconnect{
-            .instance_id = instance_id(),
-            .other_instance_id = *connected_instance_id_});
+        const tresult result = bridge_.send_message(
+            YaConnectionPoint::Disconnect{
+                .instance_id = instance_id(),
+                .other_instance_id = *connected_instance_id_});
+        connected_instance_id_.reset();
+
+        return result;
     } else {
         const tresult result = bridge_.send_message(
             YaConnectionPoint::Disconnect{.instance_id = instance_id(),
@@ -596,7 +909,14 @@ Vst3PluginProxyImpl::notify(Steinberg::Vst::IMessage* message) {
                     *reinterpret_cast<Vst3PluginProxyImpl*>(
                         static_cast<size_t>(other_object_ptr));
 
-                other_object.connected_instance_id_ = instance_id();
+                // The message may have been sent by an object from another
+                // plugin, in which case the objects live in different Wine
+                // plugin hosts and we can't connect them directly
+                if (&other_object.bridge_ != &bridge_) {
+                    return Steinberg::kResultFalse;
+                }
+
+                other_object.connect_directly(instance_id());
 
                 return Steinberg::kResultOk;
             }
@@ -612,8 +932,14 @@ Vst3PluginProxyImpl::notify(Steinberg::Vst::IMessage* message) {
 tresult PLUGIN_API
 Vst3PluginProxyImpl::setComponentState(Steinberg::IBStream* state) {
     if (state) {
-        return bridge_.send_message(YaEditController::SetComponentState{
-            .instance_id = instance_id(), .state = state});
+        const tresult result =
+            bridge_.send_message(YaEditController::SetComponentState{
+                .instance_id = instance_id(), .state = state});
+
+        // See `setState()`
+        parameter_value_cache_.clear();
+
+        return result;
     } else {
         bridge_.logger_.log(
             "WARNING: Null pointer passed to "
@@ -665,6 +991,24 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getParamStringByValue(
     Steinberg::Vst::ParamValue valueNormalized /*in*/,
     Steinberg::Vst::String128 string /*out*/) {
     if (string) {
+        // Hosts ask for the display string of every visible parameter when
+        // redrawing generic editors and automation lanes, so these are cached
+        std::optional<std::u16string> cached_string =
+            parameter_value_cache_.text(id, valueNormalized);
+        cache_statistics_.record(parameter_string_cache,
+                                 cached_string.has_value());
+        if (!cached_string) {
+            maybe_prefetch_parameters(id);
+            cached_string = parameter_value_cache_.text(id, valueNormalized);
+        }
+        if (cached_string) {
+            std::copy(cached_string->begin(), cached_string->end(), string);
+            string[cached_string->size()] = 0;
+
+            return Steinberg::kResultOk;
+        }
+
+        const auto fetch = parameter_value_cache_.begin_fetch(id);
         const GetParamStringByValueResponse response =
             bridge_.send_message(YaEditController::GetParamStringByValue{
                 .instance_id = instance_id(),
@@ -674,6 +1018,11 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getParamStringByValue(
         std::copy(response.string.begin(), response.string.end(), string);
         string[response.string.size()] = 0;
 
+        if (response.result == Steinberg::kResultOk) {
+            parameter_value_cache_.store_text(id, valueNormalized,
+                                              response.string, fetch);
+        }
+
         return response.result;
     } else {
         bridge_.logger_.log(
@@ -723,15 +1072,37 @@ Vst3PluginProxyImpl::plainParamToNormalized(
 
 Steinberg::Vst::ParamValue PLUGIN_API
 Vst3PluginProxyImpl::getParamNormalized(Steinberg::Vst::ParamID id) {
-    return bridge_.send_message(YaEditController::GetParamNormalized{
-        .instance_id = instance_id(), .id = id});
+    std::optional<double> cached_value = parameter_value_cache_.value(id);
+    cache_statistics_.record(parameter_value_cache, cached_value.has_value());
+    if (!cached_value) {
+        maybe_prefetch_parameters(id);
+        cached_value = parameter_value_cache_.value(id);
+    }
+    if (cached_value) {
+        return *cached_value;
+    }
+
+    const auto fetch = parameter_value_cache_.begin_fetch(id);
+    const Steinberg::Vst::ParamValue value =
+        bridge_.send_message(YaEditController::GetParamNormalized{
+            .instance_id = instance_id(), .id = id});
+    parameter_value_cache_.store_value(id, value, fetch);
+
+    return value;
 }
 
 tresult PLUGIN_API
 Vst3PluginProxyImpl::setParamNormalized(Steinberg::Vst::ParamID id,
                                         Steinberg::Vst::ParamValue value) {
-    return bridge_.send_message(YaEditController::SetParamNormalized{
-        .instance_id = instance_id(), .id = id, .value = value});
+    const tresult result =
+        bridge_.send_message(YaEditController::SetParamNormalized{
+            .instance_id = instance_id(), .id = id, .value = value});
+
+    // The plugin may round or clamp the value, so the next
+    // `getParamNormalized()` call for this parameter should ask the plugin
+    parameter_value_cache_.invalidate_value(id);
+
+    return result;
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::setComponentHandler(
@@ -854,10 +1225,11 @@ tresult PLUGIN_API Vst3PluginProxyImpl::setChannelContextInfos(
 
 int32 PLUGIN_API Vst3PluginProxyImpl::getKeyswitchCount(int32 busIndex,
                                                         int16 channel) {
-    return bridge_.send_message(
-        YaKeyswitchController::GetKeyswitchCount{.instance_id = instance_id(),
-                                                 .bus_index = busIndex,
-                                                 .channel = channel});
+    // Hosts query every keyswitch to populate their articulation lists, so
+    // like with the parameter information we'll fetch all of them at once.
+    // These are cleared when the plugin triggers a component restart.
+    return static_cast<int32>(
+        maybe_query_keyswitch_infos(busIndex, channel)->size());
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::getKeyswitchInfo(
@@ -865,16 +1237,17 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getKeyswitchInfo(
     int16 channel,
     int32 keySwitchIndex,
     Steinberg::Vst::KeyswitchInfo& info /*out*/) {
-    const GetKeyswitchInfoResponse response =
-        bridge_.send_message(YaKeyswitchController::GetKeyswitchInfo{
-            .instance_id = instance_id(),
-            .bus_index = busIndex,
-            .channel = channel,
-            .key_switch_index = keySwitchIndex});
-
-    info = response.info;
+    // See above
+    const auto infos = maybe_query_keyswitch_infos(busIndex, channel);
+    if (keySwitchIndex >= 0 &&
+        keySwitchIndex < static_cast<int32>(infos->size())) {
+        const GetKeyswitchInfoResponse& response = (*infos)[keySwitchIndex];
+        info = response.info;
 
-    return response.result;
+        return response.result;
+    } else {
+        return Steinberg::kInvalidArgument;
+    }
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::onLiveMIDIControllerInput(
@@ -893,6 +1266,35 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getMidiControllerAssignment(
     int16 channel,
     Steinberg::Vst::CtrlNumber midiControllerNumber,
     Steinberg::Vst::ParamID& id /*out*/) {
+    // Hosts query every possible assignment when loading a plugin and after
+    // every component restart, so we'll fetch all of a bus's assignments at
+    // once. Anything outside of the regular MIDI channels and controller
+    // numbers is passed through to the plugin directly.
+    if (busIndex >= 0 && channel >= 0 &&
+        channel < midi_mapping_num_channels && midiControllerNumber >= 0 &&
+        midiControllerNumber < Steinberg::Vst::kCountCtrlNumber) {
+        maybe_query_midi_controller_assignments(busIndex);
+
+        // The plugin may have restarted its component in the meantime, in
+        // which case we'll pass the call through below
+        std::lock_guard lock(function_result_cache_mutex_);
+        if (const auto assignments =
+                function_result_cache_.midi_controller_assignments.find(
+                    busIndex);
+            assignments !=
+            function_result_cache_.midi_controller_assignments.end()) {
+            if (const auto& assignment =
+                    assignments->second[(channel *
+                                         Steinberg::Vst::kCountCtrlNumber) +
+                                        midiControllerNumber]) {
+                id = *assignment;
+                return Steinberg::kResultOk;
+            } else {
+                return Steinberg::kResultFalse;
+            }
+        }
+    }
+
     const GetMidiControllerAssignmentResponse response =
         bridge_.send_message(YaMidiMapping::GetMidiControllerAssignment{
             .instance_id = instance_id(),
@@ -907,11 +1309,10 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getMidiControllerAssignment(
 
 int32 PLUGIN_API Vst3PluginProxyImpl::getNoteExpressionCount(int32 busIndex,
                                                              int16 channel) {
-    return bridge_.send_message(
-        YaNoteExpressionController::GetNoteExpressionCount{
-            .instance_id = instance_id(),
-            .bus_index = busIndex,
-            .channel = channel});
+    // These are fetched all at once and cached until the plugin triggers a
+    // component restart, just like the keyswitches
+    return static_cast<int32>(
+        maybe_query_note_expression_infos(busIndex, channel)->size());
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::getNoteExpressionInfo(
@@ -919,16 +1320,18 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getNoteExpressionInfo(
     int16 channel,
     int32 noteExpressionIndex,
     Steinberg::Vst::NoteExpressionTypeInfo& info /*out*/) {
-    const GetNoteExpressionInfoResponse response =
-        bridge_.send_message(YaNoteExpressionController::GetNoteExpressionInfo{
-            .instance_id = instance_id(),
-            .bus_index = busIndex,
-            .channel = channel,
-            .note_expression_index = noteExpressionIndex});
-
-    info = response.info;
+    // See above
+    const auto infos = maybe_query_note_expression_infos(busIndex, channel);
+    if (noteExpressionIndex >= 0 &&
+        noteExpressionIndex < static_cast<int32>(infos->size())) {
+        const GetNoteExpressionInfoResponse& response =
+            (*infos)[noteExpressionIndex];
+        info = response.info;
 
-    return response.result;
+        return response.result;
+    } else {
+        return Steinberg::kInvalidArgument;
+    }
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::getNoteExpressionStringByValue(
@@ -1049,6 +1452,7 @@ tresult PLUGIN_API Vst3PluginProxyImpl::initialize(FUnknown* context) {
         //       update the list of interfaces we support for this object.
         update_supported_interfaces(
             std::move(response.updated_plugin_interfaces));
+        clear_bus_cache();
 
         return response.result;
     } else {
@@ -1059,6 +1463,14 @@ tresult PLUGIN_API Vst3PluginProxyImpl::initialize(FUnknown* context) {
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::terminate() {
+    // Bus activations for a plugin that never got activated no longer matter
+    {
+        std::lock_guard lock(pending_bus_activations_mutex_);
+        pending_bus_activations_.clear();
+        is_active_ = false;
+    }
+    clear_bus_cache();
+
     return bridge_.send_message(
         YaPluginBase::Terminate{.instance_id = instance_id()});
 }
@@ -1165,37 +1577,52 @@ Vst3PluginProxyImpl::setUnitData(Steinberg::Vst::UnitID unitId,
 }
 
 int32 PLUGIN_API Vst3PluginProxyImpl::getUnitCount() {
-    return bridge_.send_message(
-        YaUnitInfo::GetUnitCount{.instance_id = instance_id()});
+    // Hosts enumerate all units and program lists whenever they build a preset
+    // menu, so these are all fetched at once. The program list information is
+    // cleared when the plugin calls `IUnitHandler::notifyProgramListChange()`,
+    // and everything is cleared when the plugin triggers a component restart.
+    return static_cast<int32>(maybe_query_unit_infos()->unit_infos.size());
 }
 
 tresult PLUGIN_API
 Vst3PluginProxyImpl::getUnitInfo(int32 unitIndex,
                                  Steinberg::Vst::UnitInfo& info /*out*/) {
-    const GetUnitInfoResponse response =
-        bridge_.send_message(YaUnitInfo::GetUnitInfo{
-            .instance_id = instance_id(), .unit_index = unitIndex});
-
-    info = response.info;
+    // See above
+    const auto unit_infos = maybe_query_unit_infos();
+    if (unitIndex >= 0 &&
+        unitIndex < static_cast<int32>(unit_infos->unit_infos.size())) {
+        const GetUnitInfoResponse& response =
+            unit_infos->unit_infos[unitIndex];
+        info = response.info;
 
-    return response.result;
+        return response.result;
+    } else {
+        return Steinberg::kInvalidArgument;
+    }
 }
 
 int32 PLUGIN_API Vst3PluginProxyImpl::getProgramListCount() {
-    return bridge_.send_message(
-        YaUnitInfo::GetProgramListCount{.instance_id = instance_id()});
+    // See above
+    return static_cast<int32>(
+        maybe_query_unit_infos()->program_list_infos.size());
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::getProgramListInfo(
     int32 listIndex,
     Steinberg::Vst::ProgramListInfo& info /*out*/) {
-    const GetProgramListInfoResponse response =
-        bridge_.send_message(YaUnitInfo::GetProgramListInfo{
-            .instance_id = instance_id(), .list_index = listIndex});
-
-    info = response.info;
+    // See above
+    const auto unit_infos = maybe_query_unit_infos();
+    if (listIndex >= 0 &&
+        listIndex <
+            static_cast<int32>(unit_infos->program_list_infos.size())) {
+        const GetProgramListInfoResponse& response =
+            unit_infos->program_list_infos[listIndex];
+        info = response.info;
 
-    return response.result;
+        return response.result;
+    } else {
+        return Steinberg::kInvalidArgument;
+    }
 }
 
 tresult PLUGIN_API
@@ -1203,6 +1630,19 @@ Vst3PluginProxyImpl::getProgramName(Steinberg::Vst::ProgramListID listId,
                                     int32 programIndex,
                                     Steinberg::Vst::String128 name /*out*/) {
     if (name) {
+        // All of a program list's names are fetched at once. If the host asks
+        // for a list or a program we don't know about, then we'll just pass
+        // the call through to the plugin.
+        const auto names = maybe_query_program_names(listId);
+        if (names && programIndex >= 0 &&
+            programIndex < static_cast<int32>(names->size())) {
+            const GetProgramNameResponse& response = (*names)[programIndex];
+            std::copy(response.name.begin(), response.name.end(), name);
+            name[response.name.size()] = 0;
+
+            return response.result;
+        }
+
         const GetProgramNameResponse response = bridge_.send_message(
             YaUnitInfo::GetProgramName{.instance_id = instance_id(),
                                        .list_id = listId,
@@ -1225,6 +1665,31 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getProgramInfo(
     Steinberg::Vst::CString attributeId /*in*/,
     Steinberg::Vst::String128 attributeValue /*out*/) {
     if (attributeId && attributeValue) {
+        // These are memoized until the plugin reports that the program list
+        // has changed. Like the program names, this is fetched without holding
+        // a lock on the cache.
+        auto key = std::make_tuple(listId, programIndex,
+                                   std::string(attributeId));
+        uint64_t generation;
+        {
+            std::lock_guard lock(function_result_cache_mutex_);
+            if (const auto it =
+                    function_result_cache_.program_infos.find(key);
+                it != function_result_cache_.program_infos.end()) {
+                const GetProgramInfoResponse& response = it->second;
+                std::copy(response.attribute_value.begin(),
+                          response.attribute_value.end(), attributeValue);
+                attributeValue[response.attribute_value.size()] = 0;
+
+                cache_statistics_.record(program_info_cache, true);
+                return response.result;
+            }
+
+            generation = program_cache_generation_;
+        }
+
+        cache_statistics_.record(program_info_cache, false);
+
         const GetProgramInfoResponse response = bridge_.send_message(
             YaUnitInfo::GetProgramInfo{.instance_id = instance_id(),
                                        .list_id = listId,
@@ -1235,6 +1700,14 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getProgramInfo(
                   response.attribute_value.end(), attributeValue);
         attributeValue[response.attribute_value.size()] = 0;
 
+        {
+            std::lock_guard lock(function_result_cache_mutex_);
+            if (generation == program_cache_generation_) {
+                function_result_cache_.program_infos.emplace(std::move(key),
+                                                             response);
+            }
+        }
+
         return response.result;
     } else {
         bridge_.logger_.log(
@@ -1351,16 +1824,236 @@ void Vst3PluginProxyImpl::maybe_query_parameter_info() {
     // We'll assume that the plugin has at least one parameter. If it does not
     // have any parameters then everything will work as expected, except that
     // the parameter count is not cached.
-    if (function_result_cache_.parameter_info.empty()) {
+    const bool is_cached = !function_result_cache_.parameter_info.empty();
+    cache_statistics_.record(parameter_info_cache, is_cached);
+    if (!is_cached) {
         const GetParameterInfosResponse response = bridge_.send_message(
             YaEditController::GetParameterInfos{.instance_id = instance_id()});
         function_result_cache_.parameter_info = std::move(response.infos);
+
+        function_result_cache_.parameter_indices.clear();
+        for (size_t i = 0; i < function_result_cache_.parameter_info.size();
+             i++) {
+            if (const auto& info = function_result_cache_.parameter_info[i]) {
+                function_result_cache_.parameter_indices[info->id] = i;
+            }
+        }
     }
 }
 
-void Vst3PluginProxyImpl::clear_bus_cache() noexcept {
-    std::lock_guard lock(processing_bus_cache_mutex_);
-    if (processing_bus_cache_) {
-        processing_bus_cache_.emplace();
+void Vst3PluginProxyImpl::maybe_query_midi_controller_assignments(
+    int32 bus_index) {
+    std::lock_guard lock(function_result_cache_mutex_);
+    const bool is_cached =
+        function_result_cache_.midi_controller_assignments.contains(bus_index);
+    cache_statistics_.record(midi_mapping_cache, is_cached);
+    if (is_cached) {
+        return;
+    }
+
+    const GetMidiControllerAssignmentsResponse response =
+        bridge_.send_message(YaMidiMapping::GetMidiControllerAssignments{
+            .instance_id = instance_id(), .bus_index = bus_index});
+
+    std::vector<std::optional<Steinberg::Vst::ParamID>> assignments(
+        midi_mapping_num_channels * Steinberg::Vst::kCountCtrlNumber);
+    for (const auto& assignment : response.assignments) {
+        assignments[(assignment.channel * Steinberg::Vst::kCountCtrlNumber) +
+                    assignment.midi_controller_number] = assignment.id;
+    }
+
+    function_result_cache_.midi_controller_assignments[bus_index] =
+        std::move(assignments);
+}
+
+std::shared_ptr<const Vst3PluginProxyImpl::GetBusTopologyResponse>
+Vst3PluginProxyImpl::maybe_query_bus_topology() {
+    std::lock_guard lock(bus_topology_mutex_);
+    cache_statistics_.record(bus_info_cache, bus_topology_ != nullptr);
+    if (!bus_topology_) {
+        bus_topology_ = std::make_shared<const GetBusTopologyResponse>(
+            bridge_.send_audio_processor_message(
+                YaComponent::GetBusTopology{.instance_id = instance_id()}));
+    }
+
+    return bus_topology_;
+}
+
+void Vst3PluginProxyImpl::flush_bus_activations() {
+    std::vector<BusActivation> activations;
+    {
+        std::lock_guard lock(pending_bus_activations_mutex_);
+        if (pending_bus_activations_.empty()) {
+            return;
+        }
+
+        activations.swap(pending_bus_activations_);
+    }
+
+    const ActivateBussesResponse response =
+        bridge_.send_audio_processor_message(YaComponent::ActivateBusses{
+            .instance_id = instance_id(), .activations = activations});
+
+    // Only calls for default active main busses are deferred, so this should
+    // never happen. We already told the host that these calls succeeded, so
+    // the best we can do is to mention it when the plugin disagrees.
+    for (size_t i = 0; i < activations.size() && i < response.results.size();
+         i++) {
+        if (response.results[i] != Steinberg::kResultOk) {
+            bridge_.logger_.log(
+                "WARNING: The plugin returned " + response.results[i].string() +
+                " for a deferred 'IComponent::activateBus()' call for bus " +
+                std::to_string(activations[i].index));
+        }
+    }
+}
+
+std::shared_ptr<const Vst3PluginProxyImpl::GetUnitInfosResponse>
+Vst3PluginProxyImpl::maybe_query_unit_infos() {
+    std::lock_guard lock(function_result_cache_mutex_);
+    cache_statistics_.record(unit_info_cache,
+                             function_result_cache_.unit_infos != nullptr);
+    if (!function_result_cache_.unit_infos) {
+        function_result_cache_.unit_infos =
+            std::make_shared<const GetUnitInfosResponse>(bridge_.send_message(
+                YaUnitInfo::GetUnitInfos{.instance_id = instance_id()}));
+    }
+
+    return function_result_cache_.unit_infos;
+}
+
+std::shared_ptr<
+    const std::vector<Vst3PluginProxyImpl::GetProgramNameResponse>>
+Vst3PluginProxyImpl::maybe_query_program_names(
+    Steinberg::Vst::ProgramListID list_id) {
+    const auto unit_infos = maybe_query_unit_infos();
+    const auto list_info = std::find_if(
+        unit_infos->program_list_infos.begin(),
+        unit_infos->program_list_infos.end(),
+        [&](const GetProgramListInfoResponse& response) {
+            return response.result == Steinberg::kResultOk &&
+                   response.info.id == list_id;
+        });
+    if (list_info == unit_infos->program_list_infos.end()) {
+        return nullptr;
+    }
+
+    uint64_t generation;
+    {
+        std::lock_guard lock(function_result_cache_mutex_);
+        if (const auto it = function_result_cache_.program_names.find(list_id);
+            it != function_result_cache_.program_names.end()) {
+            cache_statistics_.record(program_name_cache, true);
+            return it->second;
+        }
+
+        generation = program_cache_generation_;
     }
+
+    cache_statistics_.record(program_name_cache, false);
+
+    GetProgramNamesResponse response =
+        bridge_.send_message(YaUnitInfo::GetProgramNames{
+            .instance_id = instance_id(),
+            .list_id = list_id,
+            .num_programs = list_info->info.programCount});
+    auto names = std::make_shared<const std::vector<GetProgramNameResponse>>(
+        std::move(response.names));
+
+    // If the plugin changed the list while we were fetching the names, then
+    // the names can still be used to answer this call but we won't cache them
+    std::lock_guard lock(function_result_cache_mutex_);
+    if (generation == program_cache_generation_) {
+        function_result_cache_.program_names[list_id] = names;
+    }
+
+    return names;
+}
+
+std::shared_ptr<
+    const std::vector<Vst3PluginProxyImpl::GetKeyswitchInfoResponse>>
+Vst3PluginProxyImpl::maybe_query_keyswitch_infos(int32 bus_index,
+                                                 int16 channel) {
+    std::lock_guard lock(function_result_cache_mutex_);
+    auto& infos =
+        function_result_cache_.keyswitch_infos[std::pair(bus_index, channel)];
+    cache_statistics_.record(keyswitch_cache, infos != nullptr);
+    if (!infos) {
+        GetKeyswitchInfosResponse response =
+            bridge_.send_message(YaKeyswitchController::GetKeyswitchInfos{
+                .instance_id = instance_id(),
+                .bus_index = bus_index,
+                .channel = channel});
+        infos = std::make_shared<const std::vector<GetKeyswitchInfoResponse>>(
+            std::move(response.infos));
+    }
+
+    return infos;
+}
+
+std::shared_ptr<
+    const std::vector<Vst3PluginProxyImpl::GetNoteExpressionInfoResponse>>
+Vst3PluginProxyImpl::maybe_query_note_expression_infos(int32 bus_index,
+                                                       int16 channel) {
+    std::lock_guard lock(function_result_cache_mutex_);
+    auto& infos = function_result_cache_
+                      .note_expression_infos[std::pair(bus_index, channel)];
+    cache_statistics_.record(note_expression_cache, infos != nullptr);
+    if (!infos) {
+        GetNoteExpressionInfosResponse response = bridge_.send_message(
+            YaNoteExpressionController::GetNoteExpressionInfos{
+                .instance_id = instance_id(),
+                .bus_index = bus_index,
+                .channel = channel});
+        infos = std::make_shared<
+            const std::vector<GetNoteExpressionInfoResponse>>(
+            std::move(response.infos));
+    }
+
+    return infos;
+}
+
+void Vst3PluginProxyImpl::maybe_prefetch_parameters(
+    Steinberg::Vst::ParamID id) {
+    std::vector<Steinberg::Vst::ParamID> ids;
+    size_t end_index;
+    {
+        std::lock_guard lock(function_result_cache_mutex_);
+        const auto index_it = function_result_cache_.parameter_indices.find(id);
+        if (index_it == function_result_cache_.parameter_indices.end() ||
+            !parameter_prefetch_detector_.record_miss(index_it->second)) {
+            return;
+        }
+
+        const auto& parameter_info = function_result_cache_.parameter_info;
+        end_index = std::min(index_it->second + parameter_prefetch_batch_size,
+                             parameter_info.size());
+        for (size_t i = index_it->second; i < end_index; i++) {
+            if (parameter_info[i]) {
+                ids.push_back(parameter_info[i]->id);
+            }
+        }
+    }
+
+    const auto fetch = parameter_value_cache_.begin_fetch(ids);
+    const GetParamValuesResponse response =
+        bridge_.send_message(YaEditController::GetParamValues{
+            .instance_id = instance_id(), .ids = ids});
+
+    for (size_t i = 0; i < ids.size() && i < response.values.size(); i++) {
+        const ParamValueAndString& value = response.values[i];
+        parameter_value_cache_.store_value(ids[i], value.value_normalized,
+                                           fetch);
+        if (value.string_result == Steinberg::kResultOk) {
+            parameter_value_cache_.store_text(ids[i], value.value_normalized,
+                                              value.string, fetch);
+        }
+    }
+
+    parameter_prefetch_detector_.record_prefetch(end_index);
+}
+
+void Vst3PluginProxyImpl::clear_bus_cache() noexcept {
+    std::lock_guard lock(bus_topology_mutex_);
+    bus_topology_.reset();
 }
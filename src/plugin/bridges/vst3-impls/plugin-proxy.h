@@ -16,8 +16,14 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <string>
+#include <tuple>
 
+#include "../../parameter-value-cache.h"
 #include "../vst3.h"
 #include "plug-view-proxy.h"
 
@@ -64,17 +70,81 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
     bool unregister_context_menu(size_t context_menu_id);
 
     /**
-     * Clear our function call caches. We'll do this when the plugin calls
-     * `IComponentHandler::restartComponent()`. These caching layers are
-     * necessary to get decent performance in certain hosts because they will
-     * call these functions repeatedly even when their values cannot change.
+     * The different kinds of information we cache. These are used to index
+     * `CacheStatistics`, and `1 << cache` is used as a bit flag to describe
+     * which caches should be invalidated.
+     */
+    enum CachedData : size_t {
+        bus_info_cache,
+        sample_size_cache,
+        parameter_info_cache,
+        parameter_value_cache,
+        parameter_string_cache,
+        midi_mapping_cache,
+        unit_info_cache,
+        program_name_cache,
+        program_info_cache,
+        keyswitch_cache,
+        note_expression_cache,
+        num_caches
+    };
+
+    /**
+     * Hit and miss counters for every cache, so the effectiveness of the
+     * caches can be checked in the logs. A miss means that we had to ask the
+     * plugin.
+     */
+    struct CacheStatistics {
+        std::array<std::atomic_uint64_t, num_caches> hits{};
+        std::array<std::atomic_uint64_t, num_caches> misses{};
+        /**
+         * The number of `IComponentHandler::restartComponent()` calls, and the
+         * total number of caches those calls invalidated.
+         */
+        std::atomic_uint64_t restarts = 0;
+        std::atomic_uint64_t invalidations = 0;
+
+        inline void record(CachedData cache, bool hit) noexcept {
+            (hit ? hits : misses)[cache].fetch_add(1,
+                                                   std::memory_order_relaxed);
+        }
+
+        /**
+         * Format the statistics for every cache that has been used as a human
+         * readable summary. Returns an empty string if no cache has been used.
+         */
+        std::string format() const;
+    };
+
+    /**
+     * Clear the function call caches affected by a
+     * `IComponentHandler::restartComponent(restart_flags)` call. These caching
+     * layers are necessary to get decent performance in certain hosts because
+     * they will call these functions repeatedly even when their values cannot
+     * change. Plugins like Kontakt call `restartComponent()` many times in a
+     * row while loading a patch, so we'll only drop the information the flags
+     * say may have changed. Caches that have already been cleared stay empty
+     * until the host queries them again, so a burst of restarts only causes a
+     * single refetch. `kReloadComponent` and flags we don't know about clear
+     * everything.
      *
      * See the bottom of this class for more information on what we're caching.
      *
      * @see clear_bus_cache_
      * @see function_result_cache_
+     * @see parameter_value_cache_
+     */
+    void clear_caches(int32 restart_flags) noexcept;
+
+    /**
+     * Clear the cached unit, program list and program information after the
+     * plugin calls `IUnitHandler::notifyProgramListChange(list_id,
+     * program_index)`. If `program_index` is -1, then the entire list has
+     * changed and its program count may have changed as well. Otherwise only
+     * the cached information for that single program is dropped.
      */
-    void clear_caches() noexcept;
+    void clear_program_list_cache(Steinberg::Vst::ProgramListID list_id,
+                                  int32 program_index) noexcept;
 
     // From `IAudioPresentationLatency`
     tresult PLUGIN_API
@@ -322,6 +392,23 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
      */
     std::optional<size_t> connected_instance_id_;
 
+    /**
+     * Protects `connected_instance_id_` and `connection_point_proxy_`, since
+     * the host may deliver our connection message from another thread after
+     * `connect()` has already returned.
+     */
+    std::mutex connection_mutex_;
+
+    /**
+     * Caches the results of `IEditController::getParamNormalized()` and
+     * `IEditController::getParamStringByValue()`. Values are updated when the
+     * plugin calls `IComponentHandler::performEdit()` and when it outputs
+     * parameter changes during audio processing, and the entire cache is
+     * cleared when the plugin restarts its component or when its state gets
+     * restored.
+     */
+    ParameterValueCache<std::u16string> parameter_value_cache_;
+
     /**
      * If we cannot manage to bypass the connection proxy as mentioned in the
      * docstring of `connected_instance_id_`, then we'll store the host's
@@ -398,6 +485,15 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
     Steinberg::FUnknownPtr<Steinberg::Vst::IUnitHandler2> unit_handler_2_;
 
    private:
+    /**
+     * Connect this object directly to another object from the same plugin on
+     * the Wine side after the other object received our connection message
+     * through the host's connection proxy. If `connect()` has already given up
+     * and connected the plugin to a proxy for the host's connection proxy,
+     * then that connection will be replaced with a direct connection.
+     */
+    void connect_directly(size_t other_instance_id);
+
     /**
      * Query information for all of the plugin's parameters and writes the
      * results to `function_result_cache_` if necessary. Otherwise does nothing.
@@ -407,18 +503,90 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
     void maybe_query_parameter_info();
 
     /**
-     * Clear the bus count and information cache. We need this cache for REAPER
-     * as it makes `num_inputs + num_outputs + 2` function calls to retrieve
-     * this information every single processing cycle. For plugins with a lot of
-     * outputs this really adds up. According to the VST3 workflow diagrams bus
-     * information cannot change anymore once `IAudioProcessor::setProcessing()`
-     * has been called, but REAPER doesn't quite follow the spec here and it
-     * will set bus arrangements and activate the plugin only after it's called
-     * `IAudioProcessor::setProcessing()`. Because of that we'll have to
-     * manually flush this cache when the stores information potentially becomes
-     * invalid.
+     * Query all of the plugin's MIDI controller assignments for an event bus
+     * and write them to `function_result_cache_` if we haven't already done so.
+     * Like with `maybe_query_parameter_info()`, this acquires a lock on the
+     * struct so it must not be locked before calling this function.
+     */
+    void maybe_query_midi_controller_assignments(int32 bus_index);
+
+    /**
+     * Query the plugin's bus information and audio bus arrangements if we have
+     * not already done so, and return the cached information. This acquires a
+     * lock on `bus_topology_mutex_`.
+     */
+    std::shared_ptr<const GetBusTopologyResponse> maybe_query_bus_topology();
+
+    /**
+     * Send the `IComponent::activateBus()` calls collected in
+     * `pending_bus_activations_` to the plugin, if there are any. This is done
+     * right before any call where the plugin's active busses may matter.
+     */
+    void flush_bus_activations();
+
+    /**
+     * Query all of the plugin's unit and program list information if we have
+     * not already done so, and return the cached information. Like with
+     * `maybe_query_parameter_info()`, this acquires a lock on
+     * `function_result_cache_` so it must not be locked before calling this
+     * function.
+     */
+    std::shared_ptr<const GetUnitInfosResponse> maybe_query_unit_infos();
+
+    /**
+     * Query the names of all programs in a program list if we have not already
+     * done so, and return the cached names. Returns a null pointer if the
+     * plugin does not have a program list with this ID. Since the host may call
+     * `IUnitInfo::getProgramName()` from within
+     * `IUnitHandler::notifyProgramListChange()`, the names are fetched without
+     * holding a lock on `function_result_cache_`.
+     */
+    std::shared_ptr<const std::vector<GetProgramNameResponse>>
+    maybe_query_program_names(Steinberg::Vst::ProgramListID list_id);
+
+    /**
+     * Query all keyswitches for a bus and channel if we have not already done
+     * so, and return the cached keyswitches. This acquires a lock on
+     * `function_result_cache_`.
+     */
+    std::shared_ptr<const std::vector<GetKeyswitchInfoResponse>>
+    maybe_query_keyswitch_infos(int32 bus_index, int16 channel);
+
+    /**
+     * Query all note expression types for a bus and channel if we have not
+     * already done so, and return the cached note expression types. This
+     * acquires a lock on `function_result_cache_`.
+     */
+    std::shared_ptr<const std::vector<GetNoteExpressionInfoResponse>>
+    maybe_query_note_expression_infos(int32 bus_index, int16 channel);
+
+    /**
+     * Called after a cache miss in `parameter_value_cache_`. If the host seems
+     * to be querying the plugin's parameters one by one in order, then this
+     * fetches the values and display strings for the next
+     * `parameter_prefetch_batch_size` parameters starting at `id` in a single
+     * message and stores them in `parameter_value_cache_`. Every parameter is
+     * stored on its own, so a parameter changing during the round trip does
+     * not cause the rest of the batch to be discarded. This only works when
+     * the host has already queried the plugin's parameter information.
+     *
+     * @see parameter_prefetch_detector_
+     */
+    void maybe_prefetch_parameters(Steinberg::Vst::ParamID id);
+
+    /**
+     * Clear the cached bus information and arrangements. We originally needed
+     * this cache for REAPER as it makes `num_inputs + num_outputs + 2` function
+     * calls to retrieve this information every single processing cycle, and
+     * other hosts query every bus many times while setting up a plugin. The
+     * plugin should tell the host when this information changes by calling
+     * `IComponent::restartComponent(kIoChanged)`, but REAPER doesn't quite
+     * follow the spec here and it will set bus arrangements and activate the
+     * plugin only after it's called `IAudioProcessor::setProcessing()`. Because
+     * of that we'll also manually flush this cache whenever the host does
+     * something that could change the plugin's busses.
      *
-     * @see processing_bus_cache_
+     * @see bus_topology_
      */
     void clear_bus_cache() noexcept;
 
@@ -483,44 +651,38 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
     // Caches
 
     /**
-     * A cache for `IAudioProcessor::getBusCount()` and
-     * `IAudioProcessor::getBusInfo()`. We'll memoize the function calls for
-     * these two functions while processing audio (since at that time these
-     * values should be immutable until the plugin tells the host that this
-     * information has changed).
+     * Memoizes `IComponent::getBusCount()`, `IComponent::getBusInfo()` and
+     * `IAudioProcessor::getBusArrangement()`. All of this is fetched at once
+     * the first time the host calls any of these functions. This cache was
+     * originally intended because REAPER would query this information at the
+     * start of every audio processing cycle, and hosts still query every bus
+     * many times when setting up a plugin. The cached object is immutable and
+     * reference counted so it can be read without holding on to the lock.
      *
-     * @see processing_bus_cache_
+     * @see clear_bus_cache
      */
-    struct BusInfoCache {
-        // `std::unordered_map` would be better here, but tuples aren't hashable
-        // out of the box and the difference in performance won't be noticeable
-        // enough to warrent the effort.
-        std::map<
-            std::tuple<Steinberg::Vst::MediaType, Steinberg::Vst::BusDirection>,
-            int32>
-            bus_count;
-        std::map<std::tuple<Steinberg::Vst::MediaType,
-                            Steinberg::Vst::BusDirection,
-                            int32>,
-                 Steinberg::Vst::BusInfo>
-            bus_info;
-    };
+    std::shared_ptr<const GetBusTopologyResponse> bus_topology_;
+    std::mutex bus_topology_mutex_;
 
     /**
-     * This cache originally intended because REAPER would query this
-     * information at the start of every audio processing cycle. This would hurt
-     * performance considerably if a plugin has many input or output busses.
-     * This issue has since been fixed, but some DAWs still query this
-     * information repeatedly so it seems like a good idea to keep the caches
-     * in.
-     *
-     * Since this information is immutable during audio processing, this cache
-     * will only be available at those times.
+     * `IComponent::activateBus()` calls for main busses with the
+     * `kDefaultActive` flag made while the plugin is inactive. Hosts often
+     * (de)activate every bus one by one before activating the plugin, so these
+     * are sent all at once right before they can start to matter. Calls for
+     * other busses may be rejected by the plugin, so those are always sent
+     * directly. If the host changes the same bus more than once, then only the
+     * last state is kept.
      *
-     * @see clear_bus_cache_
+     * @see flush_bus_activations
+     */
+    std::vector<BusActivation> pending_bus_activations_;
+    /**
+     * Whether the host has activated the plugin through
+     * `IComponent::setActive()`. Bus activations are only deferred while the
+     * plugin is inactive. Protected by `pending_bus_activations_mutex_`.
      */
-    std::optional<BusInfoCache> processing_bus_cache_;
-    std::mutex processing_bus_cache_mutex_;
+    bool is_active_ = false;
+    std::mutex pending_bus_activations_mutex_;
 
     /**
      * A cache for several function calls that should be safe to cache since
@@ -550,6 +712,65 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
          */
         std::vector<std::optional<Steinberg::Vst::ParameterInfo>>
             parameter_info;
+        /**
+         * The index in `parameter_info` for every parameter ID. Populated
+         * together with `parameter_info`, and used to detect when the host is
+         * querying parameters in order.
+         */
+        std::unordered_map<Steinberg::Vst::ParamID, size_t> parameter_indices;
+        /**
+         * Memoizes `IMidiMapping::getMidiControllerAssignment()` for the first
+         * `midi_mapping_num_channels` channels of every event bus the host has
+         * queried. These are fetched a bus at once, since hosts like Cubase
+         * and Bitwig query every possible assignment when loading a plugin
+         * and after every component restart. The vectors are indexed by
+         * `channel * kCountCtrlNumber + midi_controller_number`, and contain a
+         * nullopt if there's no assignment for that combination.
+         */
+        std::map<int32, std::vector<std::optional<Steinberg::Vst::ParamID>>>
+            midi_controller_assignments;
+        /**
+         * Memoizes `IUnitInfo::getUnitCount()`, `IUnitInfo::getUnitInfo()`,
+         * `IUnitInfo::getProgramListCount()` and
+         * `IUnitInfo::getProgramListInfo()`. These are all fetched at once the
+         * first time the host calls any of these functions. The cached
+         * objects are immutable and reference counted so they can be read
+         * without holding on to the lock.
+         */
+        std::shared_ptr<const GetUnitInfosResponse> unit_infos;
+        /**
+         * Memoizes `IUnitInfo::getProgramName()` for every program list the
+         * host has queried, indexed by program index. All of a list's program
+         * names are fetched at once since hosts always query all of them to
+         * populate their preset menus.
+         */
+        std::map<Steinberg::Vst::ProgramListID,
+                 std::shared_ptr<const std::vector<GetProgramNameResponse>>>
+            program_names;
+        /**
+         * Memoizes `IUnitInfo::getProgramInfo()`. The attribute IDs are free
+         * form strings, so these can only be cached after the host has asked
+         * for them once.
+         */
+        std::map<std::tuple<Steinberg::Vst::ProgramListID, int32, std::string>,
+                 GetProgramInfoResponse>
+            program_infos;
+        /**
+         * Memoizes `IKeyswitchController::getKeyswitchCount()` and
+         * `IKeyswitchController::getKeyswitchInfo()` per bus and channel.
+         */
+        std::map<std::pair<int32, int16>,
+                 std::shared_ptr<const std::vector<GetKeyswitchInfoResponse>>>
+            keyswitch_infos;
+        /**
+         * Memoizes `INoteExpressionController::getNoteExpressionCount()` and
+         * `INoteExpressionController::getNoteExpressionInfo()` per bus and
+         * channel.
+         */
+        std::map<
+            std::pair<int32, int16>,
+            std::shared_ptr<const std::vector<GetNoteExpressionInfoResponse>>>
+            note_expression_infos;
     };
 
     /**
@@ -561,11 +782,33 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
      * fixed, but we'll keep it in because some other hosts also query this
      * information more than once.
      *
-     * The cache will be cleared when the plugin tells the host that some of its
-     * parameter values have changed.
+     * The parts of the cache affected by a `restartComponent()` call are
+     * cleared when the plugin calls that function.
      *
      * @see clear_caches
      */
     FunctionResultCache function_result_cache_;
     std::mutex function_result_cache_mutex_;
+    /**
+     * Incremented every time `clear_caches()` or `clear_program_list_cache()`
+     * drops program information. Program names and program infos are fetched
+     * without holding `function_result_cache_mutex_`, so we'll use this to
+     * avoid storing results that may have become stale in the meantime.
+     * Protected by `function_result_cache_mutex_`.
+     */
+    uint64_t program_cache_generation_ = 0;
+
+    /**
+     * Used to detect when the host queries parameter values or display strings
+     * one by one in order, so we can prefetch them in batches.
+     *
+     * @see maybe_prefetch_parameters
+     */
+    SequentialAccessDetector parameter_prefetch_detector_;
+
+    /**
+     * Hit and miss counters for all of the above caches. These are logged when
+     * the object gets destroyed.
+     */
+    CacheStatistics cache_statistics_;
 };
@@ -68,6 +68,7 @@ Vst3PluginBridge::Vst3PluginBridge(const ghc::filesystem::path& plugin_path)
                 [&](const WantsConfiguration& request)
                     -> WantsConfiguration::Response {
                     warn_on_version_mismatch(request.host_version);
+                    negotiate_compression(request.host_supports_compression);
 
                     return config_;
                 },
@@ -84,6 +85,9 @@ Vst3PluginBridge::Vst3PluginBridge(const ghc::filesystem::path& plugin_path)
                     const auto& [proxy_object, _] =
                         get_proxy(request.owner_instance_id);
 
+                    proxy_object.parameter_value_cache_.update_value(
+                        request.id, request.value_normalized);
+
                     return proxy_object.component_handler_->performEdit(
                         request.id, request.value_normalized);
                 },
@@ -99,9 +103,9 @@ Vst3PluginBridge::Vst3PluginBridge(const ghc::filesystem::path& plugin_path)
                     const auto& [proxy_object, _] =
                         get_proxy(request.owner_instance_id);
 
-                    // To err on the safe side, we'll just always clear out all
-                    // of our caches whenever a plugin requests a restart
-                    proxy_object.clear_caches();
+                    // Only the caches affected by these flags are cleared.
+                    // These are refetched when the host asks for them again.
+                    proxy_object.clear_caches(request.flags);
 
                     return proxy_object.component_handler_->restartComponent(
                         request.flags);
@@ -396,6 +400,11 @@ Vst3PluginBridge::Vst3PluginBridge(const ghc::filesystem::path& plugin_path)
                     const auto& [proxy_object, _] =
                         get_proxy(request.owner_instance_id);
 
+                    // The host will likely query the program list's names
+                    // again in response to this
+                    proxy_object.clear_program_list_cache(
+                        request.list_id, request.program_index);
+
                     return proxy_object.unit_handler_->notifyProgramListChange(
                         request.list_id, request.program_index);
                 },
@@ -22,6 +22,42 @@
 
 namespace fs = ghc::filesystem;
 
+using namespace std::literals::chrono_literals;
+
+/**
+ * How often the shared watchdog polls for conditions that can't be watched
+ * through a pidfd. This is the same interval the per-instance watchdog threads
+ * used to poll at.
+ */
+constexpr std::chrono::steady_clock::duration host_watchdog_poll_interval =
+    20ms;
+
+ProcessWatchdog& host_process_watchdog() {
+    // The thread is declared last so it gets joined first when the library gets
+    // unloaded
+    struct SharedWatchdog {
+        SharedWatchdog()
+            : work_guard(asio::make_work_guard(io_context)),
+              watchdog(io_context, host_watchdog_poll_interval),
+              thread([this]() {
+                  pthread_setname_np(pthread_self(), "watchdog");
+
+                  io_context.run();
+              }) {}
+
+        ~SharedWatchdog() noexcept { io_context.stop(); }
+
+        asio::io_context io_context;
+        asio::executor_work_guard<asio::io_context::executor_type> work_guard;
+        ProcessWatchdog watchdog;
+        std::jthread thread;
+    };
+
+    static SharedWatchdog shared_watchdog;
+
+    return shared_watchdog.watchdog;
+}
+
 HostProcess::HostProcess(asio::io_context& io_context, Sockets& sockets)
     : sockets_(sockets), stdout_pipe_(io_context), stderr_pipe_(io_context) {}
 
@@ -148,6 +184,11 @@ bool IndividualHost::running() {
     return handle_.running();
 }
 
+ProcessWatchdog::Guard IndividualHost::watch(
+    ProcessWatchdog::Callback on_exit) {
+    return host_process_watchdog().watch(handle_.pid(), std::move(on_exit));
+}
+
 void IndividualHost::terminate() {
     // NOTE: This technically shouldn't be needed, but in Wine 6.5 sending
     //       SIGKILL to a Wine process no longer terminates the threads spawned
@@ -251,6 +292,13 @@ bool GroupHost::running() noexcept {
     return !startup_failed_;
 }
 
+ProcessWatchdog::Guard GroupHost::watch(ProcessWatchdog::Callback on_exit) {
+    // The group host process we may have spawned can exit without this being a
+    // failure, so this needs to be polled
+    return host_process_watchdog().watch([this]() { return running(); },
+                                         std::move(on_exit));
+}
+
 void GroupHost::terminate() {
     // There's no need to manually terminate group host processes as they will
     // shut down automatically after all plugins have exited. Manually closing
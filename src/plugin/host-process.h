@@ -26,9 +26,17 @@
 #include "../common/communication/common.h"
 #include "../common/logging/common.h"
 #include "../common/plugins.h"
+#include "../common/process-watchdog.h"
 #include "../common/serialization/common.h"
 #include "utils.h"
 
+/**
+ * The watchdog shared by all plugin instances in this process. This is used to
+ * detect Wine plugin host processes that fail to start. It runs on its own
+ * thread, which gets started the first time this function is called.
+ */
+ProcessWatchdog& host_process_watchdog();
+
 /**
  * Encapsulates the behavior of launching a host process or connecting to an
  * existing one. This is needed because plugins groups require slightly
@@ -52,6 +60,16 @@ class HostProcess {
      */
     virtual bool running() = 0;
 
+    /**
+     * Call `on_exit` from the shared watchdog thread once the host process has
+     * exited, or once we failed to connect to a group host process. Used during
+     * startup to abort connecting to sockets if the Wine process has crashed.
+     * The process is watched until the returned guard gets dropped.
+     *
+     * @see host_process_watchdog
+     */
+    virtual ProcessWatchdog::Guard watch(ProcessWatchdog::Callback on_exit) = 0;
+
     /**
      * Kill the process or cause the plugin that's being hosted to exit.
      */
@@ -149,6 +167,7 @@ class IndividualHost : public HostProcess {
 
     ghc::filesystem::path path() override;
     bool running() override;
+    ProcessWatchdog::Guard watch(ProcessWatchdog::Callback on_exit) override;
     void terminate() override;
 
    private:
@@ -197,6 +216,7 @@ class GroupHost : public HostProcess {
 
     ghc::filesystem::path path() override;
     bool running() noexcept override;
+    ProcessWatchdog::Guard watch(ProcessWatchdog::Callback on_exit) override;
     void terminate() override;
 
    private:
@@ -0,0 +1,469 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <rigtorp/MPMCQueue.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * The maximum number of display strings `ParameterValueCache` remembers before
+ * it starts evicting the least recently used ones. Hosts generally only ask for
+ * the display strings of the values that are currently visible, so this
+ * comfortably covers a couple of generic editors and automation lanes.
+ */
+constexpr size_t max_cached_parameter_display_strings = 4096;
+
+/**
+ * The number of value changes `ParameterValueCache::update_value()` can queue
+ * up while another thread is using the cache. If more changes come in before
+ * the cache gets used again, then all cached values are cleared instead.
+ */
+constexpr size_t max_pending_parameter_value_updates = 256;
+
+/**
+ * The number of parameters fetched at once when `SequentialAccessDetector`
+ * detects that the host is walking through all of a plugin's parameters.
+ */
+constexpr size_t parameter_prefetch_batch_size = 64;
+
+/**
+ * A per-instance cache for a VST3 or CLAP plugin's current parameter values and
+ * for the display strings of parameter values. Hosts like Bitwig and REAPER
+ * query these for every visible parameter every time they redraw a generic
+ * editor or an automation lane, and every one of those calls would otherwise
+ * be a round trip to the Wine plugin host's main thread.
+ *
+ * Values are only cached after they've been queried once. The plugin proxies
+ * keep the cached values up to date using the value changes they see pass
+ * through, such as parameter edits reported by the plugin and the output
+ * parameter changes from audio processing. Everything is cleared when the
+ * plugin tells the host that its parameter values or the parameters themselves
+ * have changed, since a display string for the same value may then change as
+ * well. The same happens when the plugin's state gets restored.
+ *
+ * Display strings are stored per `(parameter ID, value)` pair in a bounded LRU
+ * cache.
+ *
+ * Since the actual values are fetched without holding the cache's lock, a value
+ * that was fetched while the plugin reported a new value for that parameter
+ * would be stale. `begin_fetch()` should be called before fetching values from
+ * the plugin, and `store_value()` will then discard a value if that parameter
+ * changed in the meantime, storing the value the plugin reported during the
+ * fetch instead if there was one. Changes to other parameters don't affect the
+ * fetch, so a plugin that constantly reports output parameter changes does not
+ * prevent the cache from being filled. `store_text()` only discards a display
+ * string if the cache got cleared during the fetch.
+ *
+ * @tparam String The string type used for the display strings. This is
+ *   `std::u16string` for VST3 and `std::string` for CLAP.
+ */
+template <typename String>
+class ParameterValueCache {
+   public:
+    ParameterValueCache()
+        : pending_updates_(max_pending_parameter_value_updates) {}
+
+    /**
+     * Marks one or more parameters as being fetched from the plugin for as
+     * long as this object is alive. Returned by `begin_fetch()`, and passed to
+     * `store_value()` and `store_text()` after the values have been fetched.
+     */
+    class Fetch {
+       public:
+        ~Fetch() noexcept {
+            std::lock_guard lock(cache_.mutex_);
+            for (const auto& [param_id, _] : params_) {
+                const auto it = cache_.in_flight_.find(param_id);
+                if (it != cache_.in_flight_.end() &&
+                    --it->second.fetches == 0) {
+                    cache_.in_flight_.erase(it);
+                }
+            }
+        }
+
+        Fetch(const Fetch&) = delete;
+        Fetch& operator=(const Fetch&) = delete;
+
+       private:
+        Fetch(ParameterValueCache& cache, std::span<const uint32_t> param_ids)
+            : cache_(cache) {
+            std::lock_guard lock(cache_.mutex_);
+            cache_.apply_pending_updates();
+
+            clears_ = cache_.clears_;
+            params_.reserve(param_ids.size());
+            for (const uint32_t param_id : param_ids) {
+                InFlightValue& in_flight = cache_.in_flight_[param_id];
+                in_flight.fetches++;
+                params_.emplace_back(param_id, in_flight.changes);
+            }
+        }
+
+        /**
+         * Whether `param_id` is part of this fetch and has not changed since
+         * the fetch started. `cache_.mutex_` should be locked when calling
+         * this.
+         */
+        bool unchanged(uint32_t param_id) const noexcept {
+            const auto param = std::find_if(
+                params_.begin(), params_.end(),
+                [&](const auto& fetched) { return fetched.first == param_id; });
+            const auto in_flight = cache_.in_flight_.find(param_id);
+
+            return param != params_.end() &&
+                   in_flight != cache_.in_flight_.end() &&
+                   in_flight->second.changes == param->second;
+        }
+
+        ParameterValueCache& cache_;
+        /**
+         * The number of times the cache had been cleared when the fetch
+         * started.
+         */
+        uint64_t clears_ = 0;
+        /**
+         * The fetched parameter IDs, along with their `InFlightValue::changes`
+         * when the fetch started.
+         */
+        std::vector<std::pair<uint32_t, uint64_t>> params_;
+
+        friend ParameterValueCache;
+    };
+
+    /**
+     * Get the cached value for a parameter, if we have one.
+     */
+    std::optional<double> value(uint32_t param_id) {
+        std::lock_guard lock(mutex_);
+        apply_pending_updates();
+        if (const auto it = values_.find(param_id); it != values_.end()) {
+            return it->second;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    /**
+     * Get the cached display string for a parameter value, if we have one. This
+     * marks the entry as most recently used.
+     */
+    std::optional<String> text(uint32_t param_id, double value) {
+        std::lock_guard lock(mutex_);
+        const auto it = text_index_.find(text_key(param_id, value));
+        if (it == text_index_.end()) {
+            return std::nullopt;
+        }
+
+        texts_.splice(texts_.begin(), texts_, it->second);
+        return it->second->second;
+    }
+
+    /**
+     * Mark parameters as being fetched from the plugin. This should be called
+     * before sending the request, and the returned object should be kept alive
+     * until the results have been passed to `store_value()` and
+     * `store_text()`.
+     */
+    Fetch begin_fetch(std::span<const uint32_t> param_ids) {
+        return Fetch(*this, param_ids);
+    }
+
+    /**
+     * @overload
+     */
+    Fetch begin_fetch(uint32_t param_id) {
+        return Fetch(*this, std::span(&param_id, 1));
+    }
+
+    /**
+     * Store a value we fetched from the plugin, unless the parameter's value
+     * has changed since `fetch` was started. If the plugin reported a new
+     * value for the parameter in the meantime, then that value is stored
+     * instead. This way a parameter that's modulated during a batched fetch
+     * still ends up in the cache.
+     */
+    void store_value(uint32_t param_id, double value, const Fetch& fetch) {
+        std::lock_guard lock(mutex_);
+        apply_pending_updates();
+        if (fetch.unchanged(param_id)) {
+            values_[param_id] = value;
+        } else if (const auto it = in_flight_.find(param_id);
+                   it != in_flight_.end() && it->second.reported_value) {
+            // If another fetch already stored a value, then that value is at
+            // least as recent as the reported one
+            values_.try_emplace(param_id, *it->second.reported_value);
+        }
+    }
+
+    /**
+     * Store a display string we fetched from the plugin, unless the cache has
+     * been cleared since `fetch` was started. If the cache is full, then the
+     * least recently used display string is evicted.
+     */
+    void store_text(uint32_t param_id,
+                    double value,
+                    String text,
+                    const Fetch& fetch) {
+        std::lock_guard lock(mutex_);
+        if (fetch.clears_ != clears_) {
+            return;
+        }
+
+        const TextKey key = text_key(param_id, value);
+        if (const auto it = text_index_.find(key); it != text_index_.end()) {
+            it->second->second = std::move(text);
+            texts_.splice(texts_.begin(), texts_, it->second);
+            return;
+        }
+
+        if (texts_.size() >= max_cached_parameter_display_strings) {
+            text_index_.erase(texts_.back().first);
+            texts_.pop_back();
+        }
+
+        texts_.emplace_front(key, std::move(text));
+        text_index_.emplace(key, texts_.begin());
+    }
+
+    /**
+     * Set a parameter's value after the plugin reported that the value has
+     * changed. Unlike `store_value()`, this will only update parameters that
+     * are already in the cache, so this never allocates. This is called from
+     * the audio thread, so it never waits for the lock. If another thread is
+     * currently using the cache, then the update is queued and applied the
+     * next time the cache is used.
+     */
+    void update_value(uint32_t param_id, double value) noexcept {
+        std::unique_lock lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            // If the queue is full, then we can no longer tell which values
+            // are out of date
+            if (!pending_updates_.try_push(PendingUpdate{param_id, value})) {
+                pending_updates_overflowed_.store(true,
+                                                  std::memory_order_release);
+            }
+
+            return;
+        }
+
+        apply_pending_updates();
+        apply_update(param_id, value);
+    }
+
+    /**
+     * Remove a parameter's value from the cache. This is used when the host
+     * sets a parameter's value, since the plugin may end up storing a slightly
+     * different value.
+     */
+    void invalidate_value(uint32_t param_id) noexcept {
+        std::lock_guard lock(mutex_);
+        apply_pending_updates();
+        values_.erase(param_id);
+        if (const auto it = in_flight_.find(param_id); it != in_flight_.end()) {
+            it->second.changes++;
+            it->second.reported_value.reset();
+        }
+    }
+
+    /**
+     * Clear all cached values and display strings.
+     */
+    void clear() noexcept {
+        std::lock_guard lock(mutex_);
+        apply_pending_updates();
+        clear_values();
+        texts_.clear();
+        text_index_.clear();
+
+        clears_++;
+    }
+
+   private:
+    /**
+     * A value change reported while another thread was holding `mutex_`.
+     */
+    struct PendingUpdate {
+        uint32_t param_id;
+        double value;
+    };
+
+    /**
+     * Bookkeeping for a parameter that's currently being fetched from the
+     * plugin.
+     */
+    struct InFlightValue {
+        /**
+         * The number of `Fetch` objects for this parameter.
+         */
+        size_t fetches = 0;
+        /**
+         * Incremented every time this parameter's value changes. A fetched
+         * value is only stored if this did not change during the fetch.
+         */
+        uint64_t changes = 0;
+        /**
+         * The last value the plugin reported for this parameter while it was
+         * being fetched. This is reset when the value gets invalidated.
+         */
+        std::optional<double> reported_value;
+    };
+
+    /**
+     * A parameter ID and the bit representation of a value, so we don't have
+     * to hash floating point numbers.
+     */
+    using TextKey = std::pair<uint32_t, uint64_t>;
+
+    struct TextKeyHash {
+        size_t operator()(const TextKey& key) const noexcept {
+            return std::hash<uint64_t>{}(key.second ^
+                                         (static_cast<uint64_t>(key.first)
+                                          << 32));
+        }
+    };
+
+    static TextKey text_key(uint32_t param_id, double value) noexcept {
+        return TextKey(param_id, std::bit_cast<uint64_t>(value));
+    }
+
+    /**
+     * Update a cached value and mark any fetch for the parameter as out of
+     * date. `mutex_` should be locked when calling this.
+     */
+    void apply_update(uint32_t param_id, double value) noexcept {
+        if (const auto it = values_.find(param_id); it != values_.end()) {
+            it->second = value;
+        }
+        if (const auto it = in_flight_.find(param_id); it != in_flight_.end()) {
+            it->second.changes++;
+            it->second.reported_value = value;
+        }
+    }
+
+    /**
+     * Apply the updates `update_value()` queued because it could not acquire
+     * the lock. If the queue overflowed, then all cached values are cleared
+     * instead. `mutex_` should be locked when calling this.
+     */
+    void apply_pending_updates() noexcept {
+        PendingUpdate update;
+        while (pending_updates_.try_pop(update)) {
+            apply_update(update.param_id, update.value);
+        }
+
+        if (pending_updates_overflowed_.exchange(false,
+                                                 std::memory_order_acquire)) {
+            clear_values();
+        }
+    }
+
+    /**
+     * Clear all cached values and mark all fetches as out of date. `mutex_`
+     * should be locked when calling this.
+     */
+    void clear_values() noexcept {
+        values_.clear();
+        for (auto& [_, in_flight] : in_flight_) {
+            in_flight.changes++;
+            in_flight.reported_value.reset();
+        }
+    }
+
+    std::mutex mutex_;
+    /**
+     * The number of times the cache has been cleared. Display strings only
+     * depend on the parameter ID and the value, so those only need to be
+     * discarded when the cache got cleared during a fetch.
+     */
+    uint64_t clears_ = 0;
+
+    std::unordered_map<uint32_t, double> values_;
+
+    /**
+     * The parameters that are currently being fetched from the plugin.
+     *
+     * @see Fetch
+     */
+    std::unordered_map<uint32_t, InFlightValue> in_flight_;
+
+    /**
+     * Value changes `update_value()` could not apply right away because
+     * another thread was holding `mutex_`. These are applied in order the next
+     * time the cache is used.
+     */
+    rigtorp::MPMCQueue<PendingUpdate> pending_updates_;
+    /**
+     * Set when `pending_updates_` was full, in which case all cached values
+     * are cleared the next time the cache is used.
+     */
+    std::atomic_bool pending_updates_overflowed_ = false;
+
+    /**
+     * The display strings, ordered from most to least recently used.
+     */
+    std::list<std::pair<TextKey, String>> texts_;
+    std::unordered_map<TextKey,
+                       typename std::list<std::pair<TextKey, String>>::iterator,
+                       TextKeyHash>
+        text_index_;
+};
+
+/**
+ * Some hosts walk through all of a plugin's parameters in a loop when loading a
+ * project or after a preset change, querying every parameter's value and
+ * display string one by one. This detects that access pattern based on the
+ * parameter indices of the cache misses in `ParameterValueCache`, so the next
+ * `parameter_prefetch_batch_size` parameters can be fetched in a single
+ * message instead.
+ */
+class SequentialAccessDetector {
+   public:
+    /**
+     * Record a cache miss for the parameter at `index`. Returns `true` if this
+     * miss directly follows a miss for the previous parameter, or if it
+     * directly follows the last prefetched block. In that case the caller
+     * should prefetch the parameters starting at `index`, and then call
+     * `record_prefetch()`.
+     */
+    bool record_miss(size_t index) noexcept {
+        return next_expected_index_.exchange(index + 1,
+                                             std::memory_order_relaxed) ==
+               index;
+    }
+
+    /**
+     * Record that all parameters up to (but not including) `end_index` have
+     * been prefetched, so a cache miss for `end_index` continues the pattern.
+     */
+    void record_prefetch(size_t end_index) noexcept {
+        next_expected_index_.store(end_index, std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic_size_t next_expected_index_ = SIZE_MAX;
+};
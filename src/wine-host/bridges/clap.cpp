@@ -153,10 +153,22 @@ ClapBridge::ClapBridge(MainContext& main_context,
     // Fetch this instance's configuration from the plugin to finish the setup
     // process
     config_ = sockets_.plugin_host_main_thread_callback_.send_message(
-        WantsConfiguration{.host_version = yabridge_git_version}, std::nullopt);
+        WantsConfiguration{.host_version = yabridge_git_version,
+                           .host_supports_compression =
+                               is_compression_available()},
+        std::nullopt);
+    if (config_.compress_large_messages) {
+        sockets_.enable_compression();
+    }
 
     // Allow this plugin to configure the main context's tick rate
     main_context.update_timer_interval(config_.event_loop_interval());
+    SerializationBufferPool::global().limit_idle_timeout(
+        config_.buffer_idle_timeout_duration());
+    if (config_.gui_stall_threshold) {
+        main_context.enable_stall_detector(
+            config_.gui_stall_threshold_duration());
+    }
 }
 
 bool ClapBridge::inhibits_event_loop() noexcept {
@@ -600,9 +612,10 @@ void ClapBridge::run() {
                     [&, plugin = instance.plugin.get(),
                      gui = instance.extensions.gui,
                      &editor = instance.editor]() {
-                        Editor& editor_instance =
-                            editor.emplace(main_context_, config_,
-                                           generic_logger_, request.x11_window);
+                        Editor& editor_instance = editor.emplace(
+                            main_context_, config_, generic_logger_,
+                            plugin_path_.filename().string(),
+                            request.x11_window);
 
                         const clap_window_t window{
                             .api = CLAP_WINDOW_API_WIN32,
@@ -767,6 +780,35 @@ void ClapBridge::run() {
                         .result = std::nullopt};
                 }
             },
+            [&](const clap::ext::params::plugin::GetValues& request)
+                -> clap::ext::params::plugin::GetValues::Response {
+                const auto& [instance, _] = get_instance(request.instance_id);
+
+                // Like above, these are called directly from this thread
+                std::vector<clap::ext::params::plugin::ValueAndText> values;
+                values.reserve(request.param_ids.size());
+                for (const clap_id param_id : request.param_ids) {
+                    clap::ext::params::plugin::ValueAndText& result =
+                        values.emplace_back();
+
+                    double value;
+                    if (!instance.extensions.params->get_value(
+                            instance.plugin.get(), param_id, &value)) {
+                        continue;
+                    }
+                    result.value = value;
+
+                    std::array<char, 1024> display{0};
+                    if (instance.extensions.params->value_to_text(
+                            instance.plugin.get(), param_id, value,
+                            display.data(), display.size())) {
+                        result.text = display.data();
+                    }
+                }
+
+                return clap::ext::params::plugin::GetValuesResponse{
+                    .values = std::move(values)};
+            },
             [&](const clap::ext::params::plugin::ValueToText& request)
                 -> clap::ext::params::plugin::ValueToText::Response {
                 const auto& [instance, _] = get_instance(request.instance_id);
@@ -857,12 +899,19 @@ void ClapBridge::run() {
                 -> clap::ext::state::plugin::Load::Response {
                 const auto& [instance, _] = get_instance(request.instance_id);
 
-                return main_context_
-                    .run_in_context([&, plugin = instance.plugin.get(),
-                                     state = instance.extensions.state]() {
-                        return state->load(plugin, request.stream.istream());
-                    })
-                    .get();
+                const auto load = [&, plugin = instance.plugin.get(),
+                                   state = instance.extensions.state]() {
+                    return state->load(plugin, request.stream.istream());
+                };
+
+                // `clap_plugin_state::load()` is a main thread function, but
+                // plugins that don't mind can be allowed to restore their state
+                // in parallel
+                if (config_.parallel_state_restore) {
+                    return run_state_restore(load);
+                } else {
+                    return main_context_.run_in_context(load).get();
+                }
             },
             [&](clap::ext::voice_info::plugin::Get& request)
                 -> clap::ext::voice_info::plugin::Get::Response {
@@ -1063,6 +1112,18 @@ void ClapBridge::register_plugin_instance(
     std::promise<void> socket_listening_latch;
     object_instances_.at(instance_id)
         .audio_thread_handler = Win32Thread([&, instance_id]() {
+        // Messages on this socket are always about this instance, so we'll
+        // hold on to a direct reference instead of looking it up through
+        // `get_instance()` for every message. That way the audio thread never
+        // has to wait for `object_instances_mutex_` while another instance is
+        // being created or destroyed. References to elements in an
+        // `std::unordered_map` stay valid until the element is erased, and
+        // `unregister_plugin_instance()` joins this thread before doing so. We
+        // can't take the lock here since this function holds the exclusive
+        // lock until the socket is listening, which also means that this
+        // lookup can't race with anything.
+        ClapPluginInstance& instance = object_instances_.at(instance_id);
+
         set_realtime_priority(true);
 
         // XXX: Like with VST2 worker threads, when using plugin groups the
@@ -1075,28 +1136,19 @@ void ClapBridge::register_plugin_instance(
         sockets_.add_audio_thread_and_listen_control(
             instance_id, socket_listening_latch,
             overload{
-                [&](const clap::plugin::StartProcessing& request)
+                [&](const clap::plugin::StartProcessing&)
                     -> clap::plugin::StartProcessing::Response {
-                    const auto& [instance, _] =
-                        get_instance(request.instance_id);
-
                     return instance.plugin->start_processing(
                         instance.plugin.get());
                 },
-                [&](const clap::plugin::StopProcessing& request)
+                [&](const clap::plugin::StopProcessing&)
                     -> clap::plugin::StopProcessing::Response {
-                    const auto& [instance, _] =
-                        get_instance(request.instance_id);
-
                     instance.plugin->stop_processing(instance.plugin.get());
 
                     return Ack{};
                 },
-                [&](const clap::plugin::Reset& request)
+                [&](const clap::plugin::Reset&)
                     -> clap::plugin::Reset::Response {
-                    const auto& [instance, _] =
-                        get_instance(request.instance_id);
-
                     instance.plugin->reset(instance.plugin.get());
 
                     return Ack{};
@@ -1119,9 +1171,6 @@ void ClapBridge::register_plugin_instance(
                                               *request.new_realtime_priority);
                     }
 
-                    const auto& [instance, _] =
-                        get_instance(request.instance_id);
-
                     // Most plugins will already enable FTZ, but there are a
                     // handful of plugins that don't that suffer from extreme
                     // DSP load increases when they start producing denormals
@@ -1159,9 +1208,6 @@ void ClapBridge::register_plugin_instance(
                 },
                 [&](clap::ext::params::plugin::Flush& request)
                     -> clap::ext::params::plugin::Flush::Response {
-                    const auto& [instance, _] =
-                        get_instance(request.instance_id);
-
                     clap::events::EventList out{};
                     instance.extensions.params->flush(instance.plugin.get(),
                                                       request.in.input_events(),
@@ -1170,11 +1216,8 @@ void ClapBridge::register_plugin_instance(
                     return clap::ext::params::plugin::FlushResponse{
                         .out = std::move(out)};
                 },
-                [&](const clap::ext::tail::plugin::Get& request)
+                [&](const clap::ext::tail::plugin::Get&)
                     -> clap::ext::tail::plugin::Get::Response {
-                    const auto& [instance, _] =
-                        get_instance(request.instance_id);
-
                     return instance.extensions.tail->get(instance.plugin.get());
                 },
             });
@@ -1189,6 +1232,16 @@ void ClapBridge::register_plugin_instance(
 void ClapBridge::unregister_plugin_instance(size_t instance_id) {
     sockets_.remove_audio_thread(instance_id);
 
+    // The audio thread holds a direct reference to the instance, so it needs to
+    // have exited before the instance can be removed. This is the only place
+    // where instances get removed, so the reference remains valid after
+    // `get_instance()` releases its lock.
+    {
+        ClapPluginInstance& instance = get_instance(instance_id).first;
+        const Win32Thread audio_thread_handler =
+            std::move(instance.audio_thread_handler);
+    }
+
     // Remove the instance from within the main IO context so
     // removing it doesn't interfere with the Win32 message loop
     // NOTE: This will implicitly run `clap_plugin::destroy()` as part of the
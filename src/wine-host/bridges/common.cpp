@@ -16,8 +16,11 @@
 
 #include "common.h"
 
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 
+#include "../../common/buffer-pool.h"
 #include "../../common/process.h"
 #include "../editor.h"
 
@@ -55,21 +58,84 @@ HostBridge::HostBridge(MainContext& main_context,
       main_context_(main_context),
       generic_logger_(Logger::create_wine_stderr()),
       parent_pid_(parent_pid),
-      watchdog_guard_(main_context.register_watchdog(*this)) {}
+      watchdog_guard_(main_context.register_watchdog(*this, parent_pid)) {}
 
-void HostBridge::handle_events() noexcept {
+HostBridge::~HostBridge() noexcept {
+    // Any buffers that were used by this instance that have been idle for long
+    // enough can be freed now
+    SerializationBufferPool::global().trim();
+    log_memory_usage("after unloading");
+}
+
+bool HostBridge::handle_events(MainContext& main_context) noexcept {
     MSG msg;
 
     int limit = max_win32_messages;
-    for (int i = 0; i < limit && PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE);
-         i++) {
+    int i = 0;
+    for (; i < limit && PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE); i++) {
         // HACK: See the docstring on `juce_win32_message_limit`
         if (msg.message == juce_message_id) {
             limit = extended_max_win32_messages;
         }
 
         TranslateMessage(&msg);
-        DispatchMessage(&msg);
+
+        // Messages for an editor's windows are attributed to that editor. The
+        // editor may be closed while handling the message, so we need to look
+        // it up again afterwards.
+        if (Editor* editor = find_editor_for_window(msg.hwnd)) {
+            // Timers for editors that are being redrawn more often than the
+            // `editor_max_frame_rate` option allows are held back. Windows
+            // will send the next `WM_TIMER` message when the timer fires
+            // again.
+            if (msg.message == WM_TIMER &&
+                editor->should_defer_timer(msg.hwnd, msg.wParam)) {
+                continue;
+            }
+
+            MainContext::GuiActivityGuard activity(
+                main_context, editor->activity_description());
+
+            const auto dispatch_start = std::chrono::steady_clock::now();
+            DispatchMessage(&msg);
+            const auto dispatch_end = std::chrono::steady_clock::now();
+
+            if (Editor* current_editor = find_editor_for_window(msg.hwnd)) {
+                current_editor->record_dispatch_time(dispatch_end -
+                                                     dispatch_start);
+            }
+        } else {
+            DispatchMessage(&msg);
+        }
+    }
+
+    return i > 0;
+}
+
+void HostBridge::log_memory_usage(const std::string& event) noexcept {
+    try {
+        const std::optional<MemoryUsage> usage = get_memory_usage();
+        if (!usage) {
+            return;
+        }
+
+        const auto mebibytes = [](size_t bytes) {
+            return static_cast<double>(bytes) / (1 << 20);
+        };
+
+        SerializationBufferPool& pool = SerializationBufferPool::global();
+        std::ostringstream message;
+        message << std::fixed << std::setprecision(1) << "Memory usage "
+                << event << " '" << plugin_path_.filename().string()
+                << "': " << mebibytes(usage->resident_bytes)
+                << " MiB resident, " << mebibytes(usage->peak_resident_bytes)
+                << " MiB peak, " << mebibytes(pool.pooled_bytes())
+                << " MiB in idle buffers, largest buffer "
+                << mebibytes(pool.peak_buffer_size()) << " MiB";
+
+        generic_logger_.log(message.str());
+    } catch (...) {
+        // This is purely informational
     }
 }
 
@@ -37,7 +37,11 @@ class HostBridge {
                pid_t parent_pid);
 
    public:
-    virtual ~HostBridge() noexcept = default;
+    /**
+     * Reports this process's memory usage high-water mark after the plugin has
+     * been unloaded. See `log_memory_usage()`.
+     */
+    virtual ~HostBridge() noexcept;
 
     /**
      * If a plugin instance returns `true` here, then the event loop should not
@@ -84,8 +88,18 @@ class HostBridge {
      * specific situation that can cause a race condition in some plugins
      * because of incorrect assumptions made by the plugin. See the dostring for
      * `Vst2Bridge::editor` for more information.
+     *
+     * Messages sent to an editor's windows are timed and attributed to that
+     * editor, both for the editor's own timing statistics and for the GUI
+     * stall detector.
+     *
+     * @param main_context The main IO context, used to mark the GUI thread as
+     *   being busy with a specific plugin's editor for the stall detector.
+     *
+     * @return Whether any messages were handled. The event loop backs off when
+     *   this keeps returning `false`.
      */
-    static void handle_events() noexcept;
+    static bool handle_events(MainContext& main_context) noexcept;
 
     /**
      * Used as part of the watchdog. This will check whether the remote host
@@ -116,6 +130,19 @@ class HostBridge {
      */
     virtual void close_sockets() = 0;
 
+    /**
+     * Log this process's current and peak resident set size, together with how
+     * much memory is held by idle serialization buffers and the largest buffer
+     * that has been used so far. When hosting plugins in a group these values
+     * are shared by all plugins in the group, but logging them when each
+     * instance is unloaded still makes it possible to see which instances cause
+     * the peak to go up.
+     *
+     * @param event A description of when this is being logged, e.g. "after
+     *   unloading".
+     */
+    void log_memory_usage(const std::string& event) noexcept;
+
     /**
      * A logger, just like we have on the plugin side. This is normally not
      * needed because we can just print to STDERR, but this way we can
@@ -129,15 +156,14 @@ class HostBridge {
     /**
      * The process ID of the native plugin host we are bridging for. This should
      * be the parent, but it might not be because of Wine's startup script,
-     * `WINELOADER`s and Wine's `start.exe` behaviour. We'll periodically check
-     * if this process is still alive, and close the sockets if it is not to
-     * prevent dangling processes.
+     * `WINELOADER`s and Wine's `start.exe` behaviour. We'll watch this process
+     * and close the sockets when it exits to prevent dangling processes.
      */
     const pid_t parent_pid_;
 
     /**
-     * A guard that, while in scope, will cause `shutdown_if_dangling()` to
-     * periodically be called.
+     * A guard that, while in scope, will cause `shutdown_if_dangling()` to be
+     * called when the native plugin host exits.
      */
     MainContext::WatchdogGuard watchdog_guard_;
 };
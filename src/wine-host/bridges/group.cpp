@@ -88,6 +88,52 @@ StdIoCapture::~StdIoCapture() noexcept {
     close(pipe_fd_[0]);
 }
 
+DedicatedGuiThread::DedicatedGuiThread(size_t plugin_id,
+                                       BridgeFactory create_bridge)
+    : main_context_(),
+      gui_thread_([this, plugin_id,
+                   create_bridge = std::move(create_bridge)]() {
+          const std::string thread_name = "gui-" + std::to_string(plugin_id);
+          pthread_setname_np(pthread_self(), thread_name.c_str());
+
+          try {
+              bridge_ = create_bridge(main_context_);
+          } catch (...) {
+              bridge_promise_.set_exception(std::current_exception());
+              return;
+          }
+          bridge_promise_.set_value(bridge_.get());
+
+          // This is the same event loop `yabridge-host.exe` runs for
+          // individually hosted plugins
+          main_context_.async_handle_events(
+              [&]() { return HostBridge::handle_events(main_context_); },
+              [&]() { return !bridge_->inhibits_event_loop(); });
+          main_context_.run();
+
+          // The plugin has to be unloaded from the same thread it was created
+          // on, see `GroupBridge::handle_plugin_run()`
+          bridge_.reset();
+      }) {}
+
+DedicatedGuiThread::~DedicatedGuiThread() noexcept {
+    // If `stop()` was called then the thread will shut down on its own after
+    // it has run all pending tasks. This is needed when the group process
+    // shuts down while the plugin is still running.
+    if (!stop_requested_) {
+        main_context_.stop();
+    }
+}
+
+HostBridge* DedicatedGuiThread::wait_for_bridge() {
+    return bridge_promise_.get_future().get();
+}
+
+void DedicatedGuiThread::stop() {
+    stop_requested_ = true;
+    main_context_.schedule_task([this]() { main_context_.stop(); });
+}
+
 GroupBridge::GroupBridge(ghc::filesystem::path group_socket_path)
     : logger_(Logger::create_from_environment(
           create_logger_prefix(group_socket_path))),
@@ -125,9 +171,9 @@ GroupBridge::~GroupBridge() noexcept {
 bool GroupBridge::is_event_loop_inhibited() noexcept {
     std::lock_guard lock(active_plugins_mutex_);
 
-    for (auto& [parameters, value] : active_plugins_) {
-        auto& [thread, bridge] = value;
-        if (bridge->inhibits_event_loop()) {
+    for (auto& [plugin_id, plugin] : active_plugins_) {
+        // Plugins with their own GUI thread don't touch the group's event loop
+        if (plugin.bridge && plugin.bridge->inhibits_event_loop()) {
             return true;
         }
     }
@@ -135,7 +181,9 @@ bool GroupBridge::is_event_loop_inhibited() noexcept {
     return false;
 }
 
-void GroupBridge::handle_plugin_run(size_t plugin_id, HostBridge* bridge) {
+void GroupBridge::handle_plugin_run(size_t plugin_id,
+                                    HostBridge* bridge,
+                                    DedicatedGuiThread* dedicated_gui_thread) {
     // Blocks this thread until the plugin shuts down
     bridge->run();
 
@@ -145,6 +193,13 @@ void GroupBridge::handle_plugin_run(size_t plugin_id, HostBridge* bridge) {
     const std::string plugin_path = bridge->plugin_path_.string();
     logger_.log("'" + plugin_path + "' has exited");
 
+    // Plugins with their own GUI thread get unloaded from that thread.
+    // Removing the plugin from `active_plugins_` below will wait for that
+    // thread to finish.
+    if (dedicated_gui_thread) {
+        dedicated_gui_thread->stop();
+    }
+
     // After the plugin has exited we'll remove this thread's plugin from the
     // active plugins. This is done within the IO context because the call to
     // `FreeLibrary()` has to be done from the main thread, or else we'll
@@ -213,66 +268,90 @@ void GroupBridge::accept_requests() {
                 // take longer to initialize if it is new
                 shutdown_timer_.cancel();
 
-                std::unique_ptr<HostBridge> bridge = nullptr;
-                switch (request.plugin_type) {
-                    case PluginType::clap:
+                const auto create_bridge = [request](MainContext& main_context)
+                    -> std::unique_ptr<HostBridge> {
+                    switch (request.plugin_type) {
+                        case PluginType::clap:
 #ifdef WITH_CLAP
-                        bridge = std::make_unique<ClapBridge>(
-                            main_context_, request.plugin_path,
-                            request.endpoint_base_dir, request.parent_pid);
+                            return std::make_unique<ClapBridge>(
+                                main_context, request.plugin_path,
+                                request.endpoint_base_dir, request.parent_pid);
 #else
-                        throw std::runtime_error(
-                            "This version of yabridge has not been compiled "
-                            "with CLAP support");
+                            throw std::runtime_error(
+                                "This version of yabridge has not been "
+                                "compiled with CLAP support");
 #endif
-                        break;
-                    case PluginType::vst2:
-                        bridge = std::make_unique<Vst2Bridge>(
-                            main_context_, request.plugin_path,
-                            request.endpoint_base_dir, request.parent_pid);
-                        break;
-                    case PluginType::vst3:
+                        case PluginType::vst2:
+                            return std::make_unique<Vst2Bridge>(
+                                main_context, request.plugin_path,
+                                request.endpoint_base_dir, request.parent_pid);
+                        case PluginType::vst3:
 #ifdef WITH_VST3
-                        bridge = std::make_unique<Vst3Bridge>(
-                            main_context_, request.plugin_path,
-                            request.endpoint_base_dir, request.parent_pid);
+                            return std::make_unique<Vst3Bridge>(
+                                main_context, request.plugin_path,
+                                request.endpoint_base_dir, request.parent_pid);
 #else
-                        throw std::runtime_error(
-                            "This version of yabridge has not been compiled "
-                            "with VST3 support");
+                            throw std::runtime_error(
+                                "This version of yabridge has not been "
+                                "compiled with VST3 support");
 #endif
-                        break;
-                    case PluginType::unknown:
-                        throw std::runtime_error(
-                            "Invalid plugin host request received, how did you "
-                            "even manage to do this?");
-                        break;
+                        case PluginType::unknown:
+                            break;
+                    }
+
+                    throw std::runtime_error(
+                        "Invalid plugin host request received, how did you "
+                        "even manage to do this?");
+                };
+
+                // Plugins with the `group_dedicated_gui_thread` option get
+                // created on their own GUI thread with its own `MainContext`.
+                // We'll still wait for the plugin to finish initializing
+                // before accepting the next request, so plugins in a group
+                // are always loaded one at a time.
+                const size_t plugin_id = next_plugin_id_.fetch_add(1);
+                ActivePlugin plugin{};
+                HostBridge* plugin_ptr = nullptr;
+                if (request.dedicated_gui_thread) {
+                    plugin.dedicated_gui_thread =
+                        std::make_unique<DedicatedGuiThread>(plugin_id,
+                                                             create_bridge);
+                    plugin_ptr = plugin.dedicated_gui_thread->wait_for_bridge();
+                } else {
+                    plugin.bridge = create_bridge(main_context_);
+                    plugin_ptr = plugin.bridge.get();
                 }
 
                 logger_.log("Finished initializing '" + request.plugin_path +
-                            "'");
+                            "'" +
+                            (request.dedicated_gui_thread
+                                 ? " on a dedicated GUI thread"
+                                 : ""));
 
                 // Start listening for dispatcher events sent to the plugin's
                 // socket on another thread. Parts of the actual event handling
-                // will still be posted to this IO context so that any events
-                // that potentially interact with the Win32 message loop are
-                // handled from the main thread. We also pass a raw pointer to
-                // the plugin so we don't have to immediately look the instance
-                // up in the map again, as this would require us to immediately
-                // lock the map again. This could otherwise result in a deadlock
-                // when using the Spitfire plugins, as they will block the
-                // message loop until `effOpen()` has been called and thus
-                // prevent this lock from happening.
-                const size_t plugin_id = next_plugin_id_.fetch_add(1);
-                active_plugins_[plugin_id] = std::pair(
-                    Win32Thread([this, plugin_id, plugin_ptr = bridge.get()]() {
+                // will still be posted to this IO context (or to the plugin's
+                // own GUI thread) so that any events that potentially interact
+                // with the Win32 message loop are handled from the main
+                // thread. We also pass a raw pointer to the plugin so we don't
+                // have to immediately look the instance up in the map again,
+                // as this would require us to immediately lock the map again.
+                // This could otherwise result in a deadlock when using the
+                // Spitfire plugins, as they will block the message loop until
+                // `effOpen()` has been called and thus prevent this lock from
+                // happening.
+                plugin.worker_thread =
+                    Win32Thread([this, plugin_id, plugin_ptr,
+                                 dedicated_gui_thread =
+                                     plugin.dedicated_gui_thread.get()]() {
                         const std::string thread_name =
                             "worker-" + std::to_string(plugin_id);
                         pthread_setname_np(pthread_self(), thread_name.c_str());
 
-                        handle_plugin_run(plugin_id, plugin_ptr);
-                    }),
-                    std::move(bridge));
+                        handle_plugin_run(plugin_id, plugin_ptr,
+                                          dedicated_gui_thread);
+                    });
+                active_plugins_.emplace(plugin_id, std::move(plugin));
             } catch (const std::exception& error) {
                 logger_.log("Error while initializing '" + request.plugin_path +
                             "':");
@@ -298,7 +377,7 @@ void GroupBridge::async_handle_events() {
             // timer loop for a little while after opening a second editor.
             // Without this limit everything will get blocked indefinitely. How
             // could this be fixed?
-            HostBridge::handle_events();
+            return HostBridge::handle_events(main_context_);
         },
         [&]() { return !is_event_loop_inhibited(); });
 }
@@ -17,6 +17,8 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
+#include <future>
 #include <thread>
 
 #include "../use-linux-asio.h"
@@ -90,6 +92,82 @@ class StdIoCapture {
     int pipe_fd_[2];
 };
 
+/**
+ * A GUI thread with its own `MainContext` and Win32 message loop for a single
+ * plugin in a plugin group. Normally every plugin in a group shares the group's
+ * GUI thread, which means that a single plugin blocking that thread blocks the
+ * editors and main thread calls of every other plugin in the group. Plugins
+ * with the `group_dedicated_gui_thread` option enabled are instead created,
+ * run, and destroyed on one of these threads, just like an individually hosted
+ * plugin would be on `yabridge-host.exe`'s main thread.
+ */
+class DedicatedGuiThread {
+   public:
+    /**
+     * A function that creates the plugin's bridge using the `MainContext` it
+     * was passed.
+     */
+    using BridgeFactory =
+        std::function<std::unique_ptr<HostBridge>(MainContext&)>;
+
+    /**
+     * Spawn the thread and create the plugin's bridge on it. Once the bridge
+     * has been created the thread will start handling Win32 messages and
+     * running tasks for the bridge until `stop()` gets called.
+     *
+     * @param plugin_id The ID of the plugin in the group, used for the thread's
+     *   name.
+     * @param create_bridge A function that creates the plugin's bridge. This
+     *   is run on the new thread.
+     */
+    DedicatedGuiThread(size_t plugin_id, BridgeFactory create_bridge);
+
+    /**
+     * Stop the thread if it's still running, and then wait for it to unload
+     * the plugin.
+     */
+    ~DedicatedGuiThread() noexcept;
+
+    DedicatedGuiThread(const DedicatedGuiThread&) = delete;
+    DedicatedGuiThread& operator=(const DedicatedGuiThread&) = delete;
+
+    DedicatedGuiThread(DedicatedGuiThread&&) = delete;
+    DedicatedGuiThread& operator=(DedicatedGuiThread&&) = delete;
+
+    /**
+     * Wait for the bridge to be created.
+     *
+     * @return The newly created bridge. This is owned by this object and it
+     *   will be destroyed on the GUI thread after `stop()` has been called.
+     *
+     * @throw std::exception Any exception thrown while creating the bridge.
+     */
+    HostBridge* wait_for_bridge();
+
+    /**
+     * Stop the thread's event loop after any tasks that have already been
+     * scheduled have run. The bridge will be destroyed from the GUI thread
+     * afterwards. This should be called after the bridge's `run()` function
+     * has returned.
+     */
+    void stop();
+
+   private:
+    MainContext main_context_;
+    /**
+     * The plugin's bridge. This is only ever accessed from the GUI thread.
+     */
+    std::unique_ptr<HostBridge> bridge_;
+    std::promise<HostBridge*> bridge_promise_;
+    /**
+     * Whether `stop()` has been called. This is set from the plugin's worker
+     * thread, which will have been joined before this object gets destroyed.
+     */
+    bool stop_requested_ = false;
+
+    Win32Thread gui_thread_;
+};
+
 /**
  * A 'plugin group' that listens on a _group socket_ for plugins to host in this
  * process. Once the plugin gets loaded into a new thread the actual bridging
@@ -156,12 +234,18 @@ class GroupBridge {
      *
      * @param plugin_id The ID of this plugin in the `active_plugins_` map. Used
      *   to unload the plugin and join this thread again after the plugin exits.
+     * @param bridge The plugin's bridge.
+     * @param dedicated_gui_thread The plugin's own GUI thread, if it was hosted
+     *   with the `group_dedicated_gui_thread` option. If this is set, then the
+     *   plugin will be unloaded from that thread instead.
      *
      * @note In the case that the process starts but no plugin gets initiated,
      *   then the process will never exit on its own. This should not happen
      *   though.
      */
-    void handle_plugin_run(size_t plugin_id, HostBridge* bridge);
+    void handle_plugin_run(size_t plugin_id,
+                           HostBridge* bridge,
+                           DedicatedGuiThread* dedicated_gui_thread);
 
     /**
      * Listen for new requests to spawn plugins within this process and handle
@@ -182,7 +266,9 @@ class GroupBridge {
      * handling and message loop interaction also has to be done from that
      * thread, which is why we initialize the plugin here and use the
      * `handle_dispatch()` function to run events within the same
-     * `main_context_`.
+     * `main_context_`. The exception to this are plugins using the
+     * `group_dedicated_gui_thread` option, which are initialized on and use
+     * their own `DedicatedGuiThread` instead.
      *
      * @see handle_plugin_run
      */
@@ -249,6 +335,26 @@ class GroupBridge {
      */
     asio::local::stream_protocol::acceptor group_socket_acceptor_;
 
+    /**
+     * A plugin hosted within this group process.
+     */
+    struct ActivePlugin {
+        /**
+         * The plugin's own GUI thread if it was hosted with the
+         * `group_dedicated_gui_thread` option. In that case the bridge is owned
+         * by this object and `bridge` will be a null pointer.
+         */
+        std::unique_ptr<DedicatedGuiThread> dedicated_gui_thread;
+        /**
+         * The plugin's bridge, if it lives on the group's GUI thread.
+         */
+        std::unique_ptr<HostBridge> bridge;
+        /**
+         * The thread running `handle_plugin_run()` for this plugin.
+         */
+        Win32Thread worker_thread;
+    };
+
     /**
      * A map of threads that are currently hosting a plugin within this process
      * along with their plugin instance. After a plugin has exited or its
@@ -258,9 +364,7 @@ class GroupBridge {
      * thread and plugin is a unique plugin ID obtained by doing a fetch-and-add
      * on `next_plugin_id_`.
      */
-    std::unordered_map<size_t,
-                       std::pair<Win32Thread, std::unique_ptr<HostBridge>>>
-        active_plugins_;
+    std::unordered_map<size_t, ActivePlugin> active_plugins_;
     /**
      * A counter for the next unique plugin ID. When hosting a new plugin we'll
      * do a fetch-and-add to ensure that every thread gets its own unique
@@ -16,6 +16,8 @@
 
 #include "vst2.h"
 
+#include <algorithm>
+#include <bit>
 #include <iostream>
 #include <set>
 
@@ -115,6 +117,23 @@ static const std::unordered_set<int> unsafe_requests{
 static const std::unordered_set<int> unsafe_requests_realtime{effOpen,
                                                               effMainsChanged};
 
+/**
+ * Opcodes after which we'll refresh the shared parameter table, since they will
+ * likely change all of the plugin's parameters at once.
+ */
+static const std::unordered_set<int> parameter_mirror_refresh_requests{
+    effSetProgram, effEndSetProgram, effSetChunk};
+
+/**
+ * The minimum amount of time between two refreshes scheduled from the audio
+ * thread. A plugin calling `audioMasterUpdateDisplay()` from its
+ * `processReplacing()` function would otherwise cause `getParameter()` to be
+ * called for every parameter after every processing cycle. Hosts only poll
+ * parameters for drawing their GUIs, so this doesn't need to be any faster.
+ */
+constexpr std::chrono::steady_clock::duration
+    parameter_mirror_min_refresh_interval = std::chrono::milliseconds(50);
+
 intptr_t VST_CALL_CONV
 host_callback_proxy(AEffect*, int, int, intptr_t, void*, float);
 
@@ -211,22 +230,78 @@ Vst2Bridge::Vst2Bridge(MainContext& main_context,
     plugin_->ptr1 = this;
     plugin_->ptr2 = reinterpret_cast<void*>(yabridge_ptr2_magic);
 
+    // The native plugin will connect to this table right after it has received
+    // the `AEffect` struct below. It only gets populated after `effOpen()`,
+    // because plugins cannot be expected to return sensible parameter values
+    // before that.
+    try {
+        parameter_mirror_.emplace(ParameterMirror::create(
+            sockets_.parameter_mirror_name(),
+            static_cast<uint32_t>(std::max(plugin_->numParams, 0))));
+    } catch (const std::exception& error) {
+        generic_logger_.log(
+            "Could not create the shared parameter table, falling back to "
+            "querying parameters over the socket: " +
+            std::string(error.what()));
+    }
+
     // Send the plugin's information to the Linux VST plugin. Any other updates
     // of this object will be sent over the `dispatcher()` socket. This would be
     // done after the host calls `effOpen()`, and when the plugin calls
     // `audioMasterIOChanged()`. We will also send along this host's version so
-    // we can show a warning when the plugin's version doesn't match.
+    // we can show a warning when the plugin's version doesn't match. The
+    // otherwise unused return value indicates whether we can compress large
+    // messages, like `WantsConfiguration::host_supports_compression` does for
+    // VST3 and CLAP.
     sockets_.host_plugin_control_.send(
-        Vst2EventResult{.return_value = 0,
+        Vst2EventResult{.return_value = is_compression_available() ? 1 : 0,
                         .payload = *plugin_,
                         .value_payload = yabridge_git_version});
 
     // After sending the AEffect struct we'll receive this instance's
     // configuration as a response
     config_ = sockets_.host_plugin_control_.receive_single<Configuration>();
+    if (config_.compress_large_messages) {
+        sockets_.enable_compression();
+    }
+    if (config_.vst2_disable_param_mirror) {
+        parameter_mirror_.reset();
+    }
+
+    if (parameter_mirror_) {
+        parameter_mirror_dirty_parameters_ =
+            std::vector<std::atomic_uint64_t>(
+                (parameter_mirror_->size() + 63) / 64);
+
+        parameter_mirror_handler_ = Win32Thread([&]() {
+            pthread_setname_np(pthread_self(), "param-mirror");
+
+            while (true) {
+                parameter_mirror_refresh_pending_.wait(false);
+
+                std::unique_lock lock(parameter_mirror_refresh_mutex_);
+                if (parameter_mirror_refresh_stopped_) {
+                    break;
+                }
+
+                parameter_mirror_refresh_pending_.store(false);
+                refresh_scheduled_parameters();
+
+                parameter_mirror_refresh_cv_.wait_for(
+                    lock, parameter_mirror_min_refresh_interval,
+                    [&]() { return parameter_mirror_refresh_stopped_; });
+            }
+        });
+    }
 
     // Allow this plugin to configure the main context's tick rate
     main_context.update_timer_interval(config_.event_loop_interval());
+    SerializationBufferPool::global().limit_idle_timeout(
+        config_.buffer_idle_timeout_duration());
+    if (config_.gui_stall_threshold) {
+        main_context.enable_stall_detector(
+            config_.gui_stall_threshold_duration());
+    }
 
     parameters_handler_ = Win32Thread([&]() {
         set_realtime_priority(true);
@@ -243,11 +318,23 @@ Vst2Bridge::Vst2Bridge(MainContext& main_context,
                     plugin_->setParameter(plugin_, request.index,
                                           *request.value);
 
+                    // The plugin may quantize or clamp the value, so we'll ask
+                    // for the actual value instead of storing the one we got
+                    if (parameter_mirror_ && parameter_mirror_->populated()) {
+                        parameter_mirror_->write(
+                            request.index,
+                            plugin_->getParameter(plugin_, request.index));
+                    }
+
                     ParameterResult response{std::nullopt};
                     sockets_.host_plugin_parameters_.send(response, buffer);
                 } else {
-                    // `getParameter`
+                    // `getParameter`, for indices outside of the shared
+                    // parameter table or when that table is disabled
                     float value = plugin_->getParameter(plugin_, request.index);
+                    if (parameter_mirror_ && parameter_mirror_->populated()) {
+                        parameter_mirror_->write(request.index, value);
+                    }
 
                     ParameterResult response{value};
                     sockets_.host_plugin_parameters_.send(response, buffer);
@@ -258,6 +345,8 @@ Vst2Bridge::Vst2Bridge(MainContext& main_context,
     process_replacing_handler_ = Win32Thread([&]() {
         set_realtime_priority(true);
         pthread_setname_np(pthread_self(), "audio");
+        audio_thread_id_.store(GetCurrentThreadId(),
+                               std::memory_order_relaxed);
 
         // Most plugins will already enable FTZ, but there are a handful of
         // plugins that don't that suffer from extreme DSP load increases when
@@ -297,6 +386,16 @@ Vst2Bridge::Vst2Bridge(MainContext& main_context,
             // pointers to rather than copies of the events.
             std::lock_guard lock(next_buffer_midi_events_mutex_);
 
+            // `setParameter()` calls the host made from its audio thread are
+            // sent along with the processing call, so they can be applied here
+            // in order without the host having to wait for each of them. The
+            // shared parameter table will pick up these changes during the
+            // next refresh below.
+            for (const auto& [index, value] :
+                 process_request.parameter_changes) {
+                plugin_->setParameter(plugin_, index, value);
+            }
+
             // As an optimization we no don't pass the input audio along
             // with `Vst2ProcessRequest`, and instead we'll write it to a
             // shared memory object on the plugin side. We can then write
@@ -381,6 +480,11 @@ Vst2Bridge::Vst2Bridge(MainContext& main_context,
 
 #pragma GCC diagnostic pop
 
+Vst2Bridge::~Vst2Bridge() noexcept {
+    // In case the host never called `effClose()`
+    stop_parameter_mirror_refresh();
+}
+
 bool Vst2Bridge::inhibits_event_loop() noexcept {
     return !is_initialized_;
 }
@@ -438,7 +542,16 @@ void Vst2Bridge::run() {
                     // is running the IO context, since this is also
                     // where the plugins were instantiated and where the
                     // Win32 message loop is handled.
-                    if (unsafe_requests.contains(opcode)) {
+                    if (opcode == effSetChunk &&
+                        config_.parallel_state_restore) {
+                        // Some plugins need `effSetChunk()` to be called from
+                        // the GUI thread, but for plugins that don't we can let
+                        // multiple instances restore their state in parallel
+                        return run_state_restore([&]() {
+                            return dispatch_wrapper(plugin, opcode, index,
+                                                    value, data, option);
+                        });
+                    } else if (unsafe_requests.contains(opcode)) {
                         // Requests that potentially spawn an audio worker
                         // thread should be run with `SCHED_FIFO` until Wine
                         // implements the corresponding Windows API
@@ -506,6 +619,18 @@ void Vst2Bridge::run() {
                                        .value_payload = std::nullopt};
             }
 
+            // The shared parameter table is populated for the first time after
+            // the plugin has been initialized, and loading presets will likely
+            // change all parameters at once
+            if (event.opcode == effOpen && parameter_mirror_) {
+                parameter_mirror_->refresh([&](int index) {
+                    return plugin_->getParameter(plugin_, index);
+                });
+            } else if (parameter_mirror_refresh_requests.contains(
+                           event.opcode)) {
+                refresh_parameter_mirror();
+            }
+
             return result;
         });
 }
@@ -514,6 +639,84 @@ void Vst2Bridge::close_sockets() {
     sockets_.close();
 }
 
+void Vst2Bridge::refresh_parameter_mirror() noexcept {
+    // The table is populated for the first time in `run()` after `effOpen()`,
+    // and this function may be called from other threads before that
+    if (!parameter_mirror_ || !parameter_mirror_->populated()) {
+        return;
+    }
+
+    parameter_mirror_->refresh(
+        [&](int index) { return plugin_->getParameter(plugin_, index); });
+}
+
+void Vst2Bridge::schedule_parameter_mirror_refresh(
+    std::optional<int> index) noexcept {
+    if (index) {
+        if (*index < 0 ||
+            static_cast<size_t>(*index) / 64 >=
+                parameter_mirror_dirty_parameters_.size()) {
+            return;
+        }
+
+        parameter_mirror_dirty_parameters_[*index / 64].fetch_or(
+            uint64_t(1) << (*index % 64));
+    } else {
+        parameter_mirror_full_refresh_pending_.store(true);
+    }
+
+    // The refresh thread only needs to be woken up once
+    if (!parameter_mirror_refresh_pending_.exchange(true)) {
+        parameter_mirror_refresh_pending_.notify_one();
+    }
+}
+
+void Vst2Bridge::refresh_scheduled_parameters() noexcept {
+    if (parameter_mirror_full_refresh_pending_.exchange(false)) {
+        // The full refresh also covers the individual parameters
+        for (auto& dirty_parameters : parameter_mirror_dirty_parameters_) {
+            dirty_parameters.store(0);
+        }
+
+        refresh_parameter_mirror();
+        return;
+    }
+
+    for (size_t word = 0; word < parameter_mirror_dirty_parameters_.size();
+         word++) {
+        uint64_t dirty_parameters =
+            parameter_mirror_dirty_parameters_[word].exchange(0);
+        while (dirty_parameters != 0) {
+            const int index = static_cast<int>(word * 64) +
+                              std::countr_zero(dirty_parameters);
+            dirty_parameters &= dirty_parameters - 1;
+
+            parameter_mirror_->write(index,
+                                     plugin_->getParameter(plugin_, index));
+        }
+    }
+}
+
+void Vst2Bridge::stop_parameter_mirror_refresh() noexcept {
+    // Since the refresh thread holds this mutex while refreshing, this will
+    // also wait for any refresh in progress to finish
+    {
+        std::lock_guard lock(parameter_mirror_refresh_mutex_);
+        parameter_mirror_refresh_stopped_ = true;
+    }
+
+    // The thread may either be waiting for a refresh to be scheduled, or for
+    // the minimum interval between two refreshes to pass
+    parameter_mirror_refresh_pending_.store(true);
+    parameter_mirror_refresh_pending_.notify_one();
+    parameter_mirror_refresh_cv_.notify_all();
+}
+
+bool Vst2Bridge::is_audio_thread() const noexcept {
+    return GetCurrentThreadId() ==
+           audio_thread_id_.load(std::memory_order_relaxed);
+}
+
 class HostCallbackDataConverter : public DefaultDataConverter {
    public:
     HostCallbackDataConverter(
@@ -702,6 +905,28 @@ intptr_t Vst2Bridge::host_callback(AEffect* effect,
                 editor_->resize(index, value);
             }
         } break;
+        // The host will likely query the parameter's value in response to
+        // these, so the shared parameter table should be up to date first. On
+        // the audio thread we can't wait for another thread to finish writing
+        // to the table, so in that case we'll let `parameter_mirror_handler_`
+        // refresh that parameter instead.
+        case audioMasterAutomate: {
+            if (parameter_mirror_ && parameter_mirror_->populated() &&
+                !parameter_mirror_->write(index, option, !is_audio_thread())) {
+                schedule_parameter_mirror_refresh(index);
+            }
+        } break;
+        case audioMasterUpdateDisplay: {
+            if (!parameter_mirror_ || !parameter_mirror_->populated()) {
+                break;
+            }
+
+            if (is_audio_thread()) {
+                schedule_parameter_mirror_refresh(std::nullopt);
+            } else {
+                refresh_parameter_mirror();
+            }
+        } break;
     }
 
     HostCallbackDataConverter converter(effect, last_time_info_,
@@ -723,6 +948,13 @@ intptr_t Vst2Bridge::dispatch_wrapper(AEffect* plugin,
     // main thread using `main_context.run_in_context()` (where we don't use
     // realtime scheduling).
     switch (opcode) {
+        case effClose: {
+            // The plugin's parameters can no longer be queried after this
+            stop_parameter_mirror_refresh();
+
+            return plugin->dispatcher(plugin, opcode, index, value, data,
+                                      option);
+        } break;
         case effSetBlockSize: {
             // Used to initialize the shared audio buffers when handling
             // `effMainsChanged` in `Vst2Bridge::run()`
@@ -738,7 +970,8 @@ intptr_t Vst2Bridge::dispatch_wrapper(AEffect* plugin,
             const auto x11_handle = reinterpret_cast<size_t>(data);
 
             Editor& editor_instance = editor_.emplace(
-                main_context_, config_, generic_logger_, x11_handle,
+                main_context_, config_, generic_logger_,
+                plugin_path_.filename().string(), x11_handle,
                 [plugin = plugin_]() {
                     plugin->dispatcher(plugin, effEditIdle, 0, 0, nullptr, 0.0);
                 });
@@ -18,12 +18,17 @@
 
 #include "../use-linux-asio.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <vector>
+
 #include <vestige/aeffectx.h>
 #include <windows.h>
 
 #include "../../common/communication/vst2.h"
 #include "../../common/configuration.h"
 #include "../../common/mutual-recursion.h"
+#include "../../common/parameter-mirror.h"
 #include "../editor.h"
 #include "common.h"
 
@@ -59,6 +64,8 @@ class Vst2Bridge : public HostBridge {
                std::string endpoint_base_dir,
                pid_t parent_pid);
 
+    ~Vst2Bridge() noexcept override;
+
     bool inhibits_event_loop() noexcept override;
 
     /**
@@ -96,6 +103,41 @@ class Vst2Bridge : public HostBridge {
      */
     AudioShmBuffer::Config setup_shared_audio_buffers();
 
+    /**
+     * Write all of the plugin's current parameter values to
+     * `parameter_mirror_`. This does nothing until the table has been populated
+     * after `effOpen()`. This calls `getParameter()` for every parameter, so
+     * it should never be called from the audio thread. Use
+     * `schedule_parameter_mirror_refresh()` there instead.
+     */
+    void refresh_parameter_mirror() noexcept;
+
+    /**
+     * Let `parameter_mirror_handler_` refresh a parameter in
+     * `parameter_mirror_`, or the entire table if `index` is a nullopt. This
+     * never blocks or allocates, so it's safe to call from the audio thread.
+     */
+    void schedule_parameter_mirror_refresh(std::optional<int> index) noexcept;
+
+    /**
+     * Refresh the parameters scheduled through
+     * `schedule_parameter_mirror_refresh()`. Called from
+     * `parameter_mirror_handler_`.
+     */
+    void refresh_scheduled_parameters() noexcept;
+
+    /**
+     * Stop `parameter_mirror_handler_` from refreshing the shared parameter
+     * table. When this function returns, the thread is guaranteed to not be
+     * calling into the plugin anymore. This is called before `effClose()`.
+     */
+    void stop_parameter_mirror_refresh() noexcept;
+
+    /**
+     * Whether this function is being called from this instance's audio thread.
+     */
+    bool is_audio_thread() const noexcept;
+
     /**
      * A logger instance we'll use log cached `audioMasterGetTime()` calls, so
      * they can be hidden on verbosity levels below 2.
@@ -139,6 +181,59 @@ class Vst2Bridge : public HostBridge {
      */
     std::vector<void*> process_buffers_output_pointers_;
 
+    /**
+     * A shared memory table containing the plugin's current parameter values,
+     * so the native plugin can answer the host's `getParameter()` calls
+     * without having to send a request to us. This is created right after
+     * loading the plugin and populated after `effOpen()`. This will be a
+     * nullopt when the `vst2_disable_param_mirror` option is enabled, or when
+     * the shared memory object could not be created.
+     */
+    std::optional<ParameterMirror> parameter_mirror_;
+
+    /**
+     * A bit set of the parameter indices `parameter_mirror_handler_` should
+     * refresh. Bits get set when the plugin reports a parameter change through
+     * `audioMasterAutomate()` on the audio thread while another thread is
+     * writing to `parameter_mirror_`.
+     */
+    std::vector<std::atomic_uint64_t> parameter_mirror_dirty_parameters_;
+    /**
+     * Set when `parameter_mirror_handler_` should refresh the entire table,
+     * i.e. when the plugin calls `audioMasterUpdateDisplay()` from the audio
+     * thread.
+     */
+    std::atomic_bool parameter_mirror_full_refresh_pending_ = false;
+    /**
+     * Set when any of the above has been set. `parameter_mirror_handler_`
+     * waits on this, and it only gets notified when this changes from `false`
+     * to `true`.
+     */
+    std::atomic_bool parameter_mirror_refresh_pending_ = false;
+    /**
+     * Whether `parameter_mirror_handler_` should stop refreshing the table.
+     * Protected by `parameter_mirror_refresh_mutex_`.
+     */
+    bool parameter_mirror_refresh_stopped_ = false;
+    /**
+     * Held by `parameter_mirror_handler_` while refreshing the table, so
+     * `stop_parameter_mirror_refresh()` can wait for a refresh to finish.
+     */
+    std::mutex parameter_mirror_refresh_mutex_;
+    /**
+     * Used to wake up `parameter_mirror_handler_` when it should stop while
+     * it's waiting between two refreshes.
+     */
+    std::condition_variable parameter_mirror_refresh_cv_;
+
+    /**
+     * The Win32 thread ID of the thread handling `processReplacing()` calls.
+     * Used to avoid blocking or calling `getParameter()` for every parameter
+     * when the plugin calls `audioMasterAutomate()` or
+     * `audioMasterUpdateDisplay()` while processing audio.
+     */
+    std::atomic<DWORD> audio_thread_id_ = 0;
+
     /**
      * The maximum number of samples the host will pass to the plugin during
      * `processReplacing()`/`processDoubleReplacing()`/`process()`. This is
@@ -210,6 +305,13 @@ class Vst2Bridge : public HostBridge {
      * fallback) and `processDoubleReplacing`.
      */
     Win32Thread process_replacing_handler_;
+    /**
+     * The thread that refreshes the parameters in `parameter_mirror_` the
+     * audio thread could not write to itself. This sleeps until
+     * `schedule_parameter_mirror_refresh()` gets called. Only started when the
+     * shared parameter table is enabled.
+     */
+    Win32Thread parameter_mirror_handler_;
 
     /**
      * All sockets used for communicating with this specific plugin.
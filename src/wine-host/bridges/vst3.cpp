@@ -16,6 +16,7 @@
 
 #include "vst3.h"
 
+#include <algorithm>
 #include <bitset>
 
 #include "vst3-impls/component-handler-proxy.h"
@@ -105,10 +106,22 @@ Vst3Bridge::Vst3Bridge(MainContext& main_context,
     // Fetch this instance's configuration from the plugin to finish the setup
     // process
     config_ = sockets_.plugin_host_callback_.send_message(
-        WantsConfiguration{.host_version = yabridge_git_version}, std::nullopt);
+        WantsConfiguration{.host_version = yabridge_git_version,
+                           .host_supports_compression =
+                               is_compression_available()},
+        std::nullopt);
+    if (config_.compress_large_messages) {
+        sockets_.enable_compression();
+    }
 
     // Allow this plugin to configure the main context's tick rate
     main_context.update_timer_interval(config_.event_loop_interval());
+    SerializationBufferPool::global().limit_idle_timeout(
+        config_.buffer_idle_timeout_duration());
+    if (config_.gui_stall_threshold) {
+        main_context.enable_stall_detector(
+            config_.gui_stall_threshold_duration());
+    }
 }
 
 bool Vst3Bridge::inhibits_event_loop() noexcept {
@@ -226,11 +239,7 @@ void Vst3Bridge::run() {
             },
             [&](Vst3PluginProxy::SetState& request)
                 -> Vst3PluginProxy::SetState::Response {
-                // We need to run `getState()` from the main thread, so we might
-                // as well do the same thing with `setState()`. See below.
-                // NOTE: We also try to handle mutual recursion here, in case
-                //       this happens during a resize
-                return do_mutual_recursion_on_gui_thread([&]() -> tresult {
+                const auto set_state = [&]() -> tresult {
                     const auto& [instance, _] =
                         get_instance(request.instance_id);
 
@@ -244,7 +253,21 @@ void Vst3Bridge::run() {
                         return instance.interfaces.edit_controller->setState(
                             &request.state);
                     }
-                });
+                };
+
+                // We need to run `getState()` from the main thread, so we might
+                // as well do the same thing with `setState()`. See below. This
+                // can be disabled for plugins that are known to be fine with
+                // restoring their state from another thread.
+                // NOTE: We also try to handle mutual recursion here, in case
+                //       this happens during a resize
+                if (config_.parallel_state_restore) {
+                    return run_state_restore([&]() {
+                        return do_mutual_recursion_on_off_thread(set_state);
+                    });
+                } else {
+                    return do_mutual_recursion_on_gui_thread(set_state);
+                }
             },
             [&](Vst3PluginProxy::GetState& request)
                 -> Vst3PluginProxy::GetState::Response {
@@ -429,6 +452,32 @@ void Vst3Bridge::run() {
                 return YaEditController::GetParameterInfosResponse{
                     .infos = std::move(infos)};
             },
+            [&](const YaEditController::GetParamValues& request)
+                -> YaEditController::GetParamValues::Response {
+                const auto& [instance, _] = get_instance(request.instance_id);
+
+                std::vector<YaEditController::ParamValueAndString> values;
+                values.reserve(request.ids.size());
+                for (const Steinberg::Vst::ParamID id : request.ids) {
+                    const Steinberg::Vst::ParamValue value_normalized =
+                        instance.interfaces.edit_controller
+                            ->getParamNormalized(id);
+
+                    Steinberg::Vst::String128 string{0};
+                    const tresult string_result =
+                        instance.interfaces.edit_controller
+                            ->getParamStringByValue(id, value_normalized,
+                                                    string);
+
+                    values.push_back(YaEditController::ParamValueAndString{
+                        .value_normalized = value_normalized,
+                        .string_result = string_result,
+                        .string = tchar_pointer_to_u16string(string)});
+                }
+
+                return YaEditController::GetParamValuesResponse{
+                    .values = std::move(values)};
+            },
             [&](const YaEditController::GetParamStringByValue& request)
                 -> YaEditController::GetParamStringByValue::Response {
                 Steinberg::Vst::String128 string{0};
@@ -622,6 +671,32 @@ void Vst3Bridge::run() {
                 return YaKeyswitchController::GetKeyswitchInfoResponse{
                     .result = result, .info = std::move(info)};
             },
+            [&](const YaKeyswitchController::GetKeyswitchInfos& request)
+                -> YaKeyswitchController::GetKeyswitchInfos::Response {
+                const auto& [instance, _] = get_instance(request.instance_id);
+
+                const int32 num_keyswitches =
+                    instance.interfaces.keyswitch_controller->getKeyswitchCount(
+                        request.bus_index, request.channel);
+
+                std::vector<YaKeyswitchController::GetKeyswitchInfoResponse>
+                    infos;
+                infos.reserve(std::max(num_keyswitches, 0));
+                for (int32 i = 0; i < num_keyswitches; i++) {
+                    Steinberg::Vst::KeyswitchInfo info{};
+                    const tresult result =
+                        instance.interfaces.keyswitch_controller
+                            ->getKeyswitchInfo(request.bus_index,
+                                               request.channel, i, info);
+
+                    infos.push_back(
+                        YaKeyswitchController::GetKeyswitchInfoResponse{
+                            .result = result, .info = std::move(info)});
+                }
+
+                return YaKeyswitchController::GetKeyswitchInfosResponse{
+                    .infos = std::move(infos)};
+            },
             [&](const YaMidiLearn::OnLiveMIDIControllerInput& request)
                 -> YaMidiLearn::OnLiveMIDIControllerInput::Response {
                 const auto& [instance, _] = get_instance(request.instance_id);
@@ -644,6 +719,37 @@ void Vst3Bridge::run() {
                 return YaMidiMapping::GetMidiControllerAssignmentResponse{
                     .result = result, .id = id};
             },
+            [&](const YaMidiMapping::GetMidiControllerAssignments& request)
+                -> YaMidiMapping::GetMidiControllerAssignments::Response {
+                const auto& [instance, _] = get_instance(request.instance_id);
+
+                std::vector<YaMidiMapping::MidiControllerAssignment>
+                    assignments;
+                for (int16 channel = 0; channel < midi_mapping_num_channels;
+                     channel++) {
+                    for (Steinberg::Vst::CtrlNumber midi_controller_number = 0;
+                         midi_controller_number <
+                         Steinberg::Vst::kCountCtrlNumber;
+                         midi_controller_number++) {
+                        Steinberg::Vst::ParamID id;
+                        if (instance.interfaces.midi_mapping
+                                ->getMidiControllerAssignment(
+                                    request.bus_index, channel,
+                                    midi_controller_number,
+                                    id) == Steinberg::kResultOk) {
+                            assignments.push_back(
+                                YaMidiMapping::MidiControllerAssignment{
+                                    .channel = channel,
+                                    .midi_controller_number =
+                                        midi_controller_number,
+                                    .id = id});
+                        }
+                    }
+                }
+
+                return YaMidiMapping::GetMidiControllerAssignmentsResponse{
+                    .assignments = std::move(assignments)};
+            },
             [&](const YaNoteExpressionController::GetNoteExpressionCount&
                     request)
                 -> YaNoteExpressionController::GetNoteExpressionCount::
@@ -671,6 +777,40 @@ void Vst3Bridge::run() {
                     GetNoteExpressionInfoResponse{.result = result,
                                                   .info = std::move(info)};
             },
+            [&](const YaNoteExpressionController::GetNoteExpressionInfos&
+                    request)
+                -> YaNoteExpressionController::GetNoteExpressionInfos::
+                    Response {
+                        const auto& [instance, _] =
+                            get_instance(request.instance_id);
+
+                        const int32 num_note_expressions =
+                            instance.interfaces.note_expression_controller
+                                ->getNoteExpressionCount(request.bus_index,
+                                                         request.channel);
+
+                        std::vector<YaNoteExpressionController::
+                                        GetNoteExpressionInfoResponse>
+                            infos;
+                        infos.reserve(std::max(num_note_expressions, 0));
+                        for (int32 i = 0; i < num_note_expressions; i++) {
+                            Steinberg::Vst::NoteExpressionTypeInfo info{};
+                            const tresult result =
+                                instance.interfaces.note_expression_controller
+                                    ->getNoteExpressionInfo(request.bus_index,
+                                                            request.channel, i,
+                                                            info);
+
+                            infos.push_back(YaNoteExpressionController::
+                                                GetNoteExpressionInfoResponse{
+                                                    .result = result,
+                                                    .info = std::move(info)});
+                        }
+
+                        return YaNoteExpressionController::
+                            GetNoteExpressionInfosResponse{
+                                .infos = std::move(infos)};
+                    },
             [&](const YaNoteExpressionController::
                     GetNoteExpressionStringByValue& request)
                 -> YaNoteExpressionController::GetNoteExpressionStringByValue::
@@ -801,7 +941,7 @@ void Vst3Bridge::run() {
                     .run_in_context([&, &instance = instance]() -> tresult {
                         Editor& editor_instance = instance.editor.emplace(
                             main_context_, config_, generic_logger_,
-                            x11_handle);
+                            plugin_path_.filename().string(), x11_handle);
                         const tresult result =
                             instance.plug_view_instance->plug_view->attached(
                                 editor_instance.win32_handle(), type.c_str());
@@ -1216,6 +1356,50 @@ void Vst3Bridge::run() {
                 return YaUnitInfo::GetProgramListInfoResponse{
                     .result = result, .info = std::move(info)};
             },
+            [&](const YaUnitInfo::GetUnitInfos& request)
+                -> YaUnitInfo::GetUnitInfos::Response {
+                // NOTE: The program names are looked up using this
+                //       information, so this will also be requested in
+                //       response to `IUnitHandler::notifyProgramListChange()`.
+                //       See `GetProgramName` below.
+                return do_mutual_recursion_on_off_thread(
+                    [&]() -> YaUnitInfo::GetUnitInfosResponse {
+                        const auto& [instance, _] =
+                            get_instance(request.instance_id);
+                        Steinberg::Vst::IUnitInfo& unit_info =
+                            *instance.interfaces.unit_info;
+
+                        YaUnitInfo::GetUnitInfosResponse response{};
+
+                        const int32 num_units = unit_info.getUnitCount();
+                        response.unit_infos.reserve(std::max(num_units, 0));
+                        for (int32 i = 0; i < num_units; i++) {
+                            Steinberg::Vst::UnitInfo info{};
+                            const tresult result =
+                                unit_info.getUnitInfo(i, info);
+
+                            response.unit_infos.push_back(
+                                YaUnitInfo::GetUnitInfoResponse{
+                                    .result = result, .info = std::move(info)});
+                        }
+
+                        const int32 num_program_lists =
+                            unit_info.getProgramListCount();
+                        response.program_list_infos.reserve(
+                            std::max(num_program_lists, 0));
+                        for (int32 i = 0; i < num_program_lists; i++) {
+                            Steinberg::Vst::ProgramListInfo info{};
+                            const tresult result =
+                                unit_info.getProgramListInfo(i, info);
+
+                            response.program_list_infos.push_back(
+                                YaUnitInfo::GetProgramListInfoResponse{
+                                    .result = result, .info = std::move(info)});
+                        }
+
+                        return response;
+                    });
+            },
             [&](const YaUnitInfo::GetProgramName& request)
                 -> YaUnitInfo::GetProgramName::Response {
                 Steinberg::Vst::String128 name{0};
@@ -1235,6 +1419,32 @@ void Vst3Bridge::run() {
                 return YaUnitInfo::GetProgramNameResponse{
                     .result = result, .name = tchar_pointer_to_u16string(name)};
             },
+            [&](const YaUnitInfo::GetProgramNames& request)
+                -> YaUnitInfo::GetProgramNames::Response {
+                // NOTE: See above, this is requested after the plugin calls
+                //       `IUnitHandler::notifyProgramListChange()`
+                return do_mutual_recursion_on_off_thread(
+                    [&]() -> YaUnitInfo::GetProgramNamesResponse {
+                        const auto& [instance, _] =
+                            get_instance(request.instance_id);
+
+                        std::vector<YaUnitInfo::GetProgramNameResponse> names;
+                        names.reserve(std::max(request.num_programs, 0));
+                        for (int32 i = 0; i < request.num_programs; i++) {
+                            Steinberg::Vst::String128 name{0};
+                            const tresult result =
+                                instance.interfaces.unit_info->getProgramName(
+                                    request.list_id, i, name);
+
+                            names.push_back(YaUnitInfo::GetProgramNameResponse{
+                                .result = result,
+                                .name = tchar_pointer_to_u16string(name)});
+                        }
+
+                        return YaUnitInfo::GetProgramNamesResponse{
+                            .names = std::move(names)};
+                    });
+            },
             [&](const YaUnitInfo::GetProgramInfo& request)
                 -> YaUnitInfo::GetProgramInfo::Response {
                 const auto& [instance, _] = get_instance(request.instance_id);
@@ -1373,9 +1583,8 @@ Vst3Bridge::get_instance(size_t instance_id) noexcept {
 }
 
 std::optional<AudioShmBuffer::Config> Vst3Bridge::setup_shared_audio_buffers(
-    size_t instance_id) {
-    const auto& [instance, _] = get_instance(instance_id);
-
+    size_t instance_id,
+    Vst3PluginInstance& instance) {
     const Steinberg::IPtr<Steinberg::Vst::IComponent> component =
         instance.interfaces.component;
     const Steinberg::IPtr<Steinberg::Vst::IAudioProcessor> audio_processor =
@@ -1544,6 +1753,18 @@ size_t Vst3Bridge::register_object_instance(
 
         object_instances_.at(instance_id)
             .audio_processor_handler = Win32Thread([&, instance_id]() {
+            // Messages on this socket are always about this instance, so
+            // we'll hold on to a direct reference instead of looking it up
+            // through `get_instance()` for every message. That way the audio
+            // thread never has to wait for `object_instances_mutex_` while
+            // another instance is being created or destroyed. References to
+            // elements in an `std::unordered_map` stay valid until the element
+            // is erased, and `unregister_object_instance()` joins this thread
+            // before doing so. We can't take the lock here since this function
+            // holds the exclusive lock until the socket is listening, which
+            // also means that this lookup can't race with anything.
+            Vst3PluginInstance& instance = object_instances_.at(instance_id);
+
             set_realtime_priority(true);
 
             // XXX: Like with VST2 worker threads, when using plugin groups the
@@ -1559,9 +1780,6 @@ size_t Vst3Bridge::register_object_instance(
                 overload{
                     [&](YaAudioProcessor::SetBusArrangements& request)
                         -> YaAudioProcessor::SetBusArrangements::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
-
                         // HACK: WA Production Imperfect VST3 somehow requires
                         //       `inputs` to be a valid pointer, even if there
                         //       are no inputs.
@@ -1579,9 +1797,6 @@ size_t Vst3Bridge::register_object_instance(
                     },
                     [&](YaAudioProcessor::GetBusArrangement& request)
                         -> YaAudioProcessor::GetBusArrangement::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
-
                         Steinberg::Vst::SpeakerArrangement arr{};
                         const tresult result =
                             instance.interfaces.audio_processor
@@ -1593,26 +1808,17 @@ size_t Vst3Bridge::register_object_instance(
                     },
                     [&](const YaAudioProcessor::CanProcessSampleSize& request)
                         -> YaAudioProcessor::CanProcessSampleSize::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
-
                         return instance.interfaces.audio_processor
                             ->canProcessSampleSize(
                                 request.symbolic_sample_size);
                     },
-                    [&](const YaAudioProcessor::GetLatencySamples& request)
+                    [&](const YaAudioProcessor::GetLatencySamples&)
                         -> YaAudioProcessor::GetLatencySamples::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
-
                         return instance.interfaces.audio_processor
                             ->getLatencySamples();
                     },
                     [&](YaAudioProcessor::SetupProcessing& request)
                         -> YaAudioProcessor::SetupProcessing::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
-
                         // We'll set up the shared audio buffers on the Wine
                         // side after the plugin has finished doing their setup.
                         // This configuration can then be used on the native
@@ -1625,8 +1831,6 @@ size_t Vst3Bridge::register_object_instance(
                     },
                     [&](const YaAudioProcessor::SetProcessing& request)
                         -> YaAudioProcessor::SetProcessing::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
                         // HACK: MeldaProduction plugins for some reason cannot
                         //       handle it if this function is called from the
                         //       audio thread while at the same time
@@ -1657,8 +1861,6 @@ size_t Vst3Bridge::register_object_instance(
                                 true, *request.new_realtime_priority);
                         }
 
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
                         // Most plugins will already enable FTZ, but there are a
                         // handful of plugins that don't that suffer from
                         // extreme DSP load increases when they start producing
@@ -1697,19 +1899,13 @@ size_t Vst3Bridge::register_object_instance(
                             .result = result,
                             .output_data = request.data.create_response()};
                     },
-                    [&](const YaAudioProcessor::GetTailSamples& request)
+                    [&](const YaAudioProcessor::GetTailSamples&)
                         -> YaAudioProcessor::GetTailSamples::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
-
                         return instance.interfaces.audio_processor
                             ->getTailSamples();
                     },
-                    [&](const YaComponent::GetControllerClassId& request)
+                    [&](const YaComponent::GetControllerClassId&)
                         -> YaComponent::GetControllerClassId::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
-
                         Steinberg::TUID cid{0};
                         const tresult result =
                             instance.interfaces.component->getControllerClassId(
@@ -1720,25 +1916,16 @@ size_t Vst3Bridge::register_object_instance(
                     },
                     [&](const YaComponent::SetIoMode& request)
                         -> YaComponent::SetIoMode::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
-
                         return instance.interfaces.component->setIoMode(
                             request.mode);
                     },
                     [&](const YaComponent::GetBusCount& request)
                         -> YaComponent::GetBusCount::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
-
                         return instance.interfaces.component->getBusCount(
                             request.type, request.dir);
                     },
                     [&](YaComponent::GetBusInfo& request)
                         -> YaComponent::GetBusInfo::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
-
                         Steinberg::Vst::BusInfo bus{};
                         const tresult result =
                             instance.interfaces.component->getBusInfo(
@@ -1747,11 +1934,52 @@ size_t Vst3Bridge::register_object_instance(
                         return YaComponent::GetBusInfoResponse{
                             .result = result, .bus = std::move(bus)};
                     },
+                    [&](const YaComponent::GetBusTopology&)
+                        -> YaComponent::GetBusTopology::Response {
+                        const auto query_busses =
+                            [&](std::vector<YaComponent::BusTopologyEntry>&
+                                    busses,
+                                Steinberg::Vst::MediaType type,
+                                Steinberg::Vst::BusDirection dir) {
+                                const int32 num_busses =
+                                    instance.interfaces.component->getBusCount(
+                                        type, dir);
+                                busses.resize(std::max(num_busses, 0));
+                                for (int32 i = 0; i < num_busses; i++) {
+                                    YaComponent::BusTopologyEntry& bus =
+                                        busses[i];
+                                    bus.info.result =
+                                        instance.interfaces.component
+                                            ->getBusInfo(type, dir, i,
+                                                         bus.info.bus);
+                                    if (type == Steinberg::Vst::kAudio &&
+                                        instance.interfaces.audio_processor) {
+                                        bus.arrangement_result =
+                                            instance.interfaces.audio_processor
+                                                ->getBusArrangement(
+                                                    dir, i, bus.arrangement);
+                                    }
+                                }
+                            };
+
+                        YaComponent::GetBusTopologyResponse response{};
+                        query_busses(response.audio_inputs,
+                                     Steinberg::Vst::kAudio,
+                                     Steinberg::Vst::kInput);
+                        query_busses(response.audio_outputs,
+                                     Steinberg::Vst::kAudio,
+                                     Steinberg::Vst::kOutput);
+                        query_busses(response.event_inputs,
+                                     Steinberg::Vst::kEvent,
+                                     Steinberg::Vst::kInput);
+                        query_busses(response.event_outputs,
+                                     Steinberg::Vst::kEvent,
+                                     Steinberg::Vst::kOutput);
+
+                        return response;
+                    },
                     [&](YaComponent::GetRoutingInfo& request)
                         -> YaComponent::GetRoutingInfo::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
-
                         Steinberg::Vst::RoutingInfo out_info{};
                         const tresult result =
                             instance.interfaces.component->getRoutingInfo(
@@ -1762,13 +1990,23 @@ size_t Vst3Bridge::register_object_instance(
                     },
                     [&](const YaComponent::ActivateBus& request)
                         -> YaComponent::ActivateBus::Response {
-                        const auto& [instance, _] =
-                            get_instance(request.instance_id);
-
                         return instance.interfaces.component->activateBus(
                             request.type, request.dir, request.index,
                             request.state);
                     },
+                    [&](const YaComponent::ActivateBusses& request)
+                        -> YaComponent::ActivateBusses::Response {
+                        YaComponent::ActivateBussesResponse response{};
+                        response.results.reserve(request.activations.size());
+                        for (const auto& activation : request.activations) {
+                            response.results.push_back(
+                                instance.interfaces.component->activateBus(
+                                    activation.type, activation.dir,
+                                    activation.index, activation.state));
+                        }
+
+                        return response;
+                    },
                     [&](const YaComponent::SetActive& request)
                         -> YaComponent::SetActive::Response {
                         // NOTE: Ardour/Mixbus will immediately call this
@@ -1781,9 +2019,6 @@ size_t Vst3Bridge::register_object_instance(
                         //       calls.
                         return do_mutual_recursion_on_off_thread(
                             [&]() -> YaComponent::SetActive::Response {
-                                const auto& [instance, _] =
-                                    get_instance(request.instance_id);
-
                                 const tresult result =
                                     instance.interfaces.component->setActive(
                                         request.state);
@@ -1796,7 +2031,7 @@ size_t Vst3Bridge::register_object_instance(
                                 const std::optional<AudioShmBuffer::Config>
                                     updated_audio_buffers_config =
                                         setup_shared_audio_buffers(
-                                            request.instance_id);
+                                            instance_id, instance);
 
                                 return YaComponent::SetActiveResponse{
                                     .result = result,
@@ -1804,14 +2039,11 @@ size_t Vst3Bridge::register_object_instance(
                                         updated_audio_buffers_config)};
                             });
                     },
-                    [&](const YaPrefetchableSupport::GetPrefetchableSupport&
-                            request)
+                    [&](const YaPrefetchableSupport::GetPrefetchableSupport&)
                         -> YaPrefetchableSupport::GetPrefetchableSupport::
                             Response {
                                 Steinberg::Vst::PrefetchableSupport
                                     prefetchable;
-                                const auto& [instance, _] =
-                                    get_instance(request.instance_id);
 
                                 const tresult result =
                                     instance.interfaces.prefetchable_support
@@ -1836,10 +2068,17 @@ size_t Vst3Bridge::register_object_instance(
 
 void Vst3Bridge::unregister_object_instance(size_t instance_id) {
     // Tear the dedicated audio processing socket down again if we
-    // created one during `Vst3PluginProxy::Construct`
-    if (const auto& [instance, _] = get_instance(instance_id);
+    // created one during `Vst3PluginProxy::Construct`. That thread holds a
+    // direct reference to the instance, so it needs to have exited before the
+    // instance can be removed. This is the only place where instances get
+    // removed, so the reference remains valid after `get_instance()` releases
+    // its lock.
+    if (Vst3PluginInstance& instance = get_instance(instance_id).first;
         instance.interfaces.audio_processor || instance.interfaces.component) {
         sockets_.remove_audio_processor(instance_id);
+
+        const Win32Thread audio_processor_handler =
+            std::move(instance.audio_processor_handler);
     }
 
     // Remove the instance from within the main IO context so
@@ -447,6 +447,8 @@ class Vst3Bridge : public HostBridge {
      * lifetime. This is mostly just to save some boilerplate everywhere. Use
      * C++17's structured binding as syntactic sugar to not have to deal with
      * the lock handle.
+     *
+     * This is not used on the audio threads, see `register_object_instance()`.
      */
     std::pair<Vst3PluginInstance&, std::shared_lock<std::shared_mutex>>
     get_instance(size_t instance_id) noexcept;
@@ -462,9 +464,13 @@ class Vst3Bridge : public HostBridge {
      *
      * A nullopt will also be returned if this is called again after shared
      * audio buffers have been set up and the audio buffer size has not changed.
+     *
+     * This takes the instance directly since it's called from the instance's
+     * audio thread.
      */
     std::optional<AudioShmBuffer::Config> setup_shared_audio_buffers(
-        size_t instance_id);
+        size_t instance_id,
+        Vst3PluginInstance& instance);
 
     /**
      * Assign a unique identifier to an object and add it to
@@ -530,10 +536,9 @@ class Vst3Bridge : public HostBridge {
      * contested, we should also not get a measurable performance penalty from
      * making double sure nothing can go wrong.
      *
-     * TODO: At some point replace this with a multiple reader single writer
-     *       lock based by a spinlock. Because this lock is rarely contested
-     *       `get_instance()` never yields to the scheduler during audio
-     *       processing, but it's still something we should avoid at all costs.
+     * The audio threads don't use this lock at all. Those threads hold direct
+     * references to their own instance, so creating or destroying one plugin
+     * instance can never stall audio processing for the other instances.
      */
     std::shared_mutex object_instances_mutex_;
 
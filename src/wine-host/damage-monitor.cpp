@@ -0,0 +1,259 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "damage-monitor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#include <dlfcn.h>
+
+using namespace std::literals::chrono_literals;
+
+constexpr char libxcb_damage_library_name[] = "libxcb-damage.so.0";
+constexpr char libxcb_damage_library_fallback_name[] = "libxcb-damage.so";
+
+/**
+ * The period over which an editor's redraw rate is measured before deciding
+ * whether its timers should be throttled.
+ */
+constexpr std::chrono::steady_clock::duration redraw_rate_measurement_period =
+    250ms;
+
+/**
+ * `DamageNotify` events that are less than this many milliseconds apart
+ * according to the X server are counted as a single redraw. Plugins often draw
+ * a single frame using multiple drawing operations, and with the raw rectangles
+ * report level every one of those results in an event.
+ */
+constexpr xcb_timestamp_t max_redraw_duration_ms = 2;
+
+/**
+ * The number of timers we'll keep track of per editor. Plugins normally only
+ * use a handful of timers, but if a plugin keeps creating new windows with
+ * their own timers then we don't want this to grow indefinitely.
+ */
+constexpr size_t max_tracked_timers = 32;
+
+std::atomic<void*> libxcb_damage_handle = nullptr;
+std::atomic_bool libxcb_damage_load_failed = false;
+std::mutex libxcb_damage_mutex;
+
+#define LIBXCB_DAMAGE_FUNCTIONS        \
+    X(xcb_damage_create)               \
+    X(xcb_damage_destroy)              \
+    X(xcb_damage_id)                   \
+    X(xcb_damage_query_version)        \
+    X(xcb_damage_query_version_reply)
+
+#define X(name) decltype(name)* lib##name = nullptr;
+LIBXCB_DAMAGE_FUNCTIONS
+#undef X
+
+namespace {
+/**
+ * Try to load `libxcb-damage`. Returns `false` if the library or any of its
+ * symbols could not be found. We'll only try this once.
+ */
+bool setup_libxcb_damage() {
+    std::lock_guard lock(libxcb_damage_mutex);
+    if (libxcb_damage_handle) {
+        return true;
+    } else if (libxcb_damage_load_failed) {
+        return false;
+    }
+
+    void* handle = dlopen(libxcb_damage_library_name, RTLD_LAZY | RTLD_LOCAL);
+    if (!handle) {
+        handle = dlopen(libxcb_damage_library_fallback_name,
+                        RTLD_LAZY | RTLD_LOCAL);
+        if (!handle) {
+            libxcb_damage_load_failed = true;
+            return false;
+        }
+    }
+
+    // `xcb_damage_id` is the extension's descriptor, not a function, but
+    // `dlsym()` can resolve that just the same
+#define X(name)                                                          \
+    do {                                                                 \
+        lib##name =                                                      \
+            reinterpret_cast<decltype(lib##name)>(dlsym(handle, #name)); \
+        if (!lib##name) {                                                \
+            libxcb_damage_load_failed = true;                            \
+            return false;                                                \
+        }                                                                \
+    } while (false);
+
+    LIBXCB_DAMAGE_FUNCTIONS
+
+#undef X
+
+    libxcb_damage_handle.store(handle);
+
+    return true;
+}
+}  // namespace
+
+DamageMonitor::DamageMonitor(std::shared_ptr<xcb_connection_t> x11_connection,
+                             xcb_window_t window,
+                             float max_frame_rate)
+    : x11_connection_(x11_connection),
+      max_frame_rate_(max_frame_rate),
+      min_timer_interval_(
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<float>(1.0f /
+                                           std::max(max_frame_rate, 1.0f)))),
+      period_start_(std::chrono::steady_clock::now()),
+      started_at_(period_start_) {
+    if (!libxcb_damage_handle && !setup_libxcb_damage()) {
+        throw std::runtime_error("Could not load '" +
+                                 std::string(libxcb_damage_library_name) +
+                                 "'");
+    }
+
+    const xcb_query_extension_reply_t* extension =
+        xcb_get_extension_data(x11_connection_.get(), libxcb_damage_id);
+    if (!extension || !extension->present) {
+        throw std::runtime_error(
+            "The X server does not support the DAMAGE extension");
+    }
+    damage_notify_event_type_ = extension->first_event + XCB_DAMAGE_NOTIFY;
+
+    // Clients need to announce which version of the extension they support
+    // before they can use it
+    xcb_generic_error_t* error = nullptr;
+    const std::unique_ptr<xcb_damage_query_version_reply_t> version_reply(
+        libxcb_damage_query_version_reply(
+            x11_connection_.get(),
+            libxcb_damage_query_version(x11_connection_.get(),
+                                        XCB_DAMAGE_MAJOR_VERSION,
+                                        XCB_DAMAGE_MINOR_VERSION),
+            &error));
+    if (error) {
+        free(error);
+        throw std::runtime_error(
+            "Could not query the DAMAGE extension's version");
+    }
+
+    // With the raw rectangles report level we get an event for every drawing
+    // operation, and we don't need to acknowledge those events
+    damage_ = xcb_generate_id(x11_connection_.get());
+    libxcb_damage_create(x11_connection_.get(), damage_, window,
+                         XCB_DAMAGE_REPORT_LEVEL_RAW_RECTANGLES);
+    xcb_flush(x11_connection_.get());
+}
+
+DamageMonitor::~DamageMonitor() noexcept {
+    libxcb_damage_destroy(x11_connection_.get(), damage_);
+    xcb_flush(x11_connection_.get());
+}
+
+bool DamageMonitor::handle_event(const xcb_generic_event_t& event) noexcept {
+    // The most significant bit indicates that the event was sent by another
+    // client through `xcb_send_event()`
+    if ((event.response_type & 0x7f) != damage_notify_event_type_) {
+        return false;
+    }
+
+    const auto& damage_event =
+        reinterpret_cast<const xcb_damage_notify_event_t&>(event);
+    if (damage_event.damage != damage_) {
+        return false;
+    }
+
+    if (damage_event.timestamp - last_damage_timestamp_ >=
+        max_redraw_duration_ms) {
+        period_redraws_++;
+        total_redraws_++;
+    }
+    last_damage_timestamp_ = damage_event.timestamp;
+
+    update_redraw_rate(std::chrono::steady_clock::now());
+
+    return true;
+}
+
+bool DamageMonitor::should_defer_timer(HWND window,
+                                       UINT_PTR timer_id) noexcept {
+    const auto now = std::chrono::steady_clock::now();
+    update_redraw_rate(now);
+
+    auto timer = std::find_if(timer_dispatches_.begin(),
+                              timer_dispatches_.end(),
+                              [&](const TimerDispatch& dispatch) {
+                                  return dispatch.window == window &&
+                                         dispatch.timer_id == timer_id;
+                              });
+    if (timer == timer_dispatches_.end()) {
+        if (timer_dispatches_.size() >= max_tracked_timers) {
+            timer_dispatches_.clear();
+        }
+
+        timer_dispatches_.push_back(TimerDispatch{
+            .window = window, .timer_id = timer_id, .dispatched_at = now});
+        return false;
+    }
+
+    if (is_throttling_ && now - timer->dispatched_at < min_timer_interval_) {
+        deferred_timer_messages_++;
+        return true;
+    }
+
+    timer->dispatched_at = now;
+    return false;
+}
+
+std::string DamageMonitor::format_statistics() const {
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - started_at_;
+
+    std::ostringstream message;
+    message << total_redraws_ << " redraws, " << std::fixed
+            << std::setprecision(2)
+            << (elapsed.count() > 0.0
+                    ? static_cast<double>(total_redraws_) / elapsed.count()
+                    : 0.0)
+            << " fps average, " << deferred_timer_messages_
+            << " timer messages deferred";
+
+    return message.str();
+}
+
+void DamageMonitor::update_redraw_rate(
+    std::chrono::steady_clock::time_point now) noexcept {
+    const std::chrono::duration<float> period_duration = now - period_start_;
+    if (period_duration < redraw_rate_measurement_period) {
+        return;
+    }
+
+    // We'll stop throttling when the redraw rate drops well below the limit,
+    // since throttling itself also causes the rate to drop to the limit
+    const float redraw_rate =
+        static_cast<float>(period_redraws_) / period_duration.count();
+    if (is_throttling_) {
+        is_throttling_ = redraw_rate > max_frame_rate_ / 2.0f;
+    } else {
+        is_throttling_ = redraw_rate > max_frame_rate_;
+    }
+
+    period_start_ = now;
+    period_redraws_ = 0;
+}
@@ -0,0 +1,153 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2023 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <windows.h>
+#include <llvm/small-vector.h>
+
+// Use the native version of xcb
+#pragma push_macro("_WIN32")
+#undef _WIN32
+#include <xcb/damage.h>
+#include <xcb/xcb.h>
+#pragma pop_macro("_WIN32")
+
+/**
+ * Measures how often a plugin's editor window gets redrawn using the X11 DAMAGE
+ * extension, and decides when the plugin's Win32 timers should be held back
+ * because the editor is being redrawn more often than the user configured
+ * `editor_max_frame_rate` allows. Many Windows plugins redraw their editors
+ * from a timer at 100 or more frames per second, which can put a lot of load
+ * on the X server and the compositor.
+ *
+ * The redraw rate is measured over `redraw_rate_measurement_period`. Once it
+ * exceeds the configured rate, timer messages sent to the editor's windows will
+ * only be dispatched once per frame (as defined by the configured rate). This
+ * stops again once the redraw rate drops below half of the configured rate.
+ * `WM_PAINT` messages cannot be held back since Windows keeps generating them
+ * until the window has been painted, but plugins almost always invalidate their
+ * windows from a timer so this caps those as well.
+ *
+ * `libxcb-damage.so.0` is loaded at runtime the same way we load LZ4 and
+ * libdbus, so the library is only needed when this feature is actually used.
+ */
+class DamageMonitor {
+   public:
+    /**
+     * Start monitoring `window` for redraws.
+     *
+     * @param x11_connection The X11 connection the editor uses. Events for
+     *   this monitor will arrive on this connection, and they should be passed
+     *   to `handle_event()`.
+     * @param window The window to monitor. This is the X11 window belonging to
+     *   the editor's Win32 window.
+     * @param max_frame_rate The maximum number of redraws per second before
+     *   timers will be throttled.
+     *
+     * @throw std::runtime_error If `libxcb-damage.so.0` could not be loaded or
+     *   if the X server does not support the DAMAGE extension.
+     */
+    DamageMonitor(std::shared_ptr<xcb_connection_t> x11_connection,
+                  xcb_window_t window,
+                  float max_frame_rate);
+
+    /**
+     * Destroy the damage object.
+     */
+    ~DamageMonitor() noexcept;
+
+    DamageMonitor(const DamageMonitor&) = delete;
+    DamageMonitor& operator=(const DamageMonitor&) = delete;
+
+    DamageMonitor(DamageMonitor&&) = delete;
+    DamageMonitor& operator=(DamageMonitor&&) = delete;
+
+    /**
+     * Handle an X11 event if it's a `DamageNotify` event for this monitor.
+     *
+     * @return Whether the event was handled. Other events should be handled
+     *   as usual.
+     */
+    bool handle_event(const xcb_generic_event_t& event) noexcept;
+
+    /**
+     * Check whether a timer message sent to one of the editor's windows should
+     * be held back for now. If this returns `false`, then the message should
+     * be dispatched and the timer's last dispatch time gets updated.
+     *
+     * @param window The window the `WM_TIMER` message was sent to.
+     * @param timer_id The timer's ID, from the message's `wParam`.
+     */
+    bool should_defer_timer(HWND window, UINT_PTR timer_id) noexcept;
+
+    /**
+     * Format the measured redraw rate and the number of deferred timer
+     * messages, e.g. `1200 redraws, 29.87 fps average, 2410 timer messages
+     * deferred`.
+     */
+    std::string format_statistics() const;
+
+   private:
+    /**
+     * Finish the current measurement period if it has lasted long enough, and
+     * update `is_throttling_` based on the redraw rate during that period.
+     */
+    void update_redraw_rate(std::chrono::steady_clock::time_point now) noexcept;
+
+    std::shared_ptr<xcb_connection_t> x11_connection_;
+    /**
+     * The response type of `DamageNotify` events on this connection.
+     */
+    uint8_t damage_notify_event_type_;
+    xcb_damage_damage_t damage_;
+
+    const float max_frame_rate_;
+    /**
+     * The minimum time between two dispatched timer messages for a single timer
+     * while throttling.
+     */
+    const std::chrono::steady_clock::duration min_timer_interval_;
+
+    /**
+     * The X server timestamp of the last `DamageNotify` event. Drawing
+     * operations that happen within a couple of milliseconds of each other are
+     * counted as part of the same redraw.
+     */
+    xcb_timestamp_t last_damage_timestamp_ = 0;
+
+    std::chrono::steady_clock::time_point period_start_;
+    uint32_t period_redraws_ = 0;
+    bool is_throttling_ = false;
+
+    /**
+     * When each of the editor's timers was last dispatched.
+     */
+    struct TimerDispatch {
+        HWND window;
+        UINT_PTR timer_id;
+        std::chrono::steady_clock::time_point dispatched_at;
+    };
+    llvm::SmallVector<TimerDispatch, 8> timer_dispatches_;
+
+    const std::chrono::steady_clock::time_point started_at_;
+    uint64_t total_redraws_ = 0;
+    uint64_t deferred_timer_messages_ = 0;
+};
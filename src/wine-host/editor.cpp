@@ -16,6 +16,8 @@
 
 #include "editor.h"
 
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 
@@ -52,10 +54,12 @@ constexpr size_t idle_timer_id = 1337;
 
 /**
  * The X11 event mask for the host window, which in most DAWs except for Ardour
- * and REAPER will be the same as `parent_window_`.
+ * and REAPER will be the same as `parent_window_`. The property change mask is
+ * needed to know when the window gets minimized through `_NET_WM_STATE`.
  */
-constexpr uint32_t host_event_mask =
-    XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_VISIBILITY_CHANGE;
+constexpr uint32_t host_event_mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY |
+                                     XCB_EVENT_MASK_VISIBILITY_CHANGE |
+                                     XCB_EVENT_MASK_PROPERTY_CHANGE;
 
 /**
  * The X11 event mask for the parent window. We'll use this for input focus
@@ -81,6 +85,13 @@ constexpr uint32_t wrapper_event_mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY |
                                         XCB_EVENT_MASK_KEY_PRESS |
                                         XCB_EVENT_MASK_KEY_RELEASE;
 
+/**
+ * The X11 event mask for the root window. We only listen for property changes
+ * so we know when `_NET_ACTIVE_WINDOW` changes, instead of having to query it
+ * every time the pointer enters or leaves the window.
+ */
+constexpr uint32_t root_event_mask = XCB_EVENT_MASK_PROPERTY_CHANGE;
+
 /**
  * The name of the X11 property on the root window used to denote the active
  * window in EWMH compliant window managers.
@@ -93,6 +104,14 @@ constexpr char active_window_property_name[] = "_NET_ACTIVE_WINDOW";
  */
 constexpr char wm_state_property_name[] = "WM_STATE";
 
+/**
+ * The EWMH property containing a window's state. We'll check this for
+ * `net_wm_state_hidden_name` on `host_window_` to know when the host's window
+ * has been minimized or when it's on another workspace.
+ */
+constexpr char net_wm_state_property_name[] = "_NET_WM_STATE";
+constexpr char net_wm_state_hidden_name[] = "_NET_WM_STATE_HIDDEN";
+
 // `xdnd_aware_property_name` was moved to `editor.h` so the unity build
 // succeeds
 
@@ -192,6 +211,28 @@ xcb_window_t get_x11_handle(HWND win32_handle) noexcept;
  */
 ATOM get_window_class() noexcept;
 
+void TimingStats::record(
+    std::chrono::steady_clock::duration duration) noexcept {
+    count_++;
+    total_ += duration;
+    max_ = std::max(max_, duration);
+}
+
+std::string TimingStats::format() const {
+    using milliseconds = std::chrono::duration<double, std::milli>;
+
+    const double average_ms =
+        count_ > 0 ? milliseconds(total_).count() / static_cast<double>(count_)
+                   : 0.0;
+
+    std::ostringstream formatted;
+    formatted << std::fixed << std::setprecision(2) << count_ << " calls, "
+              << average_ms << " ms average, " << milliseconds(max_).count()
+              << " ms max, " << milliseconds(total_).count() << " ms total";
+
+    return formatted.str();
+}
+
 DeferredWin32Window::DeferredWin32Window(
     MainContext& main_context,
     std::shared_ptr<xcb_connection_t> x11_connection,
@@ -258,12 +299,15 @@ DeferredWin32Window::~DeferredWin32Window() noexcept {
 Editor::Editor(MainContext& main_context,
                const Configuration& config,
                Logger& logger,
+               std::string plugin_name,
                const size_t parent_window_handle,
                std::optional<fu2::unique_function<void()>> timer_proc)
     : use_coordinate_hack_(config.editor_coordinate_hack),
       use_force_dnd_(config.editor_force_dnd),
       use_xembed_(config.editor_xembed),
       logger_(logger),
+      activity_description_("'" + plugin_name + "' editor"),
+      log_timings_(config.gui_stall_threshold.has_value()),
       x11_connection_(xcb_connect(nullptr, nullptr), xcb_disconnect),
       dnd_proxy_handle_(WineXdndProxy::get_handle()),
       client_area_(get_maximum_screen_dimensions(*x11_connection_)),
@@ -300,20 +344,38 @@ Editor::Editor(MainContext& main_context,
                                    nullptr,
                                    GetModuleHandle(nullptr),
                                    this)),
-      idle_timer_(
-          Win32Timer(win32_window_.handle_,
-                     idle_timer_id,
-                     std::chrono::duration_cast<std::chrono::milliseconds>(
-                         config.event_loop_interval())
-                         .count())),
+      idle_timer_interval_ms_(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              config.event_loop_interval())
+              .count()),
+      hidden_idle_timer_interval_ms_(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              config.hidden_editor_interval())
+              .count()),
+      idle_timer_(Win32Timer(win32_window_.handle_,
+                             idle_timer_id,
+                             idle_timer_interval_ms_)),
       idle_timer_proc_([this, timer_proc = std::move(timer_proc)]() mutable {
+          const auto x11_start = std::chrono::steady_clock::now();
           handle_x11_events();
-          if (timer_proc) {
+          const auto x11_end = std::chrono::steady_clock::now();
+          x11_event_timings_.record(x11_end - x11_start);
+
+          // The plugin's idle function gets throttled along with its own
+          // timers when the editor is being redrawn too often
+          if (timer_proc &&
+              !(damage_monitor_ && damage_monitor_->should_defer_timer(
+                                       win32_window_.handle_, idle_timer_id))) {
               (*timer_proc)();
+              idle_timings_.record(std::chrono::steady_clock::now() - x11_end);
           }
       }),
       xcb_wm_state_property_(
           get_atom_by_name(*x11_connection_, wm_state_property_name)),
+      xcb_net_wm_state_property_(
+          get_atom_by_name(*x11_connection_, net_wm_state_property_name)),
+      xcb_net_wm_state_hidden_atom_(
+          get_atom_by_name(*x11_connection_, net_wm_state_hidden_name)),
       parent_window_(parent_window_handle),
       wrapper_window_(
           x11_connection_,
@@ -339,7 +401,8 @@ Editor::Editor(MainContext& main_context,
       host_window_(find_host_window(*x11_connection_,
                                     parent_window_,
                                     xcb_wm_state_property_)
-                       .value_or(parent_window_)) {
+                       .value_or(parent_window_)),
+      root_window_(get_root_window(*x11_connection_, parent_window_)) {
     logger.log_editor_trace([&]() {
         return "DEBUG: host_window: " + std::to_string(host_window_);
     });
@@ -393,6 +456,8 @@ Editor::Editor(MainContext& main_context,
                                  XCB_CW_EVENT_MASK, &parent_event_mask);
     xcb_change_window_attributes(x11_connection_.get(), wrapper_window_.window_,
                                  XCB_CW_EVENT_MASK, &wrapper_event_mask);
+    xcb_change_window_attributes(x11_connection_.get(), root_window_,
+                                 XCB_CW_EVENT_MASK, &root_event_mask);
     xcb_flush(x11_connection_.get());
 
     // First reparent our dumb wrapper window to the host's window, and then
@@ -414,6 +479,43 @@ Editor::Editor(MainContext& main_context,
         // described in `Editor`'s docstring'.
         do_reparent(wine_window_, wrapper_window_.window_);
     }
+
+    if (config.editor_max_frame_rate) {
+        try {
+            damage_monitor_.emplace(x11_connection_, wine_window_,
+                                    *config.editor_max_frame_rate);
+        } catch (const std::runtime_error& error) {
+            std::cerr << "WARNING: Could not limit the editor's frame rate:"
+                      << std::endl;
+            std::cerr << "         " << error.what() << std::endl;
+        }
+    }
+}
+
+Editor::~Editor() noexcept {
+    // The Win32 window will be destroyed a little while after this, and any
+    // messages it receives in the meantime should not touch this object
+    SetWindowLongPtr(win32_window_.handle_, GWLP_USERDATA, 0);
+
+    try {
+        const auto format_timings = [&]() {
+            return "Timings for the " + activity_description_ +
+                   ":\n  Win32 messages: " + dispatch_timings_.format() +
+                   "\n  idle timer:     " + idle_timings_.format() +
+                   "\n  X11 events:     " + x11_event_timings_.format() +
+                   (damage_monitor_ ? "\n  redraws:        " +
+                                          damage_monitor_->format_statistics()
+                                    : "");
+        };
+
+        if (log_timings_) {
+            logger_.log(format_timings());
+        } else {
+            logger_.log_editor_trace(format_timings);
+        }
+    } catch (...) {
+        // This is purely informational
+    }
 }
 
 void Editor::resize(uint16_t width, uint16_t height) {
@@ -468,6 +570,10 @@ void Editor::handle_x11_events() noexcept {
     //       the window is unmapped `wine_window_` doesn't exist and any X11
     //       function calls involving it will fail. All functions called from
     //       here should be able to handle that cleanly.
+    // NOTE: Every pointer-related check made while handling this batch of
+    //       events shares a single `xcb_query_pointer()` call. See
+    //       `get_pointer_state()`.
+    pointer_state_cache_.reset();
     try {
         // HACK: See the docstrings on `should_fix_local_coordinates_` and
         //       `fix_local_coordinates()`
@@ -483,6 +589,11 @@ void Editor::handle_x11_events() noexcept {
         std::unique_ptr<xcb_generic_event_t> generic_event;
         while (generic_event.reset(xcb_poll_for_event(x11_connection_.get())),
                generic_event != nullptr) {
+            if (damage_monitor_ &&
+                damage_monitor_->handle_event(*generic_event)) {
+                continue;
+            }
+
             const uint8_t event_type =
                 generic_event->response_type & xcb_event_type_mask;
             const bool is_synthetic_event =
@@ -512,7 +623,9 @@ void Editor::handle_x11_events() noexcept {
                                std::to_string(event->event);
                     });
 
+                    invalidate_window_tree_cache();
                     redetect_host_window();
+                    update_visibility();
 
                     // If the `editor_force_dnd` option is set, we'll strip
                     // `XdndAware` from all of `wine_window_`'s ancestors
@@ -561,6 +674,8 @@ void Editor::handle_x11_events() noexcept {
                     if (event->window == host_window_ ||
                         event->window == parent_window_ ||
                         event->window == wrapper_window_.window_) {
+                        wrapper_window_position_cache_.reset();
+
                         if (!use_xembed_) {
                             // NOTE: See the docstring on this field. This
                             //       avoids flickering with some window manager
@@ -598,6 +713,46 @@ void Editor::handle_x11_events() noexcept {
                             do_xembed();
                         }
                     }
+
+                    // The visibility state of `parent_window_` also accounts
+                    // for it being covered up through any of its ancestors
+                    if (event->window == parent_window_) {
+                        parent_window_obscured_ =
+                            event->state == XCB_VISIBILITY_FULLY_OBSCURED;
+                        update_visibility();
+                    }
+                } break;
+                // When the host's window gets hidden, we'll slow down the idle
+                // timer until the window becomes visible again. Unmapping
+                // `host_window_` or `parent_window_` (Ardour does this instead
+                // of closing the editor) and minimizing the window or moving it
+                // to another workspace all count as hiding it.
+                case XCB_MAP_NOTIFY:
+                case XCB_UNMAP_NOTIFY: {
+                    logger_.log_editor_trace([&]() {
+                        return "DEBUG: "s +
+                               (event_type == XCB_MAP_NOTIFY ? "MapNotify"
+                                                             : "UnmapNotify");
+                    });
+
+                    update_visibility();
+                } break;
+                case XCB_PROPERTY_NOTIFY: {
+                    const auto event =
+                        reinterpret_cast<xcb_property_notify_event_t*>(
+                            generic_event.get());
+                    if (event->window == host_window_ &&
+                        event->atom == xcb_net_wm_state_property_) {
+                        logger_.log_editor_trace([&]() {
+                            return "DEBUG: _NET_WM_STATE changed for window " +
+                                   std::to_string(event->window);
+                        });
+
+                        update_visibility();
+                    } else if (event->window == root_window_ &&
+                               event->atom == active_window_property_) {
+                        active_window_cache_.reset();
+                    }
                 } break;
                 // We want to grab keyboard input focus when the user hovers
                 // over our embedded Wine window AND that window is a child of
@@ -776,6 +931,24 @@ void Editor::handle_x11_events() noexcept {
         std::cerr << "Error occurred while handling X11 events, continuing: "
                   << error.what() << std::endl;
     }
+
+    // Pointer-related checks from outside of the X11 event loop, like the
+    // `WM_PARENTNOTIFY` focus grabbing fallback, should never use stale data
+    pointer_state_cache_.reset();
+}
+
+bool Editor::should_defer_timer(HWND window, UINT_PTR timer_id) noexcept {
+    if (!damage_monitor_ ||
+        (window == win32_window_.handle_ && timer_id == idle_timer_id)) {
+        return false;
+    }
+
+    return damage_monitor_->should_defer_timer(window, timer_id);
+}
+
+void Editor::record_dispatch_time(
+    std::chrono::steady_clock::duration duration) noexcept {
+    dispatch_timings_.record(duration);
 }
 
 HWND Editor::win32_handle() const noexcept {
@@ -798,8 +971,6 @@ void Editor::fix_local_coordinates() const {
     // window created by the plugin itself. In this case it doesn't matter that
     // the Win32 window is larger than the part of the client area the plugin
     // draws to since any excess will be clipped off by the parent window.
-    const xcb_window_t root = get_root_window(*x11_connection_, parent_window_);
-
     // We can't directly use the `event.x` and `event.y` coordinates because the
     // parent window may also be embedded inside another window.
     // NOTE: Tracktion Waveform uses client side decorations, and for VST2
@@ -808,14 +979,24 @@ void Editor::fix_local_coordinates() const {
     //       inside directly inside of the dialog, and Waveform then moves the
     //       window 27 pixels down. That's why we cannot use `parent_window_`
     //       here.
-    xcb_generic_error_t* error = nullptr;
-    const xcb_translate_coordinates_cookie_t translate_cookie =
-        xcb_translate_coordinates(x11_connection_.get(),
-                                  wrapper_window_.window_, root, 0, 0);
-    const std::unique_ptr<xcb_translate_coordinates_reply_t>
-        translated_coordinates(xcb_translate_coordinates_reply(
-            x11_connection_.get(), translate_cookie, &error));
-    THROW_X11_ERROR(error);
+    // NOTE: This function is called every time the pointer enters the window,
+    //       so we'll only query the position again after one of the windows
+    //       has been moved or reparented
+    if (!wrapper_window_position_cache_) {
+        xcb_generic_error_t* error = nullptr;
+        const xcb_translate_coordinates_cookie_t translate_cookie =
+            xcb_translate_coordinates(x11_connection_.get(),
+                                      wrapper_window_.window_, root_window_, 0,
+                                      0);
+        const std::unique_ptr<xcb_translate_coordinates_reply_t>
+            translated_coordinates(xcb_translate_coordinates_reply(
+                x11_connection_.get(), translate_cookie, &error));
+        THROW_X11_ERROR(error);
+
+        wrapper_window_position_cache_ = *translated_coordinates;
+    }
+    const xcb_translate_coordinates_reply_t& translated_coordinates =
+        *wrapper_window_position_cache_;
 
     xcb_configure_notify_event_t translated_event{};
     translated_event.response_type = XCB_CONFIGURE_NOTIFY;
@@ -827,8 +1008,8 @@ void Editor::fix_local_coordinates() const {
     // this certain plugins (such as those by Valhalla DSP) would break.
     translated_event.width = client_area_.width;
     translated_event.height = client_area_.height;
-    translated_event.x = translated_coordinates->dst_x;
-    translated_event.y = translated_coordinates->dst_y;
+    translated_event.x = translated_coordinates.dst_x;
+    translated_event.y = translated_coordinates.dst_y;
 
     logger_.log_editor_trace([&]() {
         return "DEBUG: Spoofing local coordinates to (" +
@@ -931,14 +1112,9 @@ void Editor::run_timer_proc() {
 }
 
 std::optional<uint16_t> Editor::get_active_modifiers() const noexcept {
-    xcb_generic_error_t* error = nullptr;
-    const xcb_query_pointer_cookie_t query_pointer_cookie =
-        xcb_query_pointer(x11_connection_.get(), wine_window_);
-    const std::unique_ptr<xcb_query_pointer_reply_t> query_pointer_reply(
-        xcb_query_pointer_reply(x11_connection_.get(), query_pointer_cookie,
-                                &error));
-    if (error) {
-        free(error);
+    const std::optional<xcb_query_pointer_reply_t> query_pointer_reply =
+        get_pointer_state();
+    if (!query_pointer_reply) {
         return std::nullopt;
     }
 
@@ -950,7 +1126,12 @@ std::optional<uint16_t> Editor::get_active_modifiers() const noexcept {
     return query_pointer_reply->mask;
 }
 
-std::optional<POINT> Editor::get_current_pointer_position() const noexcept {
+std::optional<xcb_query_pointer_reply_t> Editor::get_pointer_state()
+    const noexcept {
+    if (pointer_state_cache_) {
+        return pointer_state_cache_;
+    }
+
     xcb_generic_error_t* error = nullptr;
     const xcb_query_pointer_cookie_t query_pointer_cookie =
         xcb_query_pointer(x11_connection_.get(), wine_window_);
@@ -962,6 +1143,18 @@ std::optional<POINT> Editor::get_current_pointer_position() const noexcept {
         return std::nullopt;
     }
 
+    pointer_state_cache_ = *query_pointer_reply;
+
+    return pointer_state_cache_;
+}
+
+std::optional<POINT> Editor::get_current_pointer_position() const noexcept {
+    const std::optional<xcb_query_pointer_reply_t> query_pointer_reply =
+        get_pointer_state();
+    if (!query_pointer_reply) {
+        return std::nullopt;
+    }
+
     // We know the mouse coordinates relative to the root window, and we know
     // the mouse coordinates relative to `wine_window_`, so we can skip a
     // request by calculating Wine window's coordinates ourself.
@@ -985,13 +1178,11 @@ std::optional<POINT> Editor::get_current_pointer_position() const noexcept {
 }
 
 bool Editor::is_mouse_button_held() const {
-    xcb_generic_error_t* error = nullptr;
-    const xcb_query_pointer_cookie_t pointer_query_cookie =
-        xcb_query_pointer(x11_connection_.get(), host_window_);
-    const std::unique_ptr<xcb_query_pointer_reply_t> pointer_query_reply(
-        xcb_query_pointer_reply(x11_connection_.get(), pointer_query_cookie,
-                                &error));
-    THROW_X11_ERROR(error);
+    const std::optional<xcb_query_pointer_reply_t> pointer_query_reply =
+        get_pointer_state();
+    if (!pointer_query_reply) {
+        throw std::runtime_error("Could not query the pointer state");
+    }
 
     return pointer_query_reply->mask != 0;
 }
@@ -1002,25 +1193,46 @@ bool Editor::is_wine_window_active() const {
     }
 
     // We will only grab focus when the Wine window is active. To do this we'll
-    // read the `_NET_ACTIVE_WINDOW` property from the root window (which can
-    // change when the window gets moved to another screen, so we won't cache
-    // this).
-    const xcb_window_t root_window =
-        get_root_window(*x11_connection_, wine_window_);
+    // read the `_NET_ACTIVE_WINDOW` property from the root window. This gets
+    // called for every `EnterNotify`, `LeaveNotify` and `FocusIn` event, so
+    // the property's value is cached until we receive a `PropertyNotify` event
+    // for it.
+    if (!active_window_cache_) {
+        xcb_generic_error_t* error = nullptr;
+        const xcb_get_property_cookie_t property_cookie =
+            xcb_get_property(x11_connection_.get(), false, root_window_,
+                             active_window_property_, XCB_ATOM_WINDOW, 0, 1);
+        const std::unique_ptr<xcb_get_property_reply_t> property_reply(
+            xcb_get_property_reply(x11_connection_.get(), property_cookie,
+                                   &error));
+        THROW_X11_ERROR(error);
 
-    xcb_generic_error_t* error = nullptr;
-    const xcb_get_property_cookie_t property_cookie =
-        xcb_get_property(x11_connection_.get(), false, root_window,
-                         active_window_property_, XCB_ATOM_WINDOW, 0, 1);
-    const std::unique_ptr<xcb_get_property_reply_t> property_reply(
-        xcb_get_property_reply(x11_connection_.get(), property_cookie, &error));
-    THROW_X11_ERROR(error);
+        active_window_cache_ = *static_cast<xcb_window_t*>(
+            xcb_get_property_value(property_reply.get()));
+    }
+
+    // This is equivalent to `is_child_window_or_same()`, but without walking
+    // the window tree every time
+    const llvm::SmallVector<xcb_window_t, 8>& ancestors =
+        get_wine_window_ancestors();
+
+    return std::find(ancestors.begin(), ancestors.end(),
+                     *active_window_cache_) != ancestors.end();
+}
+
+const llvm::SmallVector<xcb_window_t, 8>& Editor::get_wine_window_ancestors()
+    const {
+    if (!wine_window_ancestors_cache_) {
+        wine_window_ancestors_cache_ =
+            find_ancestor_windows(*x11_connection_, wine_window_);
+    }
 
-    const xcb_window_t active_window = *static_cast<xcb_window_t*>(
-        xcb_get_property_value(property_reply.get()));
+    return *wine_window_ancestors_cache_;
+}
 
-    return is_child_window_or_same(*x11_connection_, wine_window_,
-                                   active_window);
+void Editor::invalidate_window_tree_cache() const noexcept {
+    wine_window_ancestors_cache_.reset();
+    wrapper_window_position_cache_.reset();
 }
 
 void Editor::redetect_host_window() noexcept {
@@ -1057,6 +1269,67 @@ void Editor::redetect_host_window() noexcept {
     xcb_flush(x11_connection_.get());
 }
 
+void Editor::update_visibility() {
+    bool is_hidden = parent_window_obscured_;
+    if (!is_hidden) {
+        // This also covers `host_window_` or any of the other ancestors being
+        // unmapped
+        xcb_generic_error_t* error = nullptr;
+        const xcb_get_window_attributes_cookie_t attributes_cookie =
+            xcb_get_window_attributes(x11_connection_.get(), parent_window_);
+        const std::unique_ptr<xcb_get_window_attributes_reply_t>
+            attributes_reply(xcb_get_window_attributes_reply(
+                x11_connection_.get(), attributes_cookie, &error));
+        THROW_X11_ERROR(error);
+
+        is_hidden = attributes_reply->map_state != XCB_MAP_STATE_VIEWABLE;
+    }
+
+    if (!is_hidden && xcb_net_wm_state_property_ != XCB_ATOM_NONE &&
+        xcb_net_wm_state_hidden_atom_ != XCB_ATOM_NONE) {
+        // The window manager may set a whole bunch of other states here, so
+        // we'll just read the first 32 of them
+        xcb_generic_error_t* error = nullptr;
+        const xcb_get_property_cookie_t property_cookie =
+            xcb_get_property(x11_connection_.get(), false, host_window_,
+                             xcb_net_wm_state_property_, XCB_ATOM_ATOM, 0, 32);
+        const std::unique_ptr<xcb_get_property_reply_t> property_reply(
+            xcb_get_property_reply(x11_connection_.get(), property_cookie,
+                                   &error));
+        THROW_X11_ERROR(error);
+
+        const auto states = static_cast<const xcb_atom_t*>(
+            xcb_get_property_value(property_reply.get()));
+        const int num_states =
+            xcb_get_property_value_length(property_reply.get()) /
+            static_cast<int>(sizeof(xcb_atom_t));
+        for (int i = 0; i < num_states; i++) {
+            if (states[i] == xcb_net_wm_state_hidden_atom_) {
+                is_hidden = true;
+                break;
+            }
+        }
+    }
+
+    if (is_hidden == is_hidden_) {
+        return;
+    }
+
+    logger_.log_editor_trace([&]() {
+        return "DEBUG: Editor is now "s + (is_hidden ? "hidden" : "visible") +
+               ", setting the idle timer interval to " +
+               std::to_string(is_hidden ? hidden_idle_timer_interval_ms_
+                                        : idle_timer_interval_ms_) +
+               " ms";
+    });
+
+    // Setting a timer with the same ID replaces the old one
+    is_hidden_ = is_hidden;
+    idle_timer_ = Win32Timer(
+        win32_window_.handle_, idle_timer_id,
+        is_hidden ? hidden_idle_timer_interval_ms_ : idle_timer_interval_ms_);
+}
+
 bool Editor::supports_ewmh_active_window() const {
     if (supports_ewmh_active_window_cache_) {
         return *supports_ewmh_active_window_cache_;
@@ -1070,15 +1343,12 @@ bool Editor::supports_ewmh_active_window() const {
         return false;
     }
 
-    const xcb_window_t root_window =
-        get_root_window(*x11_connection_, wine_window_);
-
     // If the `_NET_ACTIVE_WINDOW` property does not exist on the root window,
     // the returned property type will be `XCB_ATOM_NONE` as specified in the
     // X11 manual
     xcb_generic_error_t* error = nullptr;
     const xcb_get_property_cookie_t property_cookie =
-        xcb_get_property(x11_connection_.get(), false, root_window,
+        xcb_get_property(x11_connection_.get(), false, root_window_,
                          active_window_property_, XCB_ATOM_WINDOW, 0, 1);
     const std::unique_ptr<xcb_get_property_reply_t> property_reply(
         xcb_get_property_reply(x11_connection_.get(), property_cookie, &error));
@@ -1158,6 +1428,7 @@ void Editor::do_reparent(xcb_window_t child, xcb_window_t new_parent) const {
         });
     }
 
+    invalidate_window_tree_cache();
     xcb_flush(x11_connection_.get());
 }
 
@@ -1410,6 +1681,21 @@ xcb_window_t get_root_window(xcb_connection_t& x11_connection,
     return query_reply->root;
 }
 
+Editor* find_editor_for_window(HWND window) noexcept {
+    if (!window) {
+        return nullptr;
+    }
+
+    const HWND root_window = GetAncestor(window, GA_ROOTOWNER);
+    if (!root_window || GetClassWord(root_window, GCW_ATOM) !=
+                            static_cast<WORD>(get_window_class())) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<Editor*>(
+        GetWindowLongPtr(root_window, GWLP_USERDATA));
+}
+
 xcb_window_t get_x11_handle(HWND win32_handle) noexcept {
     return reinterpret_cast<size_t>(
         GetProp(win32_handle, "__wine_x11_whole_window"));
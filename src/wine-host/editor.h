@@ -16,12 +16,14 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <optional>
 #include <string>
 
 #include <windows.h>
 #include <function2/function2.hpp>
+#include <llvm/small-vector.h>
 
 // Use the native version of xcb
 #pragma push_macro("_WIN32")
@@ -31,6 +33,7 @@
 
 #include "../common/configuration.h"
 #include "../common/logging/common.h"
+#include "damage-monitor.h"
 #include "utils.h"
 #include "xdnd-proxy.h"
 
@@ -64,6 +67,16 @@ constexpr char yabridge_window_class_name[] = "yabridge plugin";
 xcb_atom_t get_atom_by_name(xcb_connection_t& x11_connection,
                             const char* atom_name);
 
+class Editor;
+
+/**
+ * Find the `Editor` a window belongs to by looking up the window's root owner
+ * and checking whether that's one of yabridge's editor windows. This covers
+ * child windows created by the plugin as well as any popups owned by them.
+ * Returns a null pointer if the window does not belong to an open editor.
+ */
+Editor* find_editor_for_window(HWND window) noexcept;
+
 /**
  * Check if the cursor is within a Wine window. We can of course only detect
  * Wine applications within the current prefix. This ignores the extended client
@@ -86,6 +99,29 @@ struct Size {
     uint16_t height;
 };
 
+/**
+ * Accumulated timings for one kind of work done on the GUI thread on behalf of
+ * an editor. These are printed when the editor closes. See `Editor::~Editor()`.
+ */
+class TimingStats {
+   public:
+    /**
+     * Add a measurement.
+     */
+    void record(std::chrono::steady_clock::duration duration) noexcept;
+
+    /**
+     * Format the statistics as a human readable string, e.g. `120 calls, 0.25
+     * ms average, 3.10 ms max, 30.00 ms total`.
+     */
+    std::string format() const;
+
+   private:
+    uint64_t count_ = 0;
+    std::chrono::steady_clock::duration total_{};
+    std::chrono::steady_clock::duration max_{};
+};
+
 /**
  * A RAII wrapper around windows created using `CreateWindow()` that will post a
  * `WM_CLOSE` message to the window's message loop so it can clean itself up
@@ -179,6 +215,8 @@ class Editor {
      * @param logger A logger instance created with
      *   `Logger::create_wine_stderr()`. We'll use this to print editor tracing
      *   information only when needed.
+     * @param plugin_name The plugin's file name. Used to tell editors apart in
+     *   the timing statistics and in the GUI stall detector's warnings.
      * @param parent_window_handle The X11 window handle passed by the VST host
      *   for the editor to embed itself into.
      * @param timer_proc A function to run on a timer. This is used for VST2
@@ -191,9 +229,18 @@ class Editor {
         MainContext& main_context,
         const Configuration& config,
         Logger& logger,
+        std::string plugin_name,
         const size_t parent_window_handle,
         std::optional<fu2::unique_function<void()>> timer_proc = std::nullopt);
 
+    /**
+     * Print this editor's timing statistics if `log_timings_` is set or if
+     * editor tracing is enabled, and detach this object from the Win32 window.
+     * That window outlives this object for a little while, see
+     * `DeferredWin32Window`.
+     */
+    ~Editor() noexcept;
+
     /**
      * Resize the `wrapper_window_` to this new size. We need to manually call
      * this whenever the plugin requests a resize, or when the host resizes the
@@ -277,6 +324,32 @@ class Editor {
      */
     inline Size size() const noexcept { return wrapper_window_size_; }
 
+    /**
+     * Record how long it took to dispatch a Win32 message sent to one of this
+     * editor's windows. This includes the time spent in the idle timer, since
+     * that's also driven by a `WM_TIMER` message.
+     */
+    void record_dispatch_time(
+        std::chrono::steady_clock::duration duration) noexcept;
+
+    /**
+     * Whether a `WM_TIMER` message sent to one of this editor's windows should
+     * be held back for now because the editor is being redrawn more often than
+     * the `editor_max_frame_rate` option allows. Messages for our own idle
+     * timer are never held back since that timer also handles X11 events, but
+     * the idle function passed to the constructor will be throttled.
+     *
+     * @see DamageMonitor
+     */
+    bool should_defer_timer(HWND window, UINT_PTR timer_id) noexcept;
+
+    /**
+     * A description of this editor for `MainContext::GuiActivityGuard`.
+     */
+    inline const std::string& activity_description() const noexcept {
+        return activity_description_;
+    }
+
     /**
      * Whether to reposition `win32_window_` to (0, 0) every time the window
      * resizes. This can help with buggy plugins that use the (top level)
@@ -305,6 +378,32 @@ class Editor {
      */
     std::optional<uint16_t> get_active_modifiers() const noexcept;
 
+    /**
+     * Query the pointer's position and the modifier and button mask relative
+     * to `wine_window_`. The result is cached in `pointer_state_cache_` for the
+     * duration of a single `handle_x11_events()` call, so the different
+     * pointer-related checks made while handling a batch of events only result
+     * in a single round trip. Outside of `handle_x11_events()` this always
+     * queries the X11 server. Will return a nullopt if that query fails.
+     */
+    std::optional<xcb_query_pointer_reply_t> get_pointer_state() const noexcept;
+
+    /**
+     * Get `wine_window_` and all of its ancestors, excluding the root window.
+     * This walks the window tree the first time it's called and after
+     * `invalidate_window_tree_cache()` has been called, and otherwise the
+     * cached result is returned.
+     */
+    const llvm::SmallVector<xcb_window_t, 8>& get_wine_window_ancestors() const;
+
+    /**
+     * Drop the cached window tree information, i.e.
+     * `wine_window_ancestors_cache_` and `wrapper_window_position_cache_`. This
+     * is called whenever one of the windows we're tracking gets reparented,
+     * moved or resized.
+     */
+    void invalidate_window_tree_cache() const noexcept;
+
     /**
      * Get the current cursor position, in Win32 screen coordinates. This is
      * needed for our `LeaveNotify` handling because `GetCursorPos()` only
@@ -339,6 +438,17 @@ class Editor {
      */
     void redetect_host_window() noexcept;
 
+    /**
+     * Check whether the editor can currently be seen, and adjust
+     * `idle_timer_`'s interval accordingly. The editor is considered hidden
+     * when `parent_window_` is fully obscured, when it or any of its ancestors
+     * is unmapped, or when the window manager has set `_NET_WM_STATE_HIDDEN`
+     * on `host_window_` (i.e. the window is minimized or it's on another
+     * workspace). This is called whenever we receive an X11 event that could
+     * change any of those.
+     */
+    void update_visibility();
+
     /**
      * Send an XEmbed message to a window. This does not include a flush. See
      * the spec for more information:
@@ -367,6 +477,34 @@ class Editor {
      */
     Logger& logger_;
 
+    /**
+     * `'<plugin_name>' editor`, see `activity_description()`.
+     */
+    const std::string activity_description_;
+
+    /**
+     * Whether to always print the timing statistics below when the editor
+     * closes. This is enabled together with the GUI stall detector through the
+     * `gui_stall_threshold` option. Otherwise these are only printed when
+     * editor tracing is enabled.
+     */
+    const bool log_timings_;
+
+    /**
+     * Time spent dispatching Win32 messages for this editor's windows from
+     * `HostBridge::handle_events()`.
+     */
+    TimingStats dispatch_timings_;
+    /**
+     * Time spent in the timer proc passed to the constructor, i.e.
+     * `effEditIdle()` for VST2 plugins.
+     */
+    TimingStats idle_timings_;
+    /**
+     * Time spent in `handle_x11_events()`.
+     */
+    TimingStats x11_event_timings_;
+
     /**
      * Every editor window gets its own X11 connection.
      */
@@ -400,6 +538,18 @@ class Editor {
      */
     DeferredWin32Window win32_window_;
 
+    /**
+     * The interval for `idle_timer_` in milliseconds while the editor is
+     * visible. This is based on the `frame_rate` option.
+     */
+    const unsigned int idle_timer_interval_ms_;
+    /**
+     * The interval for `idle_timer_` in milliseconds while the editor is
+     * hidden, i.e. while `is_hidden_` is set. This is based on the
+     * `editor_hidden_frame_rate` option, and it will never be shorter than
+     * `idle_timer_interval_ms_`.
+     */
+    const unsigned int hidden_idle_timer_interval_ms_;
     /**
      * A timer we'll use to periodically run the X11 event loop plus
      * `idle_timer_proc_`, if that is set. We handle X11 events from within the
@@ -413,6 +563,21 @@ class Editor {
      */
     Win32Timer idle_timer_;
 
+    /**
+     * Whether the editor is currently hidden and `idle_timer_` has been slowed
+     * down to `hidden_idle_timer_interval_ms_`.
+     *
+     * @see update_visibility
+     */
+    bool is_hidden_ = false;
+    /**
+     * Whether the last `VisibilityNotify` event for `parent_window_` reported
+     * the window as being fully obscured. The X11 server doesn't let us query
+     * this, so we need to keep track of it ourselves. Note that most
+     * compositing window managers will never send this.
+     */
+    bool parent_window_obscured_ = false;
+
     /**
      * A function to call when the Win32 timer procs. This is used to
      * periodically call `handle_x11_events()`, as well as `effEditIdle()` for
@@ -424,6 +589,14 @@ class Editor {
      * The atom corresponding to `WM_STATE`.
      */
     xcb_atom_t xcb_wm_state_property_;
+    /**
+     * The atom corresponding to `_NET_WM_STATE`.
+     */
+    xcb_atom_t xcb_net_wm_state_property_;
+    /**
+     * The atom corresponding to `_NET_WM_STATE_HIDDEN`.
+     */
+    xcb_atom_t xcb_net_wm_state_hidden_atom_;
 
     /**
      * The window handle of the editor window created by the DAW.
@@ -471,10 +644,51 @@ class Editor {
      */
     bool should_fix_local_coordinates_ = false;
 
+    /**
+     * The root window `parent_window_` is on. Windows can't be moved to
+     * another screen, so this never changes.
+     */
+    const xcb_window_t root_window_;
+
+    /**
+     * Measures how often `wine_window_` gets redrawn, and decides when the
+     * plugin's timers should be throttled. Only set when the
+     * `editor_max_frame_rate` option is set and the X server supports the
+     * DAMAGE extension.
+     */
+    std::optional<DamageMonitor> damage_monitor_;
+
+    /**
+     * The cached result of `get_wine_window_ancestors()`. Cleared by
+     * `invalidate_window_tree_cache()`.
+     */
+    mutable std::optional<llvm::SmallVector<xcb_window_t, 8>>
+        wine_window_ancestors_cache_;
+    /**
+     * `wrapper_window_`'s last known position relative to the root window,
+     * used in `fix_local_coordinates()`. That function gets called every time
+     * the pointer enters the window, and the position only changes when one of
+     * the windows it's embedded in gets moved or reparented. Cleared by
+     * `invalidate_window_tree_cache()`.
+     */
+    mutable std::optional<xcb_translate_coordinates_reply_t>
+        wrapper_window_position_cache_;
+    /**
+     * The pointer state queried in `get_pointer_state()`. This is only set
+     * while `handle_x11_events()` is running.
+     */
+    mutable std::optional<xcb_query_pointer_reply_t> pointer_state_cache_;
+
     /**
      * The atom corresponding to `_NET_ACTIVE_WINDOW`.
      */
     xcb_atom_t active_window_property_;
+    /**
+     * The value of the `_NET_ACTIVE_WINDOW` property on `root_window_`. We
+     * listen for property changes on the root window, so this only needs to be
+     * queried again after the active window has changed.
+     */
+    mutable std::optional<xcb_window_t> active_window_cache_;
     /**
      * Whether the root window supports the `_NET_ACTIVE_WINDOW` hint. We'll
      * check this once and then cache the results in
@@ -218,7 +218,7 @@ int YABRIDGE_EXPORT
         // Handle Win32 messages and X11 events on a timer, just like in
         // `GroupBridge::async_handle_events()``
         main_context.async_handle_events(
-            [&]() { bridge->handle_events(); },
+            [&]() { return bridge->handle_events(main_context); },
             [&]() { return !bridge->inhibits_event_loop(); });
         main_context.run();
     }
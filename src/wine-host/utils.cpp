@@ -16,12 +16,40 @@
 
 #include "utils.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <thread>
 
+#include "../common/buffer-pool.h"
 #include "bridges/common.h"
 
 using namespace std::literals::chrono_literals;
 
+/**
+ * The number of event loop cycles without any events after which the event
+ * loop starts backing off. At the default frame rate this is a bit over 100
+ * milliseconds.
+ */
+constexpr int event_loop_backoff_threshold = 8;
+
+/**
+ * The maximum interval between two event loop cycles when the event loop has
+ * been idle for a while. Plugins that post messages to the GUI thread from
+ * their own threads while no editor is open will see at most this much extra
+ * latency.
+ */
+constexpr std::chrono::steady_clock::duration max_idle_event_loop_interval =
+    100ms;
+
+/**
+ * The bounds for how often the GUI stall detector checks the GUI thread. We'll
+ * check four times per stall threshold, within these limits.
+ */
+constexpr std::chrono::steady_clock::duration min_stall_check_interval = 10ms;
+constexpr std::chrono::steady_clock::duration max_stall_check_interval = 250ms;
+
 uint32_t WINAPI
 win32_thread_trampoline(fu2::unique_function<void()>* entry_point) {
     (*entry_point)();
@@ -78,11 +106,90 @@ Win32Timer& Win32Timer::operator=(Win32Timer&& o) noexcept {
     return *this;
 }
 
+StateRestoreSlot::StateRestoreSlot() noexcept
+    : previous_realtime_priority_(get_realtime_priority()) {
+    slots().acquire();
+    if (previous_realtime_priority_) {
+        set_realtime_priority(false);
+    }
+}
+
+StateRestoreSlot::~StateRestoreSlot() noexcept {
+    if (previous_realtime_priority_) {
+        set_realtime_priority(true, *previous_realtime_priority_);
+    }
+    slots().release();
+}
+
+std::counting_semaphore<>& StateRestoreSlot::slots() noexcept {
+    static std::counting_semaphore<> slots(
+        std::max(std::thread::hardware_concurrency(), 1u));
+
+    return slots;
+}
+
+MainContext::GuiActivityGuard::GuiActivityGuard(
+    MainContext& main_context,
+    std::string_view description) noexcept
+    : main_context_(nullptr) {
+    if (main_context.stall_threshold_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    main_context_ = &main_context;
+
+    std::lock_guard lock(main_context.gui_activity_mutex_);
+    previous_activity_ = main_context.gui_activity_;
+
+    GuiActivity& activity = main_context.gui_activity_;
+    const size_t length =
+        std::min(description.size(), activity.description.size() - 1);
+    std::memcpy(activity.description.data(), description.data(), length);
+    activity.description[length] = '\0';
+    activity.started_at = std::chrono::steady_clock::now();
+    activity.id = main_context.next_gui_activity_id_++;
+}
+
+MainContext::GuiActivityGuard::~GuiActivityGuard() noexcept {
+    if (!main_context_) {
+        return;
+    }
+
+    GuiActivity finished_activity;
+    bool was_reported = false;
+    {
+        std::lock_guard lock(main_context_->gui_activity_mutex_);
+        finished_activity = main_context_->gui_activity_;
+        was_reported = finished_activity.id ==
+                       main_context_->reported_gui_activity_id_;
+        // The outer activity's clock is restarted so it doesn't immediately
+        // get reported for time that was spent in this activity
+        main_context_->gui_activity_ = previous_activity_;
+        main_context_->gui_activity_.started_at =
+            std::chrono::steady_clock::now();
+    }
+
+    // If the stall detector warned about this activity, then we'll also print
+    // how long the stall ended up lasting
+    if (was_reported) {
+        const auto stall_duration =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() -
+                finished_activity.started_at);
+
+        std::cerr << "The GUI thread was blocked for "
+                  << stall_duration.count() << " ms in total by "
+                  << finished_activity.description.data() << std::endl;
+    }
+}
+
 MainContext::MainContext()
     : context_(),
       events_timer_(context_),
       watchdog_context_(),
-      watchdog_timer_(watchdog_context_) {}
+      watchdog_timer_(watchdog_context_),
+      stall_timer_(watchdog_context_),
+      process_watchdog_(watchdog_context_, 30s) {}
 
 void MainContext::run() {
     // We need to know which thread is the GUI thread because mutual recursion
@@ -99,10 +206,9 @@ void MainContext::run() {
                   << std::endl;
         std::cerr << "         against dangling processes." << std::endl;
     } else {
-        // To account for hosts terminating before the bridged plugin has
-        // initialized, we'll do the first watchdog check five seconds. After
-        // this we'll run the timer on a 30 second interval.
-        async_handle_watchdog_timer(5s);
+        // The native host processes are watched by `process_watchdog_`, this
+        // timer only periodically frees idle buffers
+        async_handle_watchdog_timer(30s);
 
         watchdog_handler_ = Win32Thread([&]() {
             pthread_setname_np(pthread_self(), "watchdog");
@@ -129,45 +235,139 @@ void MainContext::update_timer_interval(
     timer_interval_ = new_interval;
 }
 
-MainContext::WatchdogGuard::WatchdogGuard(
-    HostBridge& bridge,
-    std::unordered_set<HostBridge*>& watched_bridges,
-    std::mutex& watched_bridges_mutex)
-    : bridge_(&bridge),
-      watched_bridges_(watched_bridges),
-      watched_bridges_mutex_(watched_bridges_mutex) {
-    std::lock_guard lock(watched_bridges_mutex);
-    watched_bridges.insert(&bridge);
-}
+void MainContext::enable_stall_detector(
+    std::chrono::steady_clock::duration threshold) noexcept {
+    const std::chrono::steady_clock::rep new_threshold =
+        std::max<std::chrono::steady_clock::rep>(threshold.count(), 1);
+
+    // The first plugin to enable the stall detector also starts the timer
+    std::chrono::steady_clock::rep current_threshold =
+        stall_threshold_.load(std::memory_order_relaxed);
+    do {
+        if (current_threshold != 0 && current_threshold <= new_threshold) {
+            return;
+        }
+    } while (!stall_threshold_.compare_exchange_weak(
+        current_threshold, new_threshold, std::memory_order_relaxed));
 
-MainContext::WatchdogGuard::~WatchdogGuard() noexcept {
-    if (is_active_) {
-        std::lock_guard lock(watched_bridges_mutex_.get());
-        watched_bridges_.get().erase(bridge_);
+    if (current_threshold == 0) {
+        // The timer can only be touched from the watchdog thread
+        asio::post(watchdog_context_, [this]() { async_handle_stall_timer(); });
     }
 }
 
-MainContext::WatchdogGuard::WatchdogGuard(WatchdogGuard&& o) noexcept
-    : bridge_(std::move(o.bridge_)),
-      watched_bridges_(std::move(o.watched_bridges_)),
-      watched_bridges_mutex_(std::move(o.watched_bridges_mutex_)) {
-    o.is_active_ = false;
+void MainContext::async_handle_stall_timer() {
+    const std::chrono::steady_clock::duration threshold(
+        stall_threshold_.load(std::memory_order_relaxed));
+
+    stall_timer_.expires_after(std::clamp(
+        threshold / 4, min_stall_check_interval, max_stall_check_interval));
+    stall_timer_.async_wait([this, threshold](const std::error_code& error) {
+        if (error) {
+            return;
+        }
+
+        std::optional<GuiActivity> stalled_activity;
+        {
+            std::lock_guard lock(gui_activity_mutex_);
+            if (gui_activity_.id != 0 &&
+                gui_activity_.id != reported_gui_activity_id_ &&
+                std::chrono::steady_clock::now() - gui_activity_.started_at >=
+                    threshold) {
+                reported_gui_activity_id_ = gui_activity_.id;
+                stalled_activity = gui_activity_;
+            }
+        }
+
+        if (stalled_activity) {
+            const auto stall_duration =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() -
+                    stalled_activity->started_at);
+
+            std::cerr << "WARNING: The GUI thread has been blocked for "
+                      << stall_duration.count() << " ms by "
+                      << stalled_activity->description.data() << std::endl;
+            std::cerr << "         "
+                      << queued_tasks_.load(std::memory_order_relaxed)
+                      << " main thread tasks are waiting to be run"
+                      << std::endl;
+        }
+
+        async_handle_stall_timer();
+    });
 }
 
-MainContext::WatchdogGuard& MainContext::WatchdogGuard::operator=(
-    WatchdogGuard&& o) noexcept {
-    bridge_ = std::move(o.bridge_);
-    watched_bridges_ = std::move(o.watched_bridges_);
-    watched_bridges_mutex_ = std::move(o.watched_bridges_mutex_);
-    o.is_active_ = false;
+void MainContext::async_wait_for_events() {
+    // Try to keep a steady framerate, but add in delays to let other events
+    // get handled if the GUI message handling somehow takes very long.
+    const std::chrono::steady_clock::duration interval = event_loop_interval();
+    events_timer_.expires_at(
+        std::max(events_timer_.expiry() + interval,
+                 std::chrono::steady_clock::now() + interval / 4));
+    events_timer_.async_wait([&](const std::error_code& error) {
+        // The timer also gets cancelled when `wake_event_loop()` wants to run
+        // the next cycle early
+        if (error &&
+            !(error == asio::error::operation_aborted && event_loop_woken_)) {
+            return;
+        }
+        event_loop_woken_ = false;
+
+        // While the event loop is inhibited we'll keep polling at the full
+        // rate so the plugin can finish initializing as soon as possible
+        bool handled_events = true;
+        if (events_predicate_()) {
+            GuiActivityGuard activity(*this, "the Win32 message loop");
+            handled_events = events_handler_();
+        }
 
-    return *this;
+        if (handled_events) {
+            idle_event_loop_cycles_ = 0;
+        } else if (idle_event_loop_cycles_ <
+                   std::numeric_limits<int>::max()) {
+            idle_event_loop_cycles_++;
+        }
+
+        async_wait_for_events();
+    });
 }
 
-MainContext::WatchdogGuard MainContext::register_watchdog(HostBridge& bridge) {
-    // The guard's constructor and destructor will handle actually registering
-    // and unregistering the bridge from `watched_bridges`
-    return WatchdogGuard(bridge, watched_bridges_, watched_bridges_mutex_);
+std::chrono::steady_clock::duration MainContext::event_loop_interval()
+    const noexcept {
+    if (idle_event_loop_cycles_ < event_loop_backoff_threshold) {
+        return timer_interval_;
+    }
+
+    // Double the interval for every idle cycle past the threshold
+    const int doublings =
+        std::min(idle_event_loop_cycles_ - event_loop_backoff_threshold + 1, 8);
+    return std::max(timer_interval_,
+                    std::min(timer_interval_ * (1 << doublings),
+                             max_idle_event_loop_interval));
+}
+
+void MainContext::wake_event_loop() {
+    if (idle_event_loop_cycles_ < event_loop_backoff_threshold ||
+        event_loop_woken_ || !events_handler_) {
+        idle_event_loop_cycles_ = 0;
+        return;
+    }
+
+    // This cancels the pending wait, after which `async_wait_for_events()`
+    // reschedules the timer relative to the new expiry time
+    idle_event_loop_cycles_ = 0;
+    event_loop_woken_ = true;
+    events_timer_.expires_at(std::chrono::steady_clock::now());
+}
+
+MainContext::WatchdogGuard MainContext::register_watchdog(HostBridge& bridge,
+                                                         pid_t parent_pid) {
+    // This uses a pidfd when the kernel supports it, so the bridge gets shut
+    // down the moment the native host exits. Otherwise this is polled on the
+    // same 30 second interval we used before.
+    return process_watchdog_.watch(
+        parent_pid, [&bridge]() { bridge.shutdown_if_dangling(); });
 }
 
 void MainContext::async_handle_watchdog_timer(
@@ -178,14 +378,10 @@ void MainContext::async_handle_watchdog_timer(
             return;
         }
 
-        // When the `WatchdogGuard` field on `HostBridge` gets destroyed, that
-        // bridge instance will be removed from `watched_bridges`. So if our
-        // call to `HostBridge::shutdown_if_dangling()` shuts the plugin down,
-        // the instance will be removed after this lambda exits.
-        std::lock_guard lock(watched_bridges_mutex_);
-        for (auto& bridge : watched_bridges_) {
-            bridge->shutdown_if_dangling();
-        }
+        // Large serialization buffers are normally freed lazily the next time
+        // a buffer gets leased or returned, so we'll also periodically free
+        // them here in case a plugin stays idle after loading its state
+        SerializationBufferPool::global().trim();
 
         async_handle_watchdog_timer(30s);
     });
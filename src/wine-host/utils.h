@@ -18,9 +18,15 @@
 
 #include "use-linux-asio.h"
 
+#include <array>
+#include <atomic>
+#include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <semaphore>
+#include <string_view>
 #include <unordered_set>
 
 #include <windows.h>
@@ -28,6 +34,7 @@
 #include <asio/io_context.hpp>
 #include <function2/function2.hpp>
 
+#include "../common/process-watchdog.h"
 #include "../common/utils.h"
 
 // Forward declaration for use in our watchdog in `MainContext`
@@ -145,12 +152,63 @@ class Win32Timer {
     std::optional<size_t> timer_id_;
 };
 
+/**
+ * An RAII guard used when restoring a plugin's state off of the GUI thread
+ * through `run_state_restore()`. While this object is alive the calling thread
+ * holds one of a limited number of process-wide state restore slots, and it
+ * runs under normal scheduling instead of `SCHED_FIFO`. All of our socket
+ * handling threads use realtime scheduling, and restoring a large preset can
+ * take long enough to starve the system if we'd leave that in place.
+ */
+class StateRestoreSlot {
+   public:
+    StateRestoreSlot() noexcept;
+    ~StateRestoreSlot() noexcept;
+
+    StateRestoreSlot(const StateRestoreSlot&) = delete;
+    StateRestoreSlot& operator=(const StateRestoreSlot&) = delete;
+
+   private:
+    /**
+     * The pool of slots shared by all plugin instances in this process. This
+     * is sized to the number of CPU cores, since restoring state is mostly CPU
+     * bound and running more restores at once would only add contention.
+     */
+    static std::counting_semaphore<>& slots() noexcept;
+
+    /**
+     * The thread's realtime priority before we dropped it, so we can restore
+     * it afterwards.
+     */
+    std::optional<int> previous_realtime_priority_;
+};
+
+/**
+ * Restore a plugin's state by running `fn` on the calling thread. This is used
+ * instead of `MainContext::run_in_context()` when the `parallel_state_restore`
+ * option is enabled for a plugin. Every plugin instance's requests are handled
+ * on their own threads, so this lets multiple instances restore their state
+ * in parallel while a host loads a project instead of having to wait for each
+ * other (and for the Win32 message loop) on the GUI thread. This is opt-in
+ * since some plugins will only restore their state correctly when this happens
+ * on the GUI thread.
+ *
+ * @see StateRestoreSlot
+ */
+template <std::invocable F>
+std::invoke_result_t<F> run_state_restore(F&& fn) {
+    StateRestoreSlot slot{};
+    return fn();
+}
+
 /**
  * A wrapper around `asio::io_context()` to serve as the application's
  * main IO context, run from the GUI thread. A single instance is shared for all
  * plugins in a plugin group so that several important events can be handled on
  * the main thread, which can be required because in the Win32 model all GUI
- * related operations have to be handled from the same thread.
+ * related operations have to be handled from the same thread. Plugins using the
+ * `group_dedicated_gui_thread` option get their own instance running on their
+ * own GUI thread instead, see `DedicatedGuiThread`.
  *
  * This also spawns a second IO context in its own thread, which will be used as
  * a watchdog to shutdown a plugin instance's sockets when the process that
@@ -159,9 +217,55 @@ class Win32Timer {
  * terminate.
  */
 class MainContext {
+    /**
+     * Whatever the GUI thread is currently busy with, set through
+     * `GuiActivityGuard`. The description is copied into a fixed size buffer
+     * so setting this never allocates, and so the stall detector never has to
+     * worry about the lifetime of the string it's reading.
+     */
+    struct GuiActivity {
+        std::array<char, 128> description{};
+        std::chrono::steady_clock::time_point started_at{};
+        /**
+         * A unique ID for this activity, or 0 if the GUI thread is idle.
+         */
+        uint64_t id = 0;
+    };
+
    public:
     MainContext();
 
+    /**
+     * Marks the GUI thread as being busy with something for the GUI stall
+     * detector enabled through `enable_stall_detector()`. If the GUI thread is
+     * still busy with the same thing after the configured threshold, then the
+     * stall detector prints a warning containing `description`. These guards
+     * can be nested, in which case the innermost guard's description is used
+     * until it goes out of scope. This doesn't do anything when the stall
+     * detector is not enabled.
+     */
+    class GuiActivityGuard {
+       public:
+        GuiActivityGuard(MainContext& main_context,
+                         std::string_view description) noexcept;
+        ~GuiActivityGuard() noexcept;
+
+        GuiActivityGuard(const GuiActivityGuard&) = delete;
+        GuiActivityGuard& operator=(const GuiActivityGuard&) = delete;
+
+       private:
+        /**
+         * Will be a null pointer if the stall detector was not enabled when
+         * this guard was created.
+         */
+        MainContext* main_context_;
+        /**
+         * The activity that was active when this guard was created. This
+         * gets restored when the guard goes out of scope.
+         */
+        GuiActivity previous_activity_;
+    };
+
     /**
      * Run the IO context. This rest of this class assumes that this is only
      * done from a single thread.
@@ -182,52 +286,37 @@ class MainContext {
     void update_timer_interval(
         std::chrono::steady_clock::duration new_interval) noexcept;
 
+    /**
+     * Start printing a warning whenever the GUI thread has been busy with a
+     * single task, message or event loop cycle for longer than `threshold`.
+     * This uses the descriptions passed to `GuiActivityGuard` to tell which
+     * plugin was holding up the thread, and it includes the number of tasks
+     * that are waiting to be run on the GUI thread. Since this is shared by
+     * all plugins in a group, the shortest threshold set by any plugin is used.
+     * The stall detector runs on the watchdog thread, so this won't do
+     * anything when the watchdog has been disabled.
+     */
+    void enable_stall_detector(
+        std::chrono::steady_clock::duration threshold) noexcept;
+
     /**
      * The RAII guard used to register and unregister host bridge instances from
      * our watchdog.
      */
-    class WatchdogGuard {
-       public:
-        WatchdogGuard(HostBridge& bridge,
-                      std::unordered_set<HostBridge*>& watched_bridges,
-                      std::mutex& watched_bridges_mutex);
-        ~WatchdogGuard() noexcept;
-
-        WatchdogGuard(const WatchdogGuard&) = delete;
-        WatchdogGuard& operator=(const WatchdogGuard&) = delete;
-
-        WatchdogGuard(WatchdogGuard&& o) noexcept;
-        WatchdogGuard& operator=(WatchdogGuard&& o) noexcept;
-
-       private:
-        /**
-         * Used to facilitate moves.
-         */
-        bool is_active_ = true;
-
-        /**
-         * The bridge that we will add to the watchdog list when this object
-         * gets created, and that we'll remove from the list again when this
-         * object gets destroyed.
-         */
-        HostBridge* bridge_;
-
-        // References to the same two fields on `MainContext`, so we don't have
-        // to use `friend`
-        std::reference_wrapper<std::unordered_set<HostBridge*>>
-            watched_bridges_;
-        std::reference_wrapper<std::mutex> watched_bridges_mutex_;
-    };
+    using WatchdogGuard = ProcessWatchdog::Guard;
 
     /**
-     * Register a bridge instance for our watchdog. We'll periodically check if
-     * the remote (native) host process that should be connected to the bridge
-     * instance is still alive, and we'll shut down the bridge if it is not to
-     * prevent dangling processes. The returned guard should be stored as a
-     * field in `HostBridge`, and the watchdog will automatically be
-     * unregistered once this guard drops from scope.
+     * Register a bridge instance for our watchdog. We'll watch the remote
+     * (native) host process that should be connected to the bridge instance,
+     * and we'll shut down the bridge when that process exits to prevent
+     * dangling processes. The returned guard should be stored as a field in
+     * `HostBridge`, and the watchdog will automatically be unregistered once
+     * this guard drops from scope.
+     *
+     * @param bridge The bridge to shut down.
+     * @param parent_pid The process ID of the native plugin host.
      */
-    WatchdogGuard register_watchdog(HostBridge& bridge);
+    WatchdogGuard register_watchdog(HostBridge& bridge, pid_t parent_pid);
 
     /**
      * Returns `true` if the calling thread is the GUI thread, aka the thread
@@ -248,7 +337,14 @@ class MainContext {
 
         std::packaged_task<Result()> call_fn(std::forward<F>(fn));
         std::future<Result> result = call_fn.get_future();
-        asio::dispatch(context_, std::move(call_fn));
+        queued_tasks_.fetch_add(1, std::memory_order_relaxed);
+        asio::dispatch(
+            context_, [this, call_fn = std::move(call_fn)]() mutable {
+                queued_tasks_.fetch_sub(1, std::memory_order_relaxed);
+                GuiActivityGuard activity(*this, "a main thread task");
+                call_fn();
+            });
+        asio::post(context_, [this]() { wake_event_loop(); });
 
         return result;
     }
@@ -260,7 +356,13 @@ class MainContext {
      */
     template <std::invocable F>
     void schedule_task(F&& fn) {
-        asio::post(context_, std::forward<F>(fn));
+        queued_tasks_.fetch_add(1, std::memory_order_relaxed);
+        asio::post(context_, [this, fn = std::forward<F>(fn)]() mutable {
+            queued_tasks_.fetch_sub(1, std::memory_order_relaxed);
+            GuiActivityGuard activity(*this, "a scheduled main thread task");
+            fn();
+        });
+        asio::post(context_, [this]() { wake_event_loop(); });
     }
 
     /**
@@ -268,9 +370,19 @@ class MainContext {
      * interval is controllable through the `frame_rate` option and defaults to
      * 60 updates per second.
      *
+     * When the handler hasn't handled any events for a while, which is the
+     * case when no editors are open and the plugin doesn't use any Win32 timers
+     * of its own, the interval gradually backs off to
+     * `max_idle_event_loop_interval`. Any work run through `run_in_context()`
+     * or `schedule_task()`, such as a request from the native host, as well as
+     * the handler handling events again immediately brings the loop back to
+     * the configured rate. Editors run their own Win32 timers, so the event
+     * loop always runs at the full rate while an editor is open.
+     *
      * @param handler The function that should be executed in the IO context
      *   when the timer ticks. This should be a function that handles both the
-     *   X11 events and the Win32 message loop.
+     *   X11 events and the Win32 message loop, and it should return whether it
+     *   has handled any events.
      * @param predicate A function returning a boolean to indicate whether
      *   `handler` should be run. If this returns `false`, then the current
      *   event loop cycle will be skipped. This is used to prevent the Win32
@@ -280,25 +392,12 @@ class MainContext {
      *   that will cause them to stall indefinitely in this situation, but who
      *   knows which other plugins exert similar behaviour.
      */
-    template <std::invocable F, invocable_returning<bool> P>
+    template <invocable_returning<bool> F, invocable_returning<bool> P>
     void async_handle_events(F handler, P predicate) {
-        // Try to keep a steady framerate, but add in delays to let other events
-        // get handled if the GUI message handling somehow takes very long.
-        events_timer_.expires_at(
-            std::max(events_timer_.expiry() + timer_interval_,
-                     std::chrono::steady_clock::now() + timer_interval_ / 4));
-        events_timer_.async_wait(
-            [&, handler, predicate](const std::error_code& error) {
-                if (error) {
-                    return;
-                }
-
-                if (predicate()) {
-                    handler();
-                }
-
-                async_handle_events(handler, predicate);
-            });
+        events_handler_ = std::move(handler);
+        events_predicate_ = std::move(predicate);
+
+        async_wait_for_events();
     }
 
     /**
@@ -309,16 +408,40 @@ class MainContext {
 
    private:
     /**
-     * Start a timer to periodically check whether the host processes belong to
-     * all active plugin bridges are still alive. We will shut down the plugin
-     * instances where this is not the case, so that this process can gracefully
-     * terminate. In some cases Unix Domain Sockets are left in a state where
-     * it's impossible to tell that the remote isn't alive anymore, and where
-     * `recv()` will just hang indefinitely. We use this watchdog to avoid this.
+     * Schedule the next event loop cycle for `async_handle_events()`. Only
+     * called from the IO context's thread.
+     */
+    void async_wait_for_events();
+
+    /**
+     * The interval until the next event loop cycle, based on the configured
+     * interval and on how long the event loop has been idle.
+     */
+    std::chrono::steady_clock::duration event_loop_interval() const noexcept;
+
+    /**
+     * If the event loop has backed off because it has been idle, then run the
+     * next cycle immediately and go back to the configured rate. Only called
+     * from the IO context's thread.
+     */
+    void wake_event_loop();
+
+    /**
+     * Start a timer to periodically free idle serialization buffers. This used
+     * to also poll whether the native host processes for all active plugin
+     * bridges are still alive, but `process_watchdog_` now gets notified
+     * directly when those processes exit.
      */
     void async_handle_watchdog_timer(
         std::chrono::steady_clock::duration interval);
 
+    /**
+     * Periodically check whether the GUI thread has been busy with the same
+     * activity for longer than `stall_threshold_`. This runs on the watchdog
+     * thread, since the GUI thread obviously can't check this itself.
+     */
+    void async_handle_stall_timer();
+
     /**
      * The **Windows** thread ID the context is running on, which will be our
      * GUI thread. Will be a nullopt until `MainContext::run()` has been called.
@@ -340,26 +463,83 @@ class MainContext {
     std::chrono::steady_clock::duration timer_interval_ =
         std::chrono::milliseconds(1000) / 60;
 
+    /**
+     * The functions passed to `async_handle_events()`.
+     */
+    std::function<bool()> events_handler_;
+    std::function<bool()> events_predicate_;
+
+    /**
+     * The number of event loop cycles in a row where the handler did not
+     * handle any events. Used to back off the event loop when nothing's
+     * happening. Only accessed from the IO context's thread.
+     */
+    int idle_event_loop_cycles_ = 0;
+
+    /**
+     * Set by `wake_event_loop()` so the event loop knows that the timer was
+     * cancelled to run the next cycle early, rather than because the IO
+     * context is shutting down.
+     */
+    bool event_loop_woken_ = false;
+
+    /**
+     * The number of tasks submitted through `run_in_context()` and
+     * `schedule_task()` that haven't started running yet. Included in the GUI
+     * stall detector's warnings.
+     */
+    std::atomic_size_t queued_tasks_ = 0;
+
+    /**
+     * The stall detector's threshold, in `std::chrono::steady_clock` ticks. A
+     * value of 0 means that the stall detector is disabled.
+     *
+     * @see enable_stall_detector
+     */
+    std::atomic<std::chrono::steady_clock::rep> stall_threshold_ = 0;
+
+    std::mutex gui_activity_mutex_;
+    /**
+     * What the GUI thread is doing right now. `GuiActivityGuard` stores the
+     * previous activity and restores it when it goes out of scope.
+     */
+    GuiActivity gui_activity_;
+    /**
+     * Used to give every `GuiActivity` a unique ID.
+     */
+    uint64_t next_gui_activity_id_ = 1;
+    /**
+     * The ID of the last activity the stall detector has warned about, so we
+     * only print a single warning per stall and so `GuiActivityGuard` knows
+     * to print how long the stall lasted in total.
+     */
+    uint64_t reported_gui_activity_id_ = 0;
+
     /**
      * The IO context used for the watchdog described below.
      */
     asio::io_context watchdog_context_;
 
     /**
-     * The timer used to periodically check if the host processes are still
-     * active, so we can shut down a plugin's sockets (and with that the plugin
-     * itself) when the host has exited and the sockets are somehow not closed
-     * yet..
+     * The timer used to periodically free idle serialization buffers.
      */
     asio::steady_timer watchdog_timer_;
 
     /**
-     * All of the bridges we're watching as part of our watchdog. We're storing
-     * pointers for efficiency's sake, since reference wrappers don't implement
-     * any comparison operators.
+     * The timer used by the GUI stall detector, running on the watchdog
+     * thread.
+     */
+    asio::steady_timer stall_timer_;
+
+    /**
+     * Watches the native host processes of all active plugin bridges, so we
+     * can shut down a plugin's sockets (and with that the plugin itself) when
+     * the host has exited and the sockets are somehow not closed yet. In some
+     * cases Unix Domain Sockets are left in a state where it's impossible to
+     * tell that the remote isn't alive anymore, and where `recv()` will just
+     * hang indefinitely. We use this watchdog to avoid this.
      */
-    std::unordered_set<HostBridge*> watched_bridges_;
-    std::mutex watched_bridges_mutex_;
+    ProcessWatchdog process_watchdog_;
 
     /**
      * The thread where we run our watchdog timer, to shut down plugins after